@@ -26,101 +26,299 @@
 
 #include <map>
 #include <functional>
+#include <memory>
+#include <optional>
 
 namespace RogueLib::ROBN {
-    class AutoSerializable : public Serializable {
-        std::map<std::string, std::vector<std::string>> reliance;
-        std::map<std::string, std::function<bool()>> requirementChecks;
-        std::map<std::string, std::function<ROBN()>> serializationFunctions;
-        std::map<std::string, std::function<void(Byte*& ptr, const Byte* const endPtr,
-                                                 Type type)>> deserializationFunctions;
-    public:
+    template<typename T, typename = void>
+    struct is_equality_comparable : std::false_type {
+    };
 
-        template<typename T>
-        void registerForSerialization(T& val, std::string name) {
-            auto serializationFunc = [&]() {
-                return RogueLib::ROBN::toROBN<T>(val);
-            };
-            auto deserializationFunc = [&](Byte*& ptr, const Byte* const endPtr, Type type) {
-                val = RogueLib::ROBN::fromROBN<T>(ptr, endPtr, type);
-            };
-            reliance[name] = {};
-            serializationFunctions[name] = serializationFunc;
-            deserializationFunctions[name] = deserializationFunc;
-        }
+    template<typename T>
+    struct is_equality_comparable<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>>
+            : std::true_type {
+    };
 
-        void registerRequirementCheck(std::string name, std::function<bool()> isRequired = []() { return true; }) {
+    class AutoSerializable : public Serializable {
+        struct Field {
+            std::vector<std::string> reliance;
+            std::function<bool()> requirementCheck;
+            std::function<void(ROBNAnyWriter& writer)> serialize;
+            std::function<void(Byte*& ptr, const Byte* const endPtr, Type type)> deserialize;
+            std::uint64_t decodedGeneration = 0;
+
+            // delta tracking, against the value at the last snapshot
+            std::function<bool()> changed;
+            std::function<void()> snapshot;
+            bool dirty = false;
+        };
+
+        std::map<std::string, Field> fields;
+        // field names are decoded into this, so it stops allocating after the first message
+        std::string nameBuffer;
+        std::uint64_t decodeGeneration = 0;
 
+        static ROBN& scratchBuffer() {
+            thread_local ROBN scratch;
+            return scratch;
         }
 
-        void addReliance(std::string name, std::string relies) {
-            reliance[name].emplace_back(relies);
+        template<typename T>
+        static void registerDeltaTracking(Field& field, T& val) {
+            if constexpr (is_equality_comparable<T>::value && std::is_copy_assignable<T>::value) {
+                // a copy of the value, compared with ==
+                // copy assignment reuses the copy's storage, so taking snapshots stops allocating
+                auto last = std::make_shared<std::optional<T>>();
+                field.changed = [&val, last]() {
+                    return !last->has_value() || !(**last == val);
+                };
+                field.snapshot = [&val, last]() {
+                    if (last->has_value()) {
+                        **last = val;
+                    } else {
+                        last->emplace(val);
+                    }
+                };
+            } else {
+                // no == to use, so the encoding is compared instead
+                struct Snapshot {
+                    ROBN bytes;
+                    bool taken = false;
+                };
+                auto last = std::make_shared<Snapshot>();
+                field.changed = [&val, last]() {
+                    if (!last->taken) {
+                        return true;
+                    }
+                    auto& scratch = scratchBuffer();
+                    scratch.clear();
+                    appendROBN(scratch, val);
+                    return scratch != last->bytes;
+                };
+                field.snapshot = [&val, last]() {
+                    last->bytes.clear();
+                    appendROBN(last->bytes, val);
+                    last->taken = true;
+                };
+            }
         }
 
-        virtual ROBN toROBN() override {
+        // writes every field, or only the ones that changed since the last snapshot
+        void writeFields(ROBNAnyWriter& writer, bool delta) {
             ROGUELIB_STACKTRACE
-            std::map<std::string, ROBN> objects;
+            // optional values may be skipped, and the length goes first, so whats written is worked out up front
+            // values are written in reliance order, so they can be decoded in a single pass
+            std::vector<std::pair<const std::string*, Field*>> toWrite;
+            std::map<std::string, bool> written;
 
-            std::function<void(std::string)> writeObject;
+            std::function<void(const std::string&)> writeObject;
             writeObject = [&](const std::string& name) {
-                if (objects.find(name) == objects.end()) {
-                    auto relied = reliance[name];
-                    for (const auto& item : relied) {
-                        writeObject(item);
-                    }
-                    auto requirementIter = requirementChecks.find(name);
-                    if (requirementIter != requirementChecks.end()) {
-                        // if its not required (optional) we are going to skip it
-                        // well, that is, if we have a requirement check in the first place ofc
-                        if (!requirementIter->second()) {
-                            return;
-                        }
+                if (written.find(name) != written.end()) {
+                    return;
+                }
+                written[name] = true;
+                auto fieldIter = fields.find(name);
+                if (fieldIter == fields.end()) {
+                    return;
+                }
+                auto& field = fieldIter->second;
+                for (const auto& item : field.reliance) {
+                    writeObject(item);
+                }
+                // if its not required (optional) we are going to skip it
+                // well, that is, if we have a requirement check in the first place ofc
+                if (field.requirementCheck && !field.requirementCheck()) {
+                    return;
+                }
+                if (!field.serialize) {
+                    return;
+                }
+                if (delta) {
+                    if (!field.dirty && !field.changed()) {
+                        return;
                     }
+                    field.snapshot();
+                    field.dirty = false;
                 }
+                toWrite.emplace_back(&fieldIter->first, &field);
             };
 
-            for (const auto& item : reliance) {
+            for (const auto& item : fields) {
                 writeObject(item.first);
             }
 
-            return RogueLib::ROBN::toROBN(objects);
+            // same layout as a std::map<std::string, T>, except each value is its own type
+            Byte type{Type::Map};
+            writer.write(&type, 1);
+            writeLengthROBN(writer, toWrite.size());
+            for (auto& [name, field] : toWrite) {
+                Byte pairHeader[2] = {Byte{Type::Pair}, Byte{Type::String}};
+                writer.write(pairHeader, 2);
+                writer.write(name->c_str(), name->size() + 1);
+                field->serialize(writer);
+            }
         }
 
-        virtual void fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) override {
-            ROGUELIB_STACKTRACE
-            auto objects = RogueLib::ROBN::fromROBN<std::map<std::string, ROBN>>(ptr, endPtr, type);
+        ROBN writeFields(bool delta) {
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            ROBNAnyWriter anyWriter(writer);
+            writeFields(anyWriter, delta);
+            return bytes;
+        }
 
-            std::function<void(std::string)> readObject;
+        // decodes whatever fields are there, returns the generation they were decoded as
+        std::uint64_t readFields(Byte*& ptr, const Byte* const endPtr, Type type) {
+            ROGUELIB_STACKTRACE
+            if (type != Type::Map || ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
 
-            readObject = [&](std::string name) {
+            Type lengthType = static_cast<Type>(*ptr++);
+            auto length = RogueLib::ROBN::fromROBN<std::uint64_t>(ptr, endPtr, lengthType);
+            decodeGeneration++;
 
-                for (const auto& relied : reliance[name]) {
-                    readObject(relied);
+            for (std::uint64_t i = 0; i < length; ++i) {
+                if (ptr >= endPtr || *(ptr++) != Byte{Type::Pair}) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                if (ptr >= endPtr) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
                 }
+                Type nameType = static_cast<Type>(*ptr++);
+                RogueLib::ROBN::fromROBNInto(nameBuffer, ptr, endPtr, nameType);
+                if (ptr >= endPtr) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                Type valueType = static_cast<Type>(*ptr++);
 
-                auto objectsIter = objects.find(name);
-                if(objectsIter == objects.end()){
-                    auto requirementIter = requirementChecks.find(name);
-                    if(requirementIter != requirementChecks.end()){
-                        if(requirementIter->second()){
-                            // well, shit, we needed this one
-                            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary, requirement check failure");
-                        }
-                    }
-                    // didn't need it, aight then.
-                    return;
+                auto fieldIter = fields.find(nameBuffer);
+                if (fieldIter == fields.end() || !fieldIter->second.deserialize) {
+                    // additional values dont raise an error, just step over it
+                    skipROBN(ptr, endPtr, valueType);
+                    continue;
                 }
+                fieldIter->second.deserialize(ptr, endPtr, valueType);
+                fieldIter->second.decodedGeneration = decodeGeneration;
+            }
+            return decodeGeneration;
+        }
+
+    public:
+
+        template<typename T>
+        void registerForSerialization(T& val, std::string name) {
+            auto serializationFunc = [&](ROBNAnyWriter& writer) {
+                RogueLib::ROBN::writeROBN<T>(writer, val);
             };
+            auto deserializationFunc = [&](Byte*& ptr, const Byte* const endPtr, Type type) {
+                RogueLib::ROBN::fromROBNInto(val, ptr, endPtr, type);
+            };
+            auto& field = fields[name];
+            field.serialize = serializationFunc;
+            field.deserialize = deserializationFunc;
+            registerDeltaTracking(field, val);
+        }
 
-            for (const auto& item : reliance) {
-                readObject(item.first);
-            }
+        void registerRequirementCheck(std::string name, std::function<bool()> isRequired = []() { return true; }) {
+            fields[name].requirementCheck = std::move(isRequired);
+        }
 
-            for (const auto &object : objects) {
-                readObject(object.first);
+        void addReliance(std::string name, std::string relies) {
+            fields[name].reliance.emplace_back(relies);
+        }
+
+        virtual ROBN toROBN() override {
+            return writeFields(false);
+        }
+
+        /**
+         * straight into the writer, so large members can be referenced rather than copied, see ROBNSegments
+         */
+        virtual void writeROBN(ROBNAnyWriter& writer) override {
+            writeFields(writer, false);
+        }
+
+        /**
+         * decodes straight into the registered members, nothing is decoded into a temporary first
+         */
+        virtual void fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) override {
+            ROGUELIB_STACKTRACE
+            auto generation = readFields(ptr, endPtr, type);
+
+            for (const auto& item : fields) {
+                const auto& field = item.second;
+                if (field.decodedGeneration == generation || !field.requirementCheck) {
+                    continue;
+                }
+                if (field.requirementCheck()) {
+                    // well, shit, we needed this one
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO,
+                                                      "Incompatible binary, requirement check failure");
+                }
+                // didn't need it, aight then.
             }
         };
 
+        /**
+         * takes the current value of every field as the baseline for toROBNDelta
+         * call it after sending a full toROBN, so the next delta is against what the other side has
+         */
+        void snapshot() {
+            for (auto& item : fields) {
+                auto& field = item.second;
+                if (field.snapshot) {
+                    field.snapshot();
+                }
+                field.dirty = false;
+            }
+        }
+
+        /**
+         * forces a field into the next delta, whether it compares as changed or not
+         */
+        void markDirty(const std::string& name) {
+            ROGUELIB_STACKTRACE
+            auto fieldIter = fields.find(name);
+            if (fieldIter == fields.end()) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Unknown field");
+            }
+            fieldIter->second.dirty = true;
+        }
+
+        /**
+         * only the fields that changed since the last snapshot (or delta), then snapshots them
+         * same format as toROBN, just with fewer fields, so applyDelta can take a full message too
+         * fields are compared with == if they have it, otherwise by their encoding
+         */
+        ROBN toROBNDelta() {
+            return writeFields(true);
+        }
+
+        /**
+         * decodes the fields in a delta into this, fields that arent in it are left alone
+         * no requirement checks, a delta leaves out whatever didnt change
+         * the applied fields are snapshotted, so passing the changes on doesnt send them back
+         */
+        void applyDelta(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            auto generation = readFields(ptr, endPtr, type);
+            for (auto& item : fields) {
+                auto& field = item.second;
+                if (field.decodedGeneration == generation && field.snapshot) {
+                    field.snapshot();
+                }
+            }
+        }
+
+        void applyDelta(const ROBN& delta) {
+            auto* ptr = const_cast<Byte*>(delta.data());
+            applyDelta(ptr, delta.data() + delta.size());
+        }
     };
 
 #define ROGUELIB_ROBN_XCAT3_L2(a, b, c) a##b##c
@@ -0,0 +1,351 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <RogueLib/Exceptions/Exceptions.hpp>
+
+namespace RogueLib::ROBN {
+    /**
+     * arbitrary size integer, sign and magnitude, the magnitude is 64 bit limbs, least significant first
+     * its storage for values, not an arithmetic library, it holds what other libraries give it, exactly, and
+     * ROBN moves the limbs around as a single block
+     *
+     * always normalized, no zero limbs at the top, and zero isnt negative
+     */
+    class BigInt {
+        bool negative = false;
+        std::vector<std::uint64_t> magnitude;
+
+        void setMagnitude(unsigned __int128 value) {
+            magnitude.clear();
+            while (value != 0) {
+                magnitude.emplace_back(std::uint64_t(value));
+                value >>= 64u;
+            }
+        }
+
+        // for asInt128/asUInt128, throws if it doesnt fit in 128 bits
+        [[nodiscard]] unsigned __int128 magnitude128() const {
+            ROGUELIB_STACKTRACE
+            if (magnitude.size() > 2) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "BigInt out of range");
+            }
+            unsigned __int128 value = 0;
+            for (std::size_t i = magnitude.size(); i-- > 0;) {
+                value = (value << 64u) | magnitude[i];
+            }
+            return value;
+        }
+
+        // divides the magnitude by divisor in place, returns the remainder
+        std::uint64_t divideMagnitude(std::uint64_t divisor) {
+            unsigned __int128 remainder = 0;
+            for (std::size_t i = magnitude.size(); i-- > 0;) {
+                auto current = (remainder << 64u) | magnitude[i];
+                magnitude[i] = std::uint64_t(current / divisor);
+                remainder = current % divisor;
+            }
+            normalize();
+            return std::uint64_t(remainder);
+        }
+
+        void multiplyAddMagnitude(std::uint64_t multiplier, std::uint64_t addend) {
+            unsigned __int128 carry = addend;
+            for (auto& limb : magnitude) {
+                auto current = (unsigned __int128) limb * multiplier + carry;
+                limb = std::uint64_t(current);
+                carry = current >> 64u;
+            }
+            if (carry != 0) {
+                magnitude.emplace_back(std::uint64_t(carry));
+            }
+        }
+
+    public:
+        BigInt() = default;
+
+        template<typename T, typename std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                       (sizeof(T) <= 8), int> = 0>
+        BigInt(T value) {
+            if constexpr (std::is_signed<T>::value) {
+                negative = value < 0;
+                // negating in unsigned, so the most negative value works too
+                auto unsignedValue = std::uint64_t(value);
+                setMagnitude(negative ? std::uint64_t(0) - unsignedValue : unsignedValue);
+            } else {
+                setMagnitude(value);
+            }
+        }
+
+        BigInt(__int128 value) {
+            negative = value < 0;
+            auto unsignedValue = (unsigned __int128) value;
+            setMagnitude(negative ? (unsigned __int128) 0 - unsignedValue : unsignedValue);
+        }
+
+        BigInt(unsigned __int128 value) {
+            setMagnitude(value);
+        }
+
+        /**
+         * limbs are least significant first
+         */
+        static BigInt fromLimbs(const std::uint64_t* limbs, std::size_t count, bool negative) {
+            BigInt value;
+            value.magnitude.assign(limbs, limbs + count);
+            value.negative = negative;
+            value.normalize();
+            return value;
+        }
+
+        /**
+         * base 10, with an optional leading -
+         */
+        static BigInt fromString(const std::string& string) {
+            ROGUELIB_STACKTRACE
+            BigInt value;
+            std::size_t i = 0;
+            bool negative = !string.empty() && string[0] == '-';
+            i += negative;
+            if (i == string.size()) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Invalid BigInt string");
+            }
+            // 19 digits at a time, the most that fit in a limb
+            while (i < string.size()) {
+                auto chunkSize = std::min<std::size_t>(19, string.size() - i);
+                std::uint64_t chunk = 0;
+                std::uint64_t multiplier = 1;
+                for (std::size_t j = 0; j < chunkSize; ++j) {
+                    auto digit = string[i + j];
+                    if (digit < '0' || digit > '9') {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Invalid BigInt string");
+                    }
+                    chunk = chunk * 10 + std::uint64_t(digit - '0');
+                    multiplier *= 10;
+                }
+                value.multiplyAddMagnitude(multiplier, chunk);
+                i += chunkSize;
+            }
+            value.negative = negative;
+            value.normalize();
+            return value;
+        }
+
+        [[nodiscard]] std::string toString() const {
+            if (magnitude.empty()) {
+                return "0";
+            }
+            BigInt remaining = *this;
+            std::string digits;
+            while (!remaining.magnitude.empty()) {
+                auto chunk = remaining.divideMagnitude(10000000000000000000ull);
+                // every chunk but the last one is exactly 19 digits, zeros included
+                for (int i = 0; i < 19 && (chunk != 0 || !remaining.magnitude.empty()); ++i) {
+                    digits += char('0' + chunk % 10);
+                    chunk /= 10;
+                }
+            }
+            if (negative) {
+                digits += '-';
+            }
+            std::reverse(digits.begin(), digits.end());
+            return digits;
+        }
+
+        /**
+         * throws if it doesnt fit in T
+         */
+        template<typename T>
+        [[nodiscard]] T as() const {
+            ROGUELIB_STACKTRACE
+            static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "use asInt128 or asUInt128");
+            auto value = magnitude128();
+            typedef std::make_unsigned_t<T> U;
+            bool fits;
+            if (negative) {
+                fits = std::is_signed<T>::value && value <= (unsigned __int128) U(std::numeric_limits<T>::max()) + 1;
+            } else {
+                fits = value <= (unsigned __int128) U(std::numeric_limits<T>::max());
+            }
+            if (!fits) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "BigInt out of range");
+            }
+            auto unsignedValue = U(value);
+            return T(negative ? U(0) - unsignedValue : unsignedValue);
+        }
+
+        [[nodiscard]] __int128 asInt128() const {
+            ROGUELIB_STACKTRACE
+            auto value = magnitude128();
+            auto limit = ((unsigned __int128) 1 << 127u) - (negative ? 0 : 1);
+            if (value > limit) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "BigInt out of range");
+            }
+            return (__int128) (negative ? (unsigned __int128) 0 - value : value);
+        }
+
+        [[nodiscard]] unsigned __int128 asUInt128() const {
+            ROGUELIB_STACKTRACE
+            if (negative) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "BigInt out of range");
+            }
+            return magnitude128();
+        }
+
+        [[nodiscard]] bool isNegative() const {
+            return negative;
+        }
+
+        [[nodiscard]] bool isZero() const {
+            return magnitude.empty();
+        }
+
+        [[nodiscard]] const std::vector<std::uint64_t>& limbs() const {
+            return magnitude;
+        }
+
+        [[nodiscard]] std::uint64_t trailingZeroBits() const {
+            std::uint64_t bits = 0;
+            for (auto limb : magnitude) {
+                if (limb != 0) {
+                    return bits + std::uint64_t(__builtin_ctzll(limb));
+                }
+                bits += 64;
+            }
+            return 0;
+        }
+
+        void shiftRight(std::uint64_t bits) {
+            auto limbShift = std::size_t(std::min<std::uint64_t>(bits / 64, magnitude.size()));
+            magnitude.erase(magnitude.begin(), magnitude.begin() + std::ptrdiff_t(limbShift));
+            auto bitShift = unsigned(bits % 64);
+            if (bitShift != 0) {
+                for (std::size_t i = 0; i < magnitude.size(); ++i) {
+                    auto high = i + 1 < magnitude.size() ? magnitude[i + 1] << (64u - bitShift) : 0;
+                    magnitude[i] = (magnitude[i] >> bitShift) | high;
+                }
+            }
+            normalize();
+        }
+
+        /**
+         * drops zero limbs off the top, for after the limbs have been written directly
+         */
+        void normalize() {
+            while (!magnitude.empty() && magnitude.back() == 0) {
+                magnitude.pop_back();
+            }
+            if (magnitude.empty()) {
+                negative = false;
+            }
+        }
+
+        /**
+         * the limbs themselves, for decoders, call normalize after writing them
+         * the capacity is kept between uses
+         */
+        std::vector<std::uint64_t>& limbStorage() {
+            return magnitude;
+        }
+
+        void setNegative(bool isNegative) {
+            negative = isNegative;
+        }
+
+        bool operator==(const BigInt& other) const {
+            return negative == other.negative && magnitude == other.magnitude;
+        }
+
+        bool operator!=(const BigInt& other) const {
+            return !(*this == other);
+        }
+
+        bool operator<(const BigInt& other) const {
+            if (negative != other.negative) {
+                return negative;
+            }
+            // same sign, compare magnitudes, then flip it for negatives
+            bool less;
+            if (magnitude.size() != other.magnitude.size()) {
+                less = magnitude.size() < other.magnitude.size();
+            } else {
+                auto mismatch = std::mismatch(magnitude.rbegin(), magnitude.rend(), other.magnitude.rbegin());
+                if (mismatch.first == magnitude.rend()) {
+                    return false;
+                }
+                less = *mismatch.first < *mismatch.second;
+            }
+            return negative ? !less : less;
+        }
+    };
+
+    /**
+     * mantissa * 2^exponent, exact, no rounding anywhere
+     * equal values compare equal however they are split between the mantissa and exponent
+     */
+    struct BigFloat {
+        BigInt mantissa;
+        std::int64_t exponent = 0;
+
+        /**
+         * makes the mantissa odd, moving its trailing zeros into the exponent, zero has a zero exponent
+         */
+        void normalize() {
+            ROGUELIB_STACKTRACE
+            if (mantissa.isZero()) {
+                exponent = 0;
+                return;
+            }
+            auto shift = mantissa.trailingZeroBits();
+            if (shift == 0) {
+                return;
+            }
+            // into a temporary, so a throw leaves this exactly as it was
+            std::int64_t shiftedExponent;
+            if (shift > std::uint64_t(std::numeric_limits<std::int64_t>::max()) ||
+                __builtin_add_overflow(exponent, std::int64_t(shift), &shiftedExponent)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "BigFloat exponent out of range");
+            }
+            exponent = shiftedExponent;
+            mantissa.shiftRight(shift);
+        }
+
+        bool operator==(const BigFloat& other) const {
+            auto a = *this;
+            auto b = other;
+            a.normalize();
+            b.normalize();
+            return a.exponent == b.exponent && a.mantissa == b.mantissa;
+        }
+
+        bool operator!=(const BigFloat& other) const {
+            return !(*this == other);
+        }
+    };
+}
@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <RogueLib/Exceptions/Exceptions.hpp>
+
+namespace RogueLib::ROBN {
+    /**
+     * non-owning view of a dense row major N dimensional array, like mdspan
+     * indexing with fewer indices than the rank isnt allowed, use slice to take off the outer dimensions
+     */
+    template<typename T>
+    class NDArrayView {
+        T* elements;
+        const std::uint64_t* shape;
+        std::size_t dimensions;
+
+    public:
+        NDArrayView(T* elements, const std::uint64_t* shape, std::size_t dimensions)
+                : elements(elements), shape(shape), dimensions(dimensions) {
+        }
+
+        [[nodiscard]] std::size_t rank() const {
+            return dimensions;
+        }
+
+        [[nodiscard]] std::uint64_t extent(std::size_t dimension) const {
+            return shape[dimension];
+        }
+
+        [[nodiscard]] std::uint64_t size() const {
+            std::uint64_t size = 1;
+            for (std::size_t i = 0; i < dimensions; ++i) {
+                size *= shape[i];
+            }
+            return size;
+        }
+
+        T* data() const {
+            return elements;
+        }
+
+        template<typename... Indices>
+        T& operator()(Indices... indices) const {
+            static_assert(sizeof...(Indices) > 0);
+            std::uint64_t index = 0;
+            std::size_t dimension = 0;
+            // row major, each index scales everything before it by its extent
+            ((index = index * shape[dimension++] + std::uint64_t(indices)), ...);
+            return elements[index];
+        }
+
+        /**
+         * the sub array at index in the outermost dimension, one rank lower
+         */
+        NDArrayView slice(std::uint64_t index) const {
+            ROGUELIB_STACKTRACE
+            if (dimensions == 0 || index >= shape[0]) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Index out of range");
+            }
+            NDArrayView sub(elements, shape + 1, dimensions - 1);
+            sub.elements += index * sub.size();
+            return sub;
+        }
+    };
+
+    /**
+     * dense N dimensional array of a primitive type, row major, one contiguous block of elements
+     * ROBN encodes it as a shape and a single block, instead of a length and type header per row
+     *
+     * an empty shape is rank 0, a single scalar element, so a default constructed one is shape {0}, no elements
+     */
+    template<typename T>
+    class NDArray {
+        static_assert((std::is_integral<T>::value || std::is_floating_point<T>::value) &&
+                      !std::is_same<T, bool>::value, "NDArray elements must be a primitive, and not bool");
+
+        std::vector<std::uint64_t> dimensions;
+        std::vector<T> elements;
+
+    public:
+        typedef T value_type;
+
+        NDArray() : dimensions{0} {
+        }
+
+        explicit NDArray(std::vector<std::uint64_t> shape) {
+            reshape(std::move(shape));
+        }
+
+        /**
+         * from a vector of rows, they all have to be the same length
+         */
+        static NDArray fromNested(const std::vector<std::vector<T>>& rows) {
+            ROGUELIB_STACKTRACE
+            std::uint64_t columns = rows.empty() ? 0 : rows[0].size();
+            NDArray array({rows.size(), columns});
+            auto* ptr = array.elements.data();
+            for (const auto& row : rows) {
+                if (row.size() != columns) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Rows are different lengths");
+                }
+                std::copy(row.begin(), row.end(), ptr);
+                ptr += columns;
+            }
+            return array;
+        }
+
+        [[nodiscard]] std::vector<std::vector<T>> toNested() const {
+            ROGUELIB_STACKTRACE
+            if (dimensions.size() != 2) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "NDArray is not two dimensional");
+            }
+            std::vector<std::vector<T>> rows(dimensions[0]);
+            for (std::uint64_t i = 0; i < dimensions[0]; ++i) {
+                auto* row = elements.data() + i * dimensions[1];
+                rows[i].assign(row, row + dimensions[1]);
+            }
+            return rows;
+        }
+
+        /**
+         * changes the shape, elements are kept in order, and zero filled if it grew
+         * the allocation is kept if it shrinks
+         */
+        void reshape(std::vector<std::uint64_t> shape) {
+            ROGUELIB_STACKTRACE
+            std::uint64_t size = 1;
+            for (auto extent : shape) {
+                if (extent != 0 && size > UINT64_MAX / sizeof(T) / extent) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "NDArray too large");
+                }
+                size *= extent;
+            }
+            dimensions = std::move(shape);
+            elements.resize(size);
+        }
+
+        [[nodiscard]] const std::vector<std::uint64_t>& shape() const {
+            return dimensions;
+        }
+
+        [[nodiscard]] std::size_t rank() const {
+            return dimensions.size();
+        }
+
+        [[nodiscard]] std::uint64_t size() const {
+            return elements.size();
+        }
+
+        T* data() {
+            return elements.data();
+        }
+
+        const T* data() const {
+            return elements.data();
+        }
+
+        template<typename... Indices>
+        T& operator()(Indices... indices) {
+            return view()(indices...);
+        }
+
+        template<typename... Indices>
+        const T& operator()(Indices... indices) const {
+            return view()(indices...);
+        }
+
+        NDArrayView<T> view() {
+            return {elements.data(), dimensions.data(), dimensions.size()};
+        }
+
+        NDArrayView<const T> view() const {
+            return {elements.data(), dimensions.data(), dimensions.size()};
+        }
+
+        bool operator==(const NDArray& other) const {
+            return dimensions == other.dimensions && elements == other.elements;
+        }
+
+        bool operator!=(const NDArray& other) const {
+            return !(*this == other);
+        }
+
+        // decoders fill these in directly, to reuse both allocations
+        // the element count has to stay the product of the shape
+        std::vector<std::uint64_t>& shapeStorage() {
+            return dimensions;
+        }
+
+        std::vector<T>& elementStorage() {
+            return elements;
+        }
+    };
+}
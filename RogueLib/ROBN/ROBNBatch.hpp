@@ -0,0 +1,307 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+
+#include <iterator>
+
+/**
+ * BATCH FORMAT Description
+ *
+ * a batch is any number of ROBN messages packed back to back, nothing before, between, or after them
+ * each message is prefixed by its length in bytes, as an unsigned LEB128 varint
+ *      seven bits per byte, least significant group first, high bit set on every byte but the last
+ *      so anything under 128 bytes costs a single byte of framing
+ * the message itself is a normal ROBN blob, type header included
+ *
+ * two batches concatenated together are a valid batch
+ */
+
+namespace RogueLib::ROBN {
+    class ROBNBatch {
+        ROBN buffer;
+        std::uint64_t messages = 0;
+
+        static std::size_t varintSize(std::uint64_t value) {
+            std::size_t size = 1;
+            while (value >= 0x80) {
+                value >>= 7u;
+                size++;
+            }
+            return size;
+        }
+
+        static void writeVarint(Byte* ptr, std::uint64_t value) {
+            while (value >= 0x80) {
+                *ptr++ = Byte(std::uint8_t(value) | 0x80u);
+                value >>= 7u;
+            }
+            *ptr = Byte(std::uint8_t(value));
+        }
+
+        static std::uint64_t readVarint(const Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            std::uint64_t value = 0;
+            for (std::uint32_t shift = 0; shift < 64; shift += 7) {
+                if (ptr >= endPtr) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                auto byte = std::to_integer<std::uint64_t>(*ptr++);
+                // the tenth byte only has room for the top bit, anything more would be silently dropped
+                if (shift == 63 && (byte & 0x7Eu)) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                value |= (byte & 0x7Fu) << shift;
+                if (!(byte & 0x80u)) {
+                    return value;
+                }
+            }
+            // more than ten bytes isnt a 64 bit length
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+
+        // the frame was written with a single byte of length, if it needs more, the message gets shifted up
+        void finishFrame(std::size_t frameOffset) {
+            std::uint64_t length = buffer.size() - frameOffset - 1;
+            auto lengthSize = varintSize(length);
+            if (lengthSize > 1) {
+                buffer.insert(buffer.begin() + frameOffset + 1, lengthSize - 1, Byte{0});
+            }
+            writeVarint(buffer.data() + frameOffset, length);
+            messages++;
+        }
+
+    public:
+
+        /**
+         * view of one message in the batch, nothing is copied
+         * only valid until the batch is changed, same as any other vector iterator
+         */
+        class Message {
+            const Byte* start;
+            const Byte* finish;
+        public:
+            Message(const Byte* start, const Byte* finish) : start(start), finish(finish) {
+            }
+
+            [[nodiscard]] const Byte* data() const {
+                return start;
+            }
+
+            [[nodiscard]] std::size_t size() const {
+                return std::size_t(finish - start);
+            }
+
+            [[nodiscard]] Type type() const {
+                return static_cast<Type>(*start);
+            }
+
+            template<typename T>
+            T as() const {
+                auto* ptr = const_cast<Byte*>(start);
+                return BinaryConversion<T>::fromROBN(ptr, finish);
+            }
+
+            template<typename T>
+            void into(T& target) const {
+                auto* ptr = const_cast<Byte*>(start);
+                fromROBNInto(target, ptr, finish);
+            }
+
+            [[nodiscard]] ROBN copy() const {
+                return {start, finish};
+            }
+        };
+
+        class Iterator {
+            const Byte* ptr;
+            const Byte* endPtr;
+            const Byte* messageStart = nullptr;
+            const Byte* messageEnd = nullptr;
+
+            void readFrame() {
+                if (ptr == endPtr) {
+                    messageStart = messageEnd = nullptr;
+                    return;
+                }
+                auto length = readVarint(ptr, endPtr);
+                messageStart = ptr;
+                messageEnd = ptr + length;
+                ptr = messageEnd;
+            }
+
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef Message value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Message* pointer;
+            typedef Message reference;
+
+            Iterator(const Byte* ptr, const Byte* endPtr) : ptr(ptr), endPtr(endPtr) {
+                readFrame();
+            }
+
+            Message operator*() const {
+                return {messageStart, messageEnd};
+            }
+
+            Iterator& operator++() {
+                readFrame();
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                Iterator old = *this;
+                readFrame();
+                return old;
+            }
+
+            bool operator==(const Iterator& other) const {
+                return messageStart == other.messageStart;
+            }
+
+            bool operator!=(const Iterator& other) const {
+                return messageStart != other.messageStart;
+            }
+        };
+
+        ROBNBatch() = default;
+
+        /**
+         * adopts an existing batch buffer, from the network or a file
+         * the framing is checked here, once, so iterating it later doesnt need to
+         */
+        explicit ROBNBatch(ROBN bytes) : buffer(std::move(bytes)) {
+            ROGUELIB_STACKTRACE
+            const Byte* ptr = buffer.data();
+            const Byte* endPtr = buffer.data() + buffer.size();
+            while (ptr < endPtr) {
+                auto length = readVarint(ptr, endPtr);
+                // a ROBN message is at least its type header
+                if (length == 0 || length > std::uint64_t(endPtr - ptr)) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                ptr += length;
+                messages++;
+            }
+        }
+
+        /**
+         * encodes val straight into the batch buffer, no intermediate ROBN is created
+         * if encoding throws the batch is left as it was
+         */
+        template<typename T>
+        void append(const T& val) {
+            ROGUELIB_STACKTRACE
+            auto frameOffset = buffer.size();
+            // one byte of framing, almost every message fits in that
+            buffer.emplace_back(Byte{0});
+            try {
+                ROBNWriter writer(buffer);
+                BinaryConversion<T>::writeROBN(writer, val);
+            } catch (...) {
+                buffer.resize(frameOffset);
+                throw;
+            }
+            finishFrame(frameOffset);
+        }
+
+        /**
+         * appends a message that is already encoded
+         */
+        void appendEncoded(const Byte* data, std::size_t size) {
+            ROGUELIB_STACKTRACE
+            if (size == 0) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Empty ROBN message");
+            }
+            auto frameOffset = buffer.size();
+            auto lengthSize = varintSize(size);
+            buffer.resize(frameOffset + lengthSize + size);
+            writeVarint(buffer.data() + frameOffset, size);
+            std::memcpy(buffer.data() + frameOffset + lengthSize, data, size);
+            messages++;
+        }
+
+        void appendEncoded(const ROBN& robn) {
+            appendEncoded(robn.data(), robn.size());
+        }
+
+        /**
+         * batches concatenate, so this is a single copy
+         */
+        void appendBatch(const ROBNBatch& other) {
+            buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+            messages += other.messages;
+        }
+
+        void reserve(std::size_t bytes) {
+            buffer.reserve(bytes);
+        }
+
+        /**
+         * empties the batch, but keeps the buffer allocated
+         */
+        void clear() {
+            buffer.clear();
+            messages = 0;
+        }
+
+        [[nodiscard]] std::uint64_t size() const {
+            return messages;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return messages == 0;
+        }
+
+        [[nodiscard]] std::size_t byteSize() const {
+            return buffer.size();
+        }
+
+        /**
+         * the whole batch, ready to be written out as is
+         */
+        [[nodiscard]] const ROBN& bytes() const {
+            return buffer;
+        }
+
+        /**
+         * takes the buffer out of the batch, leaving it empty
+         */
+        ROBN release() {
+            ROBN released = std::move(buffer);
+            buffer = {};
+            messages = 0;
+            return released;
+        }
+
+        [[nodiscard]] Iterator begin() const {
+            return {buffer.data(), buffer.data() + buffer.size()};
+        }
+
+        [[nodiscard]] Iterator end() const {
+            return {buffer.data() + buffer.size(), buffer.data() + buffer.size()};
+        }
+    };
+}
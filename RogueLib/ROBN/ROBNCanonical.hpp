@@ -0,0 +1,647 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+#include "ROBNChecksum.hpp"
+#include "ROBNCompression.hpp"
+#include "ROBNHash.hpp"
+
+#include <algorithm>
+
+/**
+ * CANONICAL FORM Description
+ *
+ * the same value can be encoded more than one way, this picks exactly one of them
+ * so two blobs with the same canonical bytes hold the same value, and the other way around
+ * its still normal ROBN, any decoder reads it
+ *
+ * every multi byte value is little endian, and no type byte has the endianness bit set
+ * Bool values are 0 or 1
+ * Vector and Map lengths, and NDArray shapes, are uInt64 elements, except an empty (rank 0) shape is Undefined
+ * empty Vectors have an Undefined element type, theres no element to have a type
+ * vectors of numbers (not Bool) that have their own type header are a SparseVector if they are at least 256 long
+ *      and that comes out under half the size of the dense Vector, the same rule the encoder uses by default
+ *      otherwise theyre a Vector, vector elements keep whichever type the vector says they are
+ * SparseVector indices are the smallest type that fits the length, and stored zeros are dropped
+ * Map entries are sorted by the canonical bytes of their keys
+ * Checksummed elements keep their frame, the checksum is redone over the canonical payload
+ * Compressed elements are replaced by their canonical payload, how something was compressed isnt part of its value
+ * Polymorphic tags and Variant indices are the smallest unsigned type that fits, same as the encoder
+ * Tuple counts are uInt64 elements
+ * BigInts have no zero limbs on top and zero isnt negative, BigFloats are normalized, an odd mantissa (or zero,
+ *      with a zero exponent), and their exponent is an Int64
+ *
+ * on a little endian host, what the encoder writes is already canonical for everything but Maps and BigFloats
+ * sorted maps usually are already, unordered ones almost never are
+ */
+
+namespace RogueLib::ROBN {
+    namespace CanonicalDetail {
+        // fixed, unlike ROGUELIB_ROBN_SPARSE_MINIMUM_SIZE, so every build agrees on it
+        constexpr std::uint64_t sparseMinimumSize = 256;
+
+        template<typename Writer>
+        inline void writeType(Writer& writer, Type type) {
+            auto typeByte = Byte(removeEndianness(type));
+            writer.write(&typeByte, 1);
+        }
+
+        template<typename T>
+        inline T toLittleEndian(T val) {
+            return correctEndianness(val, Endianness::LITTLE);
+        }
+
+        template<typename Writer>
+        inline void writeLength(Writer& writer, std::uint64_t length) {
+            Byte header[9];
+            header[0] = Byte(Type::uInt64);
+            length = toLittleEndian(length);
+            std::memcpy(header + 1, &length, 8);
+            writer.write(header, 9);
+        }
+
+        inline std::uint64_t readLength(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type lengthType = static_cast<Type>(*ptr++);
+            return fromROBN<std::uint64_t>(ptr, endPtr, lengthType);
+        }
+
+        inline Type readType(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            return static_cast<Type>(*ptr++);
+        }
+
+        /**
+         * count values of type, the bytes are already known to be there
+         * big endian values are flipped a chunk at a time, Bools are squashed to 0 or 1
+         */
+        template<typename Writer>
+        inline void writeValues(Writer& writer, const Byte* data, std::uint64_t count, Type type) {
+            auto size = primitiveTypeSize(removeEndianness(type));
+            bool isBool = removeEndianness(type) == Type::Bool;
+            if (!isBool && (size == 1 || typeEndianness(type) == Endianness::LITTLE)) {
+                writer.write(data, count * size);
+                return;
+            }
+            Byte buffer[4096];
+            auto perChunk = sizeof(buffer) / size;
+            while (count != 0) {
+                auto chunk = std::min<std::uint64_t>(count, perChunk);
+                for (std::uint64_t i = 0; i < chunk; ++i) {
+                    for (std::size_t j = 0; j < size; ++j) {
+                        buffer[i * size + j] = data[i * size + size - 1 - j];
+                    }
+                    if (isBool) {
+                        buffer[i] = Byte(data[i] != Byte{0});
+                    }
+                }
+                writer.write(buffer, chunk * size);
+                data += chunk * size;
+                count -= chunk;
+            }
+        }
+
+        inline bool isZero(const Byte* data, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i) {
+                if (data[i] != Byte{0}) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // same limit as writeSparseROBN, done in 128 bits because a SparseVector's length can be anything
+        inline std::uint64_t sparseLimit(std::uint64_t length, Type valType) {
+            auto valSize = primitiveTypeSize(removeEndianness(valType));
+            auto indexSize = primitiveTypeSize(sparseIndexType(length));
+            return std::uint64_t((unsigned __int128) length * valSize / (2 * (indexSize + valSize)));
+        }
+
+        inline bool canBeSparse(std::uint64_t length, Type valType) {
+            return length >= sparseMinimumSize && removeEndianness(valType) != Type::Bool;
+        }
+
+        /**
+         * sparse data, the length and non zero values are already worked out
+         * nextIndex() and nextValue() give each stored element, in order
+         */
+        template<typename Writer, typename IndexFunction, typename ValueFunction>
+        inline void writeSparseData(Writer& writer, std::uint64_t length, std::uint64_t count, Type valType,
+                                    IndexFunction&& nextIndex, ValueFunction&& nextValue) {
+            writeLength(writer, length);
+            writeLength(writer, count);
+            auto indexType = sparseIndexType(length);
+            writeType(writer, indexType);
+            auto indexSize = primitiveTypeSize(indexType);
+            for (std::uint64_t i = 0; i < count; ++i) {
+                auto index = toLittleEndian(nextIndex());
+                // little endian, so the low bytes come first whatever the index type is
+                writer.write(&index, indexSize);
+            }
+            writeType(writer, valType);
+            for (std::uint64_t i = 0; i < count; ++i) {
+                writeValues(writer, nextValue(), 1, valType);
+            }
+        }
+
+        template<typename Writer>
+        inline void writeData(Writer& writer, Byte*& ptr, const Byte* endPtr, Type type);
+
+        template<typename Writer>
+        inline void writeElement(Writer& writer, Byte*& ptr, const Byte* endPtr, Type type);
+
+        // a SparseVector's data, whose type header has been read, either kept sparse or written out as a full Vector
+        template<typename Writer>
+        inline void writeSparse(Writer& writer, Byte*& ptr, const Byte* const endPtr, bool mayBeDense) {
+            ROGUELIB_STACKTRACE
+            auto header = readSparseHeader(ptr, endPtr);
+            auto valSize = primitiveTypeSize(removeEndianness(header.valType));
+
+            // index and position of every stored element that isnt zero
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> stored;
+            std::uint64_t lastIndex = 0;
+            forEachSparseIndex(header, [&](std::uint64_t i, std::uint64_t index) {
+                // out of order or repeated indices dont have a single meaning
+                if (i != 0 && index <= lastIndex) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                lastIndex = index;
+                if (!isZero(header.values + i * valSize, valSize)) {
+                    stored.emplace_back(index, i);
+                }
+            });
+
+            if (!mayBeDense || (canBeSparse(header.length, header.valType) &&
+                                stored.size() <= sparseLimit(header.length, header.valType))) {
+                if (mayBeDense) {
+                    writeType(writer, Type::SparseVector);
+                }
+                std::size_t nextIndex = 0;
+                std::size_t nextValue = 0;
+                writeSparseData(writer, header.length, stored.size(), header.valType, [&]() {
+                    return stored[nextIndex++].first;
+                }, [&]() {
+                    return header.values + valSize * stored[nextValue++].second;
+                });
+                return;
+            }
+
+            writeType(writer, Type::Vector);
+            writeLength(writer, header.length);
+            if (header.length == 0) {
+                writeType(writer, Type::Undefined);
+                return;
+            }
+            // nothing was stored, so the value type never had to make sense
+            if (valSize == 0) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            writeType(writer, header.valType);
+            Byte zeros[4096] = {};
+            auto writeZeros = [&](std::uint64_t zeroCount) {
+                while (zeroCount != 0) {
+                    auto chunk = std::min<std::uint64_t>(zeroCount, sizeof(zeros) / valSize);
+                    writer.write(zeros, chunk * valSize);
+                    zeroCount -= chunk;
+                }
+            };
+            std::uint64_t written = 0;
+            for (const auto& element : stored) {
+                writeZeros(element.first - written);
+                writeValues(writer, header.values + valSize * element.second, 1, header.valType);
+                written = element.first + 1;
+            }
+            writeZeros(header.length - written);
+        }
+
+        // a Vector, whose type header has been read, dense vectors of numbers can come out sparse
+        template<typename Writer>
+        inline void writeVector(Writer& writer, Byte*& ptr, const Byte* const endPtr, bool mayBeSparse) {
+            ROGUELIB_STACKTRACE
+            auto length = readLength(ptr, endPtr);
+            auto valType = readType(ptr, endPtr);
+            auto valSize = primitiveTypeSize(removeEndianness(valType));
+            if (length == 0) {
+                if (mayBeSparse) {
+                    writeType(writer, Type::Vector);
+                }
+                writeLength(writer, 0);
+                writeType(writer, Type::Undefined);
+                return;
+            }
+            // every element is at least a byte
+            if (length > std::uint64_t(endPtr - ptr) / std::max<std::size_t>(valSize, 1)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            if (valSize == 0) {
+                DecodeDepthGuard depthGuard;
+                if (mayBeSparse) {
+                    writeType(writer, Type::Vector);
+                }
+                writeLength(writer, length);
+                writeType(writer, valType);
+                for (std::uint64_t i = 0; i < length; ++i) {
+                    writeData(writer, ptr, endPtr, valType);
+                }
+                return;
+            }
+
+            if (mayBeSparse && canBeSparse(length, valType)) {
+                auto limit = sparseLimit(length, valType);
+                std::uint64_t count = 0;
+                for (std::uint64_t i = 0; i < length && count <= limit; ++i) {
+                    count += !isZero(ptr + i * valSize, valSize);
+                }
+                if (count <= limit) {
+                    writeType(writer, Type::SparseVector);
+                    std::uint64_t nextIndex = 0;
+                    std::uint64_t nextValue = 0;
+                    writeSparseData(writer, length, count, valType, [&]() {
+                        while (isZero(ptr + nextIndex * valSize, valSize)) {
+                            nextIndex++;
+                        }
+                        return nextIndex++;
+                    }, [&]() {
+                        while (isZero(ptr + nextValue * valSize, valSize)) {
+                            nextValue++;
+                        }
+                        return ptr + valSize * nextValue++;
+                    });
+                    ptr += length * valSize;
+                    return;
+                }
+            }
+
+            if (mayBeSparse) {
+                writeType(writer, Type::Vector);
+            }
+            writeLength(writer, length);
+            writeType(writer, valType);
+            writeValues(writer, ptr, length, valType);
+            ptr += length * valSize;
+        }
+
+        template<typename Writer>
+        inline void writeMap(Writer& writer, Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            DecodeDepthGuard depthGuard;
+            auto length = readLength(ptr, endPtr);
+            // a pair is at least its header and two type headers
+            if (length > std::uint64_t(endPtr - ptr) / 3) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+
+            // every pair is made canonical first, then theyre written out in key order
+            struct Entry {
+                std::size_t offset;
+                std::size_t keySize;
+                std::size_t size;
+            };
+            ROBN entryBytes;
+            std::vector<Entry> entries;
+            entries.reserve(length);
+            ROBNWriter entryWriter(entryBytes);
+            for (std::uint64_t i = 0; i < length; ++i) {
+                if (removeEndianness(readType(ptr, endPtr)) != Type::Pair) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                Entry entry{entryBytes.size(), 0, 0};
+                writeType(entryWriter, Type::Pair);
+                writeElement(entryWriter, ptr, endPtr, readType(ptr, endPtr));
+                entry.keySize = entryBytes.size() - entry.offset - 1;
+                writeElement(entryWriter, ptr, endPtr, readType(ptr, endPtr));
+                entry.size = entryBytes.size() - entry.offset;
+                entries.emplace_back(entry);
+            }
+            std::stable_sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+                auto result = std::memcmp(entryBytes.data() + a.offset + 1, entryBytes.data() + b.offset + 1,
+                                          std::min(a.keySize, b.keySize));
+                return result != 0 ? result < 0 : a.keySize < b.keySize;
+            });
+            // two pairs with the same canonical key have no canonical order, and decoding them depends
+            // on the container, so theres no single form to give them
+            auto sameKey = [&](const Entry& a, const Entry& b) {
+                return a.keySize == b.keySize &&
+                       std::memcmp(entryBytes.data() + a.offset + 1, entryBytes.data() + b.offset + 1, a.keySize) == 0;
+            };
+            if (std::adjacent_find(entries.begin(), entries.end(), sameKey) != entries.end()) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Duplicate map key");
+            }
+
+            writeLength(writer, length);
+            for (const auto& entry : entries) {
+                writer.write(entryBytes.data() + entry.offset, entry.size);
+            }
+        }
+
+        template<typename Writer>
+        inline void writeNDArray(Writer& writer, Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            std::vector<std::uint64_t> shape;
+            auto header = readNDArrayHeader(ptr, endPtr, [&](std::uint64_t extent) {
+                shape.emplace_back(toLittleEndian(extent));
+            });
+            writeType(writer, Type::Vector);
+            writeLength(writer, shape.size());
+            // the shape always says its uInt64, unless its empty (rank 0), then its Undefined like any empty vector
+            writeType(writer, shape.empty() ? Type::Undefined : Type::uInt64);
+            writer.write(shape.data(), shape.size() * 8);
+            writeType(writer, header.valType);
+            writeValues(writer, ptr, header.count, header.valType);
+            ptr += header.count * primitiveTypeSize(removeEndianness(header.valType));
+        }
+
+        template<typename Writer>
+        inline void writeChecksummed(Writer& writer, Byte*& ptr, const Byte* const endPtr, Type type) {
+            ROGUELIB_STACKTRACE
+            DecodeDepthGuard depthGuard;
+            Byte* frameEnd;
+            auto* payloadEnd = openChecksummedROBN(ptr, endPtr, type, frameEnd);
+            // into a buffer, a CRC32CWriter here would make a new writer type for every level of nesting
+            ROBN payload;
+            ROBNWriter payloadWriter(payload);
+            writeElement(payloadWriter, ptr, payloadEnd, readType(ptr, payloadEnd));
+            if (ptr != payloadEnd) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            writer.write(payload.data(), payload.size());
+            writeType(writer, Type::uInt32);
+            auto checksum = toLittleEndian(crc32c(payload.data(), payload.size()));
+            writer.write(&checksum, 4);
+            ptr = frameEnd;
+        }
+
+        // Polymorphic tags and Variant indices, the smallest unsigned type that fits, same as writeTagROBN
+        template<typename Writer>
+        inline void writeTag(Writer& writer, std::uint32_t tag) {
+            if (tag <= 0xFF) {
+                writeType(writer, Type::uInt8);
+                auto narrowTag = std::uint8_t(tag);
+                writer.write(&narrowTag, 1);
+            } else {
+                writeType(writer, Type::uInt16);
+                auto narrowTag = toLittleEndian(std::uint16_t(tag));
+                writer.write(&narrowTag, 2);
+            }
+        }
+
+        template<typename Writer>
+        inline void writeBigIntData(Writer& writer, const BigInt& val) {
+            writeLength(writer, val.limbs().size());
+            auto sign = Byte(val.isNegative());
+            writer.write(&sign, 1);
+            writeValues(writer, (const Byte*) val.limbs().data(), val.limbs().size(),
+                        static_cast<Type>(Type::uInt64 | Endianness::NATIVE));
+        }
+
+        // data only, the type is fixed by whatever holds it
+        template<typename Writer>
+        inline void writeData(Writer& writer, Byte*& ptr, const Byte* const endPtr, Type type) {
+            ROGUELIB_STACKTRACE
+            auto primitiveSize = primitiveTypeSize(removeEndianness(type));
+            if (primitiveSize) {
+                if (primitiveSize > std::uint64_t(endPtr - ptr)) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                writeValues(writer, ptr, 1, type);
+                ptr += primitiveSize;
+                return;
+            }
+            switch (removeEndianness(type)) {
+                default:
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                case Type::String: {
+                    auto length = strnlen((const char*) (ptr), std::size_t(endPtr - ptr));
+                    if (length == std::size_t(endPtr - ptr)) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    writer.write(ptr, length + 1);
+                    ptr += length + 1;
+                    return;
+                }
+                case Type::Vector:
+                    writeVector(writer, ptr, endPtr, false);
+                    return;
+                case Type::Pair: {
+                    DecodeDepthGuard depthGuard;
+                    writeElement(writer, ptr, endPtr, readType(ptr, endPtr));
+                    writeElement(writer, ptr, endPtr, readType(ptr, endPtr));
+                    return;
+                }
+                case Type::Map:
+                    writeMap(writer, ptr, endPtr);
+                    return;
+                case Type::NDArray:
+                    writeNDArray(writer, ptr, endPtr);
+                    return;
+                case Type::SparseVector:
+                    writeSparse(writer, ptr, endPtr, false);
+                    return;
+                case Type::Checksummed:
+                    writeChecksummed(writer, ptr, endPtr, type);
+                    return;
+                case Type::Polymorphic: {
+                    DecodeDepthGuard depthGuard;
+                    auto tag = readPolymorphicTag(ptr, endPtr);
+                    writeTag(writer, tag);
+                    if (tag != 0) {
+                        writeElement(writer, ptr, endPtr, readType(ptr, endPtr));
+                    }
+                    return;
+                }
+                case Type::Tuple: {
+                    DecodeDepthGuard depthGuard;
+                    auto count = readLength(ptr, endPtr);
+                    writeLength(writer, count);
+                    for (std::uint64_t i = 0; i < count; ++i) {
+                        writeElement(writer, ptr, endPtr, readType(ptr, endPtr));
+                    }
+                    return;
+                }
+                case Type::Optional: {
+                    DecodeDepthGuard depthGuard;
+                    if (ptr >= endPtr || std::to_integer<std::uint8_t>(*ptr) > 1) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    writer.write(ptr, 1);
+                    if (*ptr++ != Byte{0}) {
+                        writeElement(writer, ptr, endPtr, readType(ptr, endPtr));
+                    }
+                    return;
+                }
+                case Type::Variant: {
+                    DecodeDepthGuard depthGuard;
+                    auto index = readLength(ptr, endPtr);
+                    if (index > 0xFFFF) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    writeTag(writer, std::uint32_t(index));
+                    writeElement(writer, ptr, endPtr, readType(ptr, endPtr));
+                    return;
+                }
+                case Type::BigInt: {
+                    // reading it normalizes it
+                    BigInt value;
+                    readBigIntData(value, ptr, endPtr, type);
+                    writeBigIntData(writer, value);
+                    return;
+                }
+                case Type::BigFloat: {
+                    BigFloat value;
+                    readBigFloat(value, ptr, endPtr, type);
+                    value.normalize();
+                    writeType(writer, Type::Int64);
+                    auto exponent = toLittleEndian(value.exponent);
+                    writer.write(&exponent, 8);
+                    writeBigIntData(writer, value.mantissa);
+                    return;
+                }
+            }
+        }
+
+        // a full element, whose type header has been read, the type written might not be the same one
+        template<typename Writer>
+        inline void writeElement(Writer& writer, Byte*& ptr, const Byte* const endPtr, Type type) {
+            ROGUELIB_STACKTRACE
+            switch (removeEndianness(type)) {
+                default:
+                    writeType(writer, type);
+                    writeData(writer, ptr, endPtr, type);
+                    return;
+                case Type::Vector:
+                    writeVector(writer, ptr, endPtr, true);
+                    return;
+                case Type::SparseVector:
+                    writeSparse(writer, ptr, endPtr, true);
+                    return;
+                case Type::Compressed: {
+                    DecodeDepthGuard depthGuard;
+                    // back to the type header, decompressROBN reads it again
+                    auto payload = decompressROBN(--ptr, endPtr);
+                    auto* payloadPtr = payload.data();
+                    auto* payloadEnd = payload.data() + payload.size();
+                    writeElement(writer, payloadPtr, payloadEnd, readType(payloadPtr, payloadEnd));
+                    if (payloadPtr != payloadEnd) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    return;
+                }
+            }
+        }
+    }
+
+    /**
+     * writes the canonical form of every element from ptr to endPtr
+     */
+    template<typename Writer>
+    void writeCanonicalROBN(Writer& writer, const Byte* ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        auto* readPtr = const_cast<Byte*>(ptr);
+        while (readPtr < endPtr) {
+            CanonicalDetail::writeElement(writer, readPtr, endPtr, CanonicalDetail::readType(readPtr, endPtr));
+        }
+    }
+
+    inline ROBN canonicalizeROBN(const ROBN& bytes) {
+        ROGUELIB_STACKTRACE
+        ROBN canonical;
+        canonical.reserve(bytes.size());
+        ROBNWriter writer(canonical);
+        writeCanonicalROBN(writer, bytes.data(), bytes.data() + bytes.size());
+        return canonical;
+    }
+
+    namespace CanonicalDetail {
+        // the normal encoding goes here first, its capacity sticks around between calls
+        inline ROBN& scratchBuffer() {
+            thread_local ROBN scratch;
+            return scratch;
+        }
+
+        template<typename T, typename Writer>
+        void encodeCanonical(Writer& writer, const T& val) {
+            auto& scratch = scratchBuffer();
+            scratch.clear();
+            ROBNWriter scratchWriter(scratch);
+            BinaryConversion<T>::writeROBN(scratchWriter, val);
+            writeCanonicalROBN(writer, scratch.data(), scratch.data() + scratch.size());
+        }
+    }
+
+    template<typename T>
+    ROBN toCanonicalROBN(const T& val) {
+        ROGUELIB_STACKTRACE
+        ROBN canonical;
+        ROBNWriter writer(canonical);
+        CanonicalDetail::encodeCanonical(writer, val);
+        return canonical;
+    }
+
+    /**
+     * canonical bytes and their ContentHash, the hash is computed as the bytes are written
+     */
+    template<typename T>
+    ROBN toCanonicalROBN(const T& val, ContentHash& hash) {
+        ROGUELIB_STACKTRACE
+        ROBN canonical;
+        ROBNWriter writer(canonical);
+        ROBNHashingWriter<ROBNWriter> hashingWriter(writer);
+        CanonicalDetail::encodeCanonical(hashingWriter, val);
+        hash = hashingWriter.digest();
+        return canonical;
+    }
+
+    /**
+     * ContentHash of val's canonical form, the canonical bytes are never stored anywhere
+     * equal values give equal hashes, no matter the host or how they were encoded
+     */
+    template<typename T>
+    ContentHash contentHash(const T& val) {
+        ROGUELIB_STACKTRACE
+        ROBNHasher hasher;
+        CanonicalDetail::encodeCanonical(hasher, val);
+        return hasher.digest();
+    }
+
+    /**
+     * ContentHash of an already encoded blob, without decoding it
+     * its the same as contentHash of the value it holds
+     */
+    inline ContentHash contentHashROBN(const Byte* data, std::size_t size) {
+        ROGUELIB_STACKTRACE
+        ROBNHasher hasher;
+        writeCanonicalROBN(hasher, data, data + size);
+        return hasher.digest();
+    }
+
+    inline ContentHash contentHashROBN(const ROBN& bytes) {
+        return contentHashROBN(bytes.data(), bytes.size());
+    }
+}
@@ -0,0 +1,246 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace RogueLib::ROBN {
+    /*
+     * CRC32C (Castagnoli polynomial), the one with hardware support
+     *
+     * SSE4.2 and ARMv8 CRC instructions are used when the compiler is allowed to (-march=native does it)
+     * everything else gets a slice-by-8 table, which is a lot slower, but gives the same answer
+     */
+    namespace CRC32CDetail {
+        // reflected
+        constexpr std::uint32_t polynomial = 0x82F63B78u;
+
+        struct Table {
+            std::uint32_t values[8][256];
+        };
+
+        constexpr Table makeTable() {
+            Table table{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1u) ^ ((crc & 1u) ? polynomial : 0u);
+                }
+                table.values[0][i] = crc;
+            }
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                for (int slice = 1; slice < 8; ++slice) {
+                    auto previous = table.values[slice - 1][i];
+                    table.values[slice][i] = (previous >> 8u) ^ table.values[0][previous & 0xFFu];
+                }
+            }
+            return table;
+        }
+
+        inline const Table& table() {
+            static constexpr Table table = makeTable();
+            return table;
+        }
+
+        // state in, state out, no pre/post inversion
+        inline std::uint32_t update(std::uint32_t crc, const Byte* data, std::size_t size) {
+#if defined(__SSE4_2__)
+            std::uint64_t crc64 = crc;
+            while (size >= 8) {
+                std::uint64_t val;
+                std::memcpy(&val, data, 8);
+                crc64 = _mm_crc32_u64(crc64, val);
+                data += 8;
+                size -= 8;
+            }
+            crc = std::uint32_t(crc64);
+            while (size--) {
+                crc = _mm_crc32_u8(crc, std::to_integer<std::uint8_t>(*data++));
+            }
+            return crc;
+#elif defined(__ARM_FEATURE_CRC32)
+            while (size >= 8) {
+                std::uint64_t val;
+                std::memcpy(&val, data, 8);
+                crc = __crc32cd(crc, val);
+                data += 8;
+                size -= 8;
+            }
+            while (size--) {
+                crc = __crc32cb(crc, std::to_integer<std::uint8_t>(*data++));
+            }
+            return crc;
+#else
+            auto& values = table().values;
+            while (size >= 8) {
+                std::uint32_t low;
+                std::uint32_t high;
+                std::memcpy(&low, data, 4);
+                std::memcpy(&high, data + 4, 4);
+#ifdef ROBN_BIG_ENDIAN
+                low = bswap_32(low);
+                high = bswap_32(high);
+#endif
+                low ^= crc;
+                crc = values[7][low & 0xFFu] ^ values[6][(low >> 8u) & 0xFFu] ^
+                      values[5][(low >> 16u) & 0xFFu] ^ values[4][low >> 24u] ^
+                      values[3][high & 0xFFu] ^ values[2][(high >> 8u) & 0xFFu] ^
+                      values[1][(high >> 16u) & 0xFFu] ^ values[0][high >> 24u];
+                data += 8;
+                size -= 8;
+            }
+            while (size--) {
+                crc = (crc >> 8u) ^ values[0][(crc ^ std::to_integer<std::uint8_t>(*data++)) & 0xFFu];
+            }
+            return crc;
+#endif
+        }
+    }
+
+    /**
+     * CRC32C of data, pass the previous result as crc to continue a checksum over more data
+     */
+    inline std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc = 0) {
+        return ~CRC32CDetail::update(~crc, (const Byte*) data, size);
+    }
+
+    /**
+     * passes everything through to another writer, checksumming it on the way
+     * so the checksum doesnt need a second pass over the encoded bytes
+     */
+    template<typename Writer>
+    class CRC32CWriter {
+        Writer& writer;
+        std::uint32_t state = ~0u;
+    public:
+        explicit CRC32CWriter(Writer& writer) : writer(writer) {
+        }
+
+        void write(const void* data, std::size_t size) {
+            state = CRC32CDetail::update(state, (const Byte*) data, size);
+            writer.write(data, size);
+        }
+
+        void writeReference(const void* data, std::size_t size) {
+            state = CRC32CDetail::update(state, (const Byte*) data, size);
+            writeReferenceROBN(writer, data, size);
+        }
+
+        [[nodiscard]] std::uint32_t checksum() const {
+            return ~state;
+        }
+    };
+
+    /**
+     * encodes val as a Checksummed element
+     * the checksum is computed while the payload is written, no extra pass
+     */
+    template<typename T, typename Writer>
+    void writeChecksummedROBN(Writer& writer, const T& val) {
+        ROGUELIB_STACKTRACE
+        auto type = Byte{Type::Checksummed};
+        writer.write(&type, 1);
+        CRC32CWriter<Writer> checksumWriter(writer);
+        BinaryConversion<T>::writeROBN(checksumWriter, val);
+        BinaryConversion<std::uint32_t>::writeROBN(writer, checksumWriter.checksum());
+    }
+
+    template<typename T>
+    ROBN toChecksummedROBN(const T& val) {
+        ROGUELIB_STACKTRACE
+        ROBN bytes;
+        ROBNWriter writer(bytes);
+        writeChecksummedROBN(writer, val);
+        return bytes;
+    }
+
+    /**
+     * checks a Checksummed element, whose type header has already been read
+     * ptr is left at the start of the payload element, the returned pointer is the end of the payload
+     * frameEnd is set to the end of the whole element, checksum included
+     * the checksum is checked before anything is decoded, so a corrupted length cant cause a giant allocation
+     */
+    inline const Byte* openChecksummedROBN(Byte*& ptr, const Byte* const endPtr, Type type, Byte*& frameEnd) {
+        ROGUELIB_STACKTRACE
+        if (removeEndianness(type) != Type::Checksummed || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        auto* payloadStart = ptr;
+        auto* payloadEnd = ptr;
+        skipROBN(++payloadEnd, endPtr, static_cast<Type>(*payloadStart));
+        auto* checksumPtr = payloadEnd;
+        auto checksum = BinaryConversion<std::uint32_t>::fromROBN(checksumPtr, endPtr);
+        if (checksum != crc32c(payloadStart, std::size_t(payloadEnd - payloadStart))) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Checksum mismatch");
+        }
+        frameEnd = checksumPtr;
+        return payloadEnd;
+    }
+
+    template<typename T>
+    T fromChecksummedROBN(Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type type = static_cast<Type>(*ptr++);
+        Byte* frameEnd;
+        auto* payloadEnd = openChecksummedROBN(ptr, endPtr, type, frameEnd);
+        T val = BinaryConversion<T>::fromROBN(ptr, payloadEnd);
+        ptr = frameEnd;
+        return val;
+    }
+
+    template<typename T>
+    T fromChecksummedROBN(const ROBN& bytes) {
+        ROGUELIB_STACKTRACE
+        auto* start = const_cast<Byte*>(bytes.data());
+        return fromChecksummedROBN<T>(start, bytes.data() + bytes.size());
+    }
+
+    template<typename T>
+    void fromChecksummedROBNInto(T& target, Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type type = static_cast<Type>(*ptr++);
+        Byte* frameEnd;
+        auto* payloadEnd = openChecksummedROBN(ptr, endPtr, type, frameEnd);
+        fromROBNInto(target, ptr, payloadEnd);
+        ptr = frameEnd;
+    }
+
+    template<typename T>
+    void fromChecksummedROBNInto(T& target, const ROBN& bytes) {
+        ROGUELIB_STACKTRACE
+        auto* start = const_cast<Byte*>(bytes.data());
+        fromChecksummedROBNInto(target, start, bytes.data() + bytes.size());
+    }
+}
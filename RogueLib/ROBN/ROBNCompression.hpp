@@ -0,0 +1,579 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace RogueLib::ROBN {
+    /**
+     * the codec byte of a Compressed element, picked per blob
+     */
+    enum class Compression : std::uint8_t {
+        NONE = 0,
+        // the LZ4 block format, any LZ4 block decoder can read the blocks
+        LZ = 1,
+    };
+
+    // big enough to compress well, small enough that a snapshot has plenty of blocks to spread over threads
+    constexpr std::uint32_t defaultCompressionBlockSize = 64 * 1024;
+    constexpr std::uint32_t maxCompressionBlockSize = 16 * 1024 * 1024;
+
+    /*
+     * LZ4 block format, greedy matching through a single hash table, the same tradeoff as LZ4's fast mode
+     *
+     * each sequence is a token, the high nibble is the literal count, the low one the match length - 4,
+     * 15 in either means more length bytes follow, each adds up to 255
+     * then the literals, then a two byte little endian offset back to the match
+     * the last sequence is only literals, and the last 5 bytes of a block are always literals
+     */
+    namespace CompressionDetail {
+        constexpr std::uint32_t hashBits = 12;
+        constexpr std::size_t minMatch = 4;
+        constexpr std::size_t lastLiterals = 5;
+        // a match cant start in the last 12 bytes
+        constexpr std::size_t matchFindLimit = 12;
+        constexpr std::size_t maxOffset = 0xFFFF;
+
+        inline std::uint32_t read32(const std::uint8_t* ptr) {
+            std::uint32_t val;
+            std::memcpy(&val, ptr, 4);
+            return val;
+        }
+
+        inline std::uint64_t read64(const std::uint8_t* ptr) {
+            std::uint64_t val;
+            std::memcpy(&val, ptr, 8);
+            return val;
+        }
+
+        inline std::uint32_t hash(std::uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32u - hashBits);
+        }
+
+        // how many bytes from a and b match, a doesnt go past limit
+        inline std::size_t matchLength(const std::uint8_t* a, const std::uint8_t* b, const std::uint8_t* limit) {
+            auto* start = a;
+            while (a + 8 <= limit) {
+                auto diff = read64(a) ^ read64(b);
+                if (diff != 0) {
+#ifdef ROBN_BIG_ENDIAN
+                    return std::size_t(a - start) + std::size_t(__builtin_clzll(diff) >> 3u);
+#else
+                    return std::size_t(a - start) + std::size_t(__builtin_ctzll(diff) >> 3u);
+#endif
+                }
+                a += 8;
+                b += 8;
+            }
+            while (a < limit && *a == *b) {
+                a++;
+                b++;
+            }
+            return std::size_t(a - start);
+        }
+
+        inline std::uint8_t* writeLength(std::uint8_t* op, std::size_t length) {
+            while (length >= 255) {
+                *op++ = 255;
+                length -= 255;
+            }
+            *op++ = std::uint8_t(length);
+            return op;
+        }
+
+        // the token and the literals, the match half of the token is filled in after
+        inline std::uint8_t* writeLiterals(std::uint8_t* op, const std::uint8_t* literals, std::size_t length) {
+            if (length >= 15) {
+                *op++ = 0xF0;
+                op = writeLength(op, length - 15);
+            } else {
+                *op++ = std::uint8_t(length << 4u);
+            }
+            std::memcpy(op, literals, length);
+            return op + length;
+        }
+
+        // running out of input gives a length too long for anything, so the caller's bounds checks catch it
+        inline std::size_t readLength(const std::uint8_t*& ip, const std::uint8_t* const ipEnd) {
+            std::size_t length = 0;
+            std::uint8_t byte;
+            do {
+                if (ip >= ipEnd) {
+                    return SIZE_MAX / 2;
+                }
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255);
+            return length;
+        }
+    }
+
+    /**
+     * the most compressLZ can write for size bytes
+     */
+    constexpr std::size_t compressBoundLZ(std::size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    /**
+     * compresses size bytes into destination, which must have room for compressBoundLZ(size), returns the size written
+     */
+    inline std::size_t compressLZ(const Byte* source, std::size_t size, Byte* destination) {
+        using namespace CompressionDetail;
+        auto* src = (const std::uint8_t*) source;
+        auto* op = (std::uint8_t*) destination;
+        auto* anchor = src;
+        if (size > matchFindLimit) {
+            std::uint32_t table[1u << hashBits] = {};
+            auto* ip = src + 1;
+            auto* matchLimit = src + size - lastLiterals;
+            auto* findLimit = src + size - matchFindLimit;
+            while (ip < findLimit) {
+                auto sequence = read32(ip);
+                auto& entry = table[hash(sequence)];
+                auto* ref = src + entry;
+                entry = std::uint32_t(ip - src);
+                if (std::size_t(ip - ref) > maxOffset || read32(ref) != sequence) {
+                    // the longer it goes without a match, the faster it skips ahead
+                    ip += 1 + (std::size_t(ip - anchor) >> 6u);
+                    continue;
+                }
+                while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                    ip--;
+                    ref--;
+                }
+                auto length = matchLength(ip + minMatch, ref + minMatch, matchLimit);
+                auto* token = op;
+                op = writeLiterals(op, anchor, std::size_t(ip - anchor));
+                auto offset = std::size_t(ip - ref);
+                *op++ = std::uint8_t(offset);
+                *op++ = std::uint8_t(offset >> 8u);
+                if (length >= 15) {
+                    *token |= 15;
+                    op = writeLength(op, length - 15);
+                } else {
+                    *token |= std::uint8_t(length);
+                }
+                ip += length + minMatch;
+                anchor = ip;
+                // so a match right after this one can be found
+                if (ip < findLimit) {
+                    table[hash(read32(ip - 2))] = std::uint32_t(ip - 2 - src);
+                }
+            }
+        }
+        op = writeLiterals(op, anchor, std::size_t(src + size - anchor));
+        return std::size_t(op - (std::uint8_t*) destination);
+    }
+
+    /**
+     * decompresses size bytes from source into exactly decompressedSize bytes at destination
+     * never reads or writes outside of either, anything malformed throws
+     */
+    inline void decompressLZ(const Byte* source, std::size_t size, Byte* destination, std::size_t decompressedSize) {
+        ROGUELIB_STACKTRACE
+        using namespace CompressionDetail;
+        auto* ip = (const std::uint8_t*) source;
+        auto* const ipEnd = ip + size;
+        auto* op = (std::uint8_t*) destination;
+        auto* const opStart = op;
+        auto* const opEnd = op + decompressedSize;
+        while (true) {
+            if (ip >= ipEnd) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            auto token = *ip++;
+            std::size_t literalLength = token >> 4u;
+            if (literalLength == 15) {
+                literalLength += readLength(ip, ipEnd);
+            }
+            if (literalLength > std::size_t(ipEnd - ip) || literalLength > std::size_t(opEnd - op)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            // short runs as one fixed size copy when theres room past them, whatever extra it copies gets overwritten
+            if (literalLength <= 16 && ipEnd - ip >= 16 && opEnd - op >= 16) {
+                std::memcpy(op, ip, 16);
+            } else {
+                std::memcpy(op, ip, literalLength);
+            }
+            ip += literalLength;
+            op += literalLength;
+            if (ip == ipEnd) {
+                break;
+            }
+            if (ipEnd - ip < 2) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            std::size_t offset = std::size_t(ip[0]) | (std::size_t(ip[1]) << 8u);
+            ip += 2;
+            std::size_t length = token & 15u;
+            if (length == 15) {
+                length += readLength(ip, ipEnd);
+            }
+            length += minMatch;
+            if (offset == 0 || offset > std::size_t(op - opStart) || length > std::size_t(opEnd - op)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            auto* match = op - offset;
+            if (offset >= 8 && std::size_t(opEnd - op) >= length + 8) {
+                // 8 bytes at a time never overlaps what its copying, and can go a little past the end of the match
+                for (std::size_t i = 0; i < length; i += 8) {
+                    std::memcpy(op + i, match + i, 8);
+                }
+            } else if (offset >= 8) {
+                for (std::size_t i = 0; i < length; i += 8) {
+                    std::memcpy(op + i, match + i, std::min<std::size_t>(8, length - i));
+                }
+            } else {
+                // a short repeating pattern, it has to go a byte at a time
+                for (std::size_t i = 0; i < length; ++i) {
+                    op[i] = match[i];
+                }
+            }
+            op += length;
+        }
+        if (op != opEnd) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+    }
+
+    /**
+     * a writer that compresses everything written to it into a Compressed element on writer
+     * the type header and codec go out when its constructed, then a block every blockSize bytes, finish ends it
+     * whatever is written has to be exactly one element
+     *
+     * blocks are written as they fill, so memory use is a couple of blocks, however much is encoded
+     */
+    template<typename Writer>
+    class ROBNCompressingWriter {
+        Writer& writer;
+        Compression codec;
+        std::uint32_t blockSize;
+        ROBN buffer;
+        std::size_t buffered = 0;
+        ROBN compressed;
+        bool finished = false;
+
+        void writeBlock(const Byte* data, std::size_t size) {
+            BinaryConversion<std::uint32_t>::writeROBN(writer, std::uint32_t(size));
+            if (codec == Compression::LZ) {
+                compressed.resize(compressBoundLZ(size));
+                auto compressedSize = compressLZ(data, size, compressed.data());
+                // stored as is when it doesnt get any smaller
+                if (compressedSize < size) {
+                    BinaryConversion<std::uint32_t>::writeROBN(writer, std::uint32_t(compressedSize));
+                    writer.write(compressed.data(), compressedSize);
+                    return;
+                }
+            }
+            BinaryConversion<std::uint32_t>::writeROBN(writer, std::uint32_t(size));
+            writer.write(data, size);
+        }
+
+    public:
+        explicit ROBNCompressingWriter(Writer& writer, Compression codec = Compression::LZ,
+                                       std::uint32_t blockSize = defaultCompressionBlockSize)
+                : writer(writer), codec(codec), blockSize(blockSize) {
+            ROGUELIB_STACKTRACE
+            if (blockSize == 0 || blockSize > maxCompressionBlockSize ||
+                (codec != Compression::NONE && codec != Compression::LZ)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Invalid compression settings");
+            }
+            auto type = Byte{Type::Compressed};
+            writer.write(&type, 1);
+            auto codecByte = Byte(codec);
+            writer.write(&codecByte, 1);
+        }
+
+        ROBNCompressingWriter(const ROBNCompressingWriter&) = delete;
+
+        ROBNCompressingWriter& operator=(const ROBNCompressingWriter&) = delete;
+
+        void write(const void* data, std::size_t size) {
+            auto* ptr = (const Byte*) data;
+            while (size != 0) {
+                // whole blocks dont need to be copied first
+                if (buffered == 0 && size >= blockSize) {
+                    writeBlock(ptr, blockSize);
+                    ptr += blockSize;
+                    size -= blockSize;
+                    continue;
+                }
+                if (buffer.empty()) {
+                    buffer.resize(blockSize);
+                }
+                auto taken = std::min<std::size_t>(size, blockSize - buffered);
+                std::memcpy(buffer.data() + buffered, ptr, taken);
+                buffered += taken;
+                ptr += taken;
+                size -= taken;
+                if (buffered == blockSize) {
+                    writeBlock(buffer.data(), blockSize);
+                    buffered = 0;
+                }
+            }
+        }
+
+        /**
+         * writes the last partial block and ends the element, nothing can be written after
+         */
+        void finish() {
+            if (finished) {
+                return;
+            }
+            if (buffered != 0) {
+                writeBlock(buffer.data(), buffered);
+                buffered = 0;
+            }
+            BinaryConversion<std::uint32_t>::writeROBN(writer, std::uint32_t(0));
+            finished = true;
+        }
+    };
+
+    /**
+     * encodes val as a Compressed element, the blocks are compressed while its being encoded
+     */
+    template<typename T, typename Writer>
+    void writeCompressedROBN(Writer& writer, const T& val, Compression codec = Compression::LZ,
+                             std::uint32_t blockSize = defaultCompressionBlockSize) {
+        ROGUELIB_STACKTRACE
+        ROBNCompressingWriter<Writer> compressingWriter(writer, codec, blockSize);
+        BinaryConversion<T>::writeROBN(compressingWriter, val);
+        compressingWriter.finish();
+    }
+
+    template<typename T>
+    ROBN toCompressedROBN(const T& val, Compression codec = Compression::LZ,
+                          std::uint32_t blockSize = defaultCompressionBlockSize) {
+        ROGUELIB_STACKTRACE
+        ROBN bytes;
+        ROBNWriter writer(bytes);
+        writeCompressedROBN(writer, val, codec, blockSize);
+        return bytes;
+    }
+
+    /**
+     * one block of a Compressed element, as found in the blob
+     */
+    struct CompressedBlock {
+        const Byte* data;
+        std::uint32_t storedSize;
+        std::uint32_t size;
+        // where it goes in the decompressed payload
+        std::uint64_t offset;
+    };
+
+    /**
+     * reads the block list of a Compressed element, whose type header has already been read, without decompressing
+     * anything, ptr is left after the element
+     * the decompressed size is checked against the decode limits, its allocated by whoever decompresses it
+     */
+    inline Compression readCompressedBlocks(Byte*& ptr, const Byte* const endPtr, Type type,
+                                            std::vector<CompressedBlock>& blocks, std::uint64_t& size) {
+        ROGUELIB_STACKTRACE
+        if (removeEndianness(type) != Type::Compressed || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        auto codec = static_cast<Compression>(*ptr++);
+        if (codec != Compression::NONE && codec != Compression::LZ) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        auto readSize = [&]() {
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type sizeType = static_cast<Type>(*ptr++);
+            return fromROBN<std::uint32_t>(ptr, endPtr, sizeType);
+        };
+        blocks.clear();
+        size = 0;
+        while (true) {
+            auto blockSize = readSize();
+            if (blockSize == 0) {
+                break;
+            }
+            auto storedSize = readSize();
+            // nothing grows when its compressed, and LZ cant shrink anything more than 255 times
+            if (storedSize > blockSize || storedSize > std::uint64_t(endPtr - ptr) ||
+                (codec == Compression::NONE && storedSize != blockSize) ||
+                std::uint64_t(blockSize) > std::uint64_t(storedSize) * 255) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            blocks.push_back({ptr, storedSize, blockSize, size});
+            ptr += storedSize;
+            size += blockSize;
+        }
+        checkDecodeAllocation(size, 1, 0, ptr, endPtr);
+        return codec;
+    }
+
+    /**
+     * decompresses block to its offset in payload
+     */
+    inline void decompressBlock(const CompressedBlock& block, Byte* payload) {
+        ROGUELIB_STACKTRACE
+        if (block.storedSize == block.size) {
+            std::memcpy(payload + block.offset, block.data, block.size);
+        } else {
+            decompressLZ(block.data, block.storedSize, payload + block.offset, block.size);
+        }
+    }
+
+    /**
+     * the payload element of the Compressed element at ptr (type header included), ptr is left after it
+     */
+    inline ROBN decompressROBN(Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type type = static_cast<Type>(*ptr++);
+        std::vector<CompressedBlock> blocks;
+        std::uint64_t size;
+        readCompressedBlocks(ptr, endPtr, type, blocks, size);
+        ROBN payload(size);
+        for (auto& block : blocks) {
+            decompressBlock(block, payload.data());
+        }
+        return payload;
+    }
+
+    /**
+     * same, but the blocks are decompressed in parallel, queue is anything with an enqueue(function), like a
+     * Threading::WorkQueue
+     *
+     * this thread decompresses blocks too, and only waits on blocks another thread has already started, so it
+     * cant deadlock on a queue thats busy, or that this is running on
+     */
+    template<typename Queue>
+    ROBN decompressROBN(Byte*& ptr, const Byte* const endPtr, Queue& queue) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type type = static_cast<Type>(*ptr++);
+        // shared, a helper that starts after everything is done still looks at it
+        struct State {
+            std::vector<CompressedBlock> blocks;
+            Byte* payload = nullptr;
+            std::atomic<std::size_t> nextBlock{0};
+            std::size_t doneBlocks = 0;
+            std::mutex mutex;
+            std::condition_variable allDone;
+            std::exception_ptr exception;
+
+            void run() {
+                while (true) {
+                    auto index = nextBlock.fetch_add(1, std::memory_order_relaxed);
+                    if (index >= blocks.size()) {
+                        return;
+                    }
+                    std::exception_ptr blockException;
+                    try {
+                        decompressBlock(blocks[index], payload);
+                    } catch (...) {
+                        blockException = std::current_exception();
+                    }
+                    std::lock_guard lock(mutex);
+                    if (blockException && !exception) {
+                        exception = blockException;
+                    }
+                    if (++doneBlocks == blocks.size()) {
+                        allDone.notify_all();
+                    }
+                }
+            }
+        };
+        auto state = std::make_shared<State>();
+        std::uint64_t size;
+        readCompressedBlocks(ptr, endPtr, type, state->blocks, size);
+        ROBN payload(size);
+        state->payload = payload.data();
+        auto helpers = std::min<std::size_t>(state->blocks.size(), std::max(1u, std::thread::hardware_concurrency()));
+        for (std::size_t i = 1; i < helpers; ++i) {
+            queue.enqueue([state]() {
+                state->run();
+            });
+        }
+        state->run();
+        std::unique_lock lock(state->mutex);
+        state->allDone.wait(lock, [&]() {
+            return state->doneBlocks == state->blocks.size();
+        });
+        if (state->exception) {
+            std::rethrow_exception(state->exception);
+        }
+        return payload;
+    }
+
+    template<typename T>
+    T fromCompressedROBN(Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        auto payload = decompressROBN(ptr, endPtr);
+        return fromROBN<T>(payload);
+    }
+
+    template<typename T>
+    T fromCompressedROBN(const ROBN& bytes) {
+        ROGUELIB_STACKTRACE
+        auto* start = const_cast<Byte*>(bytes.data());
+        return fromCompressedROBN<T>(start, bytes.data() + bytes.size());
+    }
+
+    template<typename T, typename Queue>
+    T fromCompressedROBN(const ROBN& bytes, Queue& queue) {
+        ROGUELIB_STACKTRACE
+        auto* start = const_cast<Byte*>(bytes.data());
+        auto payload = decompressROBN(start, bytes.data() + bytes.size(), queue);
+        return fromROBN<T>(payload);
+    }
+
+    template<typename T>
+    void fromCompressedROBNInto(T& target, Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        auto payload = decompressROBN(ptr, endPtr);
+        fromROBNInto(target, payload);
+    }
+
+    template<typename T>
+    void fromCompressedROBNInto(T& target, const ROBN& bytes) {
+        ROGUELIB_STACKTRACE
+        auto* start = const_cast<Byte*>(bytes.data());
+        fromCompressedROBNInto(target, start, bytes.data() + bytes.size());
+    }
+
+    template<typename T, typename Queue>
+    void fromCompressedROBNInto(T& target, const ROBN& bytes, Queue& queue) {
+        ROGUELIB_STACKTRACE
+        auto* start = const_cast<Byte*>(bytes.data());
+        auto payload = decompressROBN(start, bytes.data() + bytes.size(), queue);
+        fromROBNInto(target, payload);
+    }
+}
@@ -0,0 +1,590 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+
+#include <memory>
+
+namespace RogueLib::ROBN {
+    /**
+     * bump allocator for document nodes and the bytes of values set on them
+     * nothing in here has a destructor, the whole thing goes away at once
+     */
+    class ROBNArena {
+        static constexpr std::size_t blockSize = 16384;
+
+        std::vector<std::unique_ptr<Byte[]>> blocks;
+        Byte* current = nullptr;
+        std::size_t remaining = 0;
+
+    public:
+        ROBNArena() = default;
+
+        ROBNArena(const ROBNArena&) = delete;
+
+        ROBNArena& operator=(const ROBNArena&) = delete;
+
+        void* allocate(std::size_t size, std::size_t alignment) {
+            auto padding = (alignment - (std::uintptr_t(current) & (alignment - 1))) & (alignment - 1);
+            if (size + padding > remaining) {
+                // oversized allocations get their own block, so they dont waste the rest of a normal one
+                auto newBlockSize = std::max(blockSize, size + alignment);
+                blocks.emplace_back(new Byte[newBlockSize]);
+                current = blocks.back().get();
+                remaining = newBlockSize;
+                padding = (alignment - (std::uintptr_t(current) & (alignment - 1))) & (alignment - 1);
+            }
+            auto* allocation = current + padding;
+            current += padding + size;
+            remaining -= padding + size;
+            return allocation;
+        }
+
+        template<typename T>
+        T* allocateArray(std::size_t count) {
+            static_assert(std::is_trivially_destructible<T>::value);
+            auto* array = (T*) allocate(sizeof(T) * count, alignof(T));
+            for (std::size_t i = 0; i < count; ++i) {
+                new(array + i) T();
+            }
+            return array;
+        }
+
+        Byte* copyBytes(const Byte* data, std::size_t size) {
+            auto* copy = (Byte*) allocate(size, 1);
+            std::memcpy(copy, data, size);
+            return copy;
+        }
+    };
+
+    /**
+     * one element of a ROBNDocument
+     *
+     * a node starts out as a view of its bytes, containers (Vector, Pair, Map) are only split into child nodes the
+     * first time something looks inside them, so reading one field out of a huge message only touches that field
+     * untouched nodes are re-encoded as a straight copy of their original bytes
+     *
+     * Vector children are the elements, Pair children are the first and second, Map children are its Pairs
+     * every other type is a leaf, Tuple, Optional, Variant, SparseVector, NDArray, Polymorphic, Checksummed and
+     * Compressed included, those can be read with as/into or replaced with set, but not edited in place
+     *
+     * each child is its own arena allocation, the container only holds pointers to them, so adding or removing
+     * children never moves a node, references to its siblings keep working
+     */
+    class ROBNNode {
+        friend class ROBNDocument;
+
+        ROBNArena* arena = nullptr;
+        // element data, after the type header
+        const Byte* start = nullptr;
+        std::size_t dataSize = 0;
+        ROBNNode** children = nullptr;
+        std::uint64_t childCount = 0;
+        std::uint64_t childCapacity = 0;
+        // as it is on the wire, endianness included
+        Type elementType = Type::Undefined;
+        // only for vectors, endianness included
+        Type childType = Type::Undefined;
+        bool expanded = false;
+
+        // string literals get encoded as strings
+        template<typename T>
+        using EncodedType = std::conditional_t<std::is_convertible<T, std::string>::value, std::string, T>;
+
+        static ROBN& scratchBuffer() {
+            thread_local ROBN scratch;
+            return scratch;
+        }
+
+        void initialize(ROBNArena* nodeArena, Type type, const Byte* data, std::size_t size) {
+            arena = nodeArena;
+            elementType = type;
+            start = data;
+            dataSize = size;
+            children = nullptr;
+            childCount = 0;
+            childCapacity = 0;
+            expanded = false;
+        }
+
+        // full element in, node pointing at a copy of its data in the arena
+        void initializeEncoded(ROBNArena* nodeArena, const ROBN& encoded) {
+            initialize(nodeArena, static_cast<Type>(encoded[0]),
+                       nodeArena->copyBytes(encoded.data() + 1, encoded.size() - 1), encoded.size() - 1);
+        }
+
+        // length nodes in one block, the pointer array is separate so growing it later leaves the nodes where they are
+        void allocateChildren(std::uint64_t length) {
+            auto* nodes = arena->allocateArray<ROBNNode>(length);
+            children = arena->allocateArray<ROBNNode*>(length);
+            for (std::uint64_t i = 0; i < length; ++i) {
+                children[i] = nodes + i;
+            }
+            childCount = length;
+            childCapacity = length;
+        }
+
+        void expand() {
+            ROGUELIB_STACKTRACE
+            if (expanded) {
+                return;
+            }
+            auto* ptr = const_cast<Byte*>(start);
+            const Byte* endPtr = start + dataSize;
+            auto readType = [&]() {
+                if (ptr >= endPtr) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                return static_cast<Type>(*ptr++);
+            };
+            auto readChild = [&](ROBNNode& child, Type type) {
+                auto* childStart = ptr;
+                skipROBN(ptr, endPtr, type);
+                child.initialize(arena, type, childStart, std::size_t(ptr - childStart));
+            };
+
+            switch (removeEndianness(elementType)) {
+                default:
+                    // nothing inside of it
+                    childCount = 0;
+                    break;
+                case Type::Vector: {
+                    auto length = RogueLib::ROBN::fromROBN<std::uint64_t>(ptr, endPtr, readType());
+                    childType = readType();
+                    // every element is at least a byte, a length bigger than that is a broken blob
+                    checkDecodeAllocation(length, sizeof(ROBNNode) + sizeof(ROBNNode*), 1, ptr, endPtr);
+                    allocateChildren(length);
+                    for (std::uint64_t i = 0; i < length; ++i) {
+                        readChild(*children[i], childType);
+                    }
+                    break;
+                }
+                case Type::Pair: {
+                    allocateChildren(2);
+                    readChild(*children[0], readType());
+                    readChild(*children[1], readType());
+                    break;
+                }
+                case Type::Map: {
+                    auto length = RogueLib::ROBN::fromROBN<std::uint64_t>(ptr, endPtr, readType());
+                    checkDecodeAllocation(length, sizeof(ROBNNode) + sizeof(ROBNNode*), 3, ptr, endPtr);
+                    allocateChildren(length);
+                    for (std::uint64_t i = 0; i < length; ++i) {
+                        if (readType() != Type::Pair) {
+                            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                        }
+                        readChild(*children[i], Type::Pair);
+                    }
+                    break;
+                }
+            }
+            expanded = true;
+        }
+
+        // a new node on the end, only the pointer array is reallocated (doubling), the nodes themselves dont move
+        ROBNNode& growChildren() {
+            if (childCount == childCapacity) {
+                auto newCapacity = std::max<std::uint64_t>(4, childCapacity * 2);
+                auto* newChildren = arena->allocateArray<ROBNNode*>(newCapacity);
+                std::copy(children, children + childCount, newChildren);
+                children = newChildren;
+                childCapacity = newCapacity;
+            }
+            auto* child = arena->allocateArray<ROBNNode>(1);
+            children[childCount++] = child;
+            return *child;
+        }
+
+        // the node stays in the arena, so references to it dont dangle, its just not part of the document anymore
+        void removeChild(std::uint64_t index) {
+            std::copy(children + index + 1, children + childCount, children + index);
+            childCount--;
+        }
+
+        void requireType(Type type) const {
+            ROGUELIB_STACKTRACE
+            if (removeEndianness(elementType) != type) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible type");
+            }
+        }
+
+        // index of the map pair whose key encodes to the same bytes as encodedKey, childCount if there isnt one
+        std::uint64_t findEncodedKey(const ROBN& encodedKey) {
+            requireType(Type::Map);
+            expand();
+            for (std::uint64_t i = 0; i < childCount; ++i) {
+                auto& pair = *children[i];
+                if (!pair.expanded) {
+                    // a pair's data starts with its key, type header included, and elements know where they end
+                    // so if the start matches the whole encoded key, that is the key
+                    if (pair.dataSize >= encodedKey.size() &&
+                        std::memcmp(pair.start, encodedKey.data(), encodedKey.size()) == 0) {
+                        return i;
+                    }
+                    continue;
+                }
+                if (pair.key().encode() == encodedKey) {
+                    return i;
+                }
+            }
+            return childCount;
+        }
+
+        template<typename K>
+        std::uint64_t findKey(const K& key) {
+            ROGUELIB_STACKTRACE
+            auto& scratch = scratchBuffer();
+            scratch.clear();
+            appendROBN<EncodedType<K>>(scratch, key);
+            return findEncodedKey(scratch);
+        }
+
+    public:
+
+        /**
+         * walks the children of a node, a view over its pointer array
+         */
+        class ChildIterator {
+            ROBNNode** current;
+
+        public:
+            explicit ChildIterator(ROBNNode** position) : current(position) {
+            }
+
+            ROBNNode& operator*() const {
+                return **current;
+            }
+
+            ROBNNode* operator->() const {
+                return *current;
+            }
+
+            ChildIterator& operator++() {
+                ++current;
+                return *this;
+            }
+
+            bool operator==(const ChildIterator& other) const {
+                return current == other.current;
+            }
+
+            bool operator!=(const ChildIterator& other) const {
+                return current != other.current;
+            }
+        };
+
+        /**
+         * type of this element, endianness removed
+         */
+        [[nodiscard]] Type type() const {
+            return removeEndianness(elementType);
+        }
+
+        [[nodiscard]] bool isContainer() const {
+            auto baseType = type();
+            return baseType == Type::Vector || baseType == Type::Pair || baseType == Type::Map;
+        }
+
+        /**
+         * number of children, vector elements, map pairs, or 2 for a pair, 0 for everything else
+         */
+        std::uint64_t size() {
+            expand();
+            return childCount;
+        }
+
+        ROBNNode& operator[](std::uint64_t index) {
+            ROGUELIB_STACKTRACE
+            expand();
+            if (index >= childCount) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Index out of range");
+            }
+            return *children[index];
+        }
+
+        ChildIterator begin() {
+            expand();
+            return ChildIterator(children);
+        }
+
+        ChildIterator end() {
+            expand();
+            return ChildIterator(children + childCount);
+        }
+
+        // for pairs, and so the pairs in a map
+        ROBNNode& key() {
+            requireType(Type::Pair);
+            return (*this)[0];
+        }
+
+        ROBNNode& value() {
+            requireType(Type::Pair);
+            return (*this)[1];
+        }
+
+        /**
+         * map lookup, returns the value node, or nullptr if there is no pair with that key
+         * keys are matched by their encoding, so the key type has to match what was encoded
+         */
+        template<typename K, typename std::enable_if_t<!std::is_convertible<K, std::string>::value, int> = 0>
+        ROBNNode* find(const K& key) {
+            auto index = findKey(key);
+            return index == childCount ? nullptr : &children[index]->value();
+        }
+
+        ROBNNode* find(const std::string& key) {
+            auto index = findKey(key);
+            return index == childCount ? nullptr : &children[index]->value();
+        }
+
+        template<typename K, typename std::enable_if_t<!std::is_convertible<K, std::string>::value, int> = 0>
+        ROBNNode& at(const K& key) {
+            ROGUELIB_STACKTRACE
+            auto* node = find(key);
+            if (!node) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Key not found");
+            }
+            return *node;
+        }
+
+        ROBNNode& at(const std::string& key) {
+            ROGUELIB_STACKTRACE
+            auto* node = find(key);
+            if (!node) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Key not found");
+            }
+            return *node;
+        }
+
+        template<typename T>
+        T as() {
+            ROGUELIB_STACKTRACE
+            if (!expanded) {
+                auto* ptr = const_cast<Byte*>(start);
+                return RogueLib::ROBN::fromROBN<T>(ptr, start + dataSize, elementType);
+            }
+            // something under here may have changed, so it has to go through the encoder
+            auto bytes = encode();
+            auto* ptr = bytes.data();
+            return BinaryConversion<T>::fromROBN(ptr, bytes.data() + bytes.size());
+        }
+
+        template<typename T>
+        void into(T& target) {
+            ROGUELIB_STACKTRACE
+            if (!expanded) {
+                auto* ptr = const_cast<Byte*>(start);
+                fromROBNInto(target, ptr, start + dataSize, elementType);
+                return;
+            }
+            fromROBNInto(target, encode());
+        }
+
+        /**
+         * replaces this element with val, the type can change
+         * vector elements have to stay the same type as the rest of the vector, or encoding the vector will throw
+         */
+        template<typename T>
+        void set(const T& val) {
+            ROGUELIB_STACKTRACE
+            auto& scratch = scratchBuffer();
+            scratch.clear();
+            appendROBN<EncodedType<T>>(scratch, val);
+            initializeEncoded(arena, scratch);
+        }
+
+        /**
+         * sets the value for key, adding a pair if the map doesnt have one
+         */
+        template<typename K, typename V>
+        ROBNNode& insert(const K& key, const V& val) {
+            ROGUELIB_STACKTRACE
+            auto* existing = find(key);
+            if (existing) {
+                existing->set(val);
+                return *existing;
+            }
+            ROBN encoded;
+            appendROBN(encoded, std::pair<EncodedType<K>, EncodedType<V>>(key, val));
+            auto& pair = growChildren();
+            pair.initializeEncoded(arena, encoded);
+            return pair.value();
+        }
+
+        /**
+         * removes the pair with this key from a map, returns false if there wasnt one
+         */
+        template<typename K>
+        bool erase(const K& key) {
+            ROGUELIB_STACKTRACE
+            auto index = findKey(key);
+            if (index == childCount) {
+                return false;
+            }
+            removeChild(index);
+            return true;
+        }
+
+        template<typename T>
+        ROBNNode& pushBack(const T& val) {
+            ROGUELIB_STACKTRACE
+            requireType(Type::Vector);
+            expand();
+            ROBN encoded;
+            appendROBN<EncodedType<T>>(encoded, val);
+            if (childCount != 0 && static_cast<Type>(encoded[0]) != children[0]->elementType) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible type");
+            }
+            auto& element = growChildren();
+            element.initializeEncoded(arena, encoded);
+            return element;
+        }
+
+        void eraseIndex(std::uint64_t index) {
+            ROGUELIB_STACKTRACE
+            requireType(Type::Vector);
+            expand();
+            if (index >= childCount) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Index out of range");
+            }
+            removeChild(index);
+        }
+
+        /**
+         * element data, without the type header
+         */
+        template<typename Writer>
+        void writeData(Writer& writer) const {
+            ROGUELIB_STACKTRACE
+            if (!expanded) {
+                writeReferenceROBN(writer, start, dataSize);
+                return;
+            }
+            switch (removeEndianness(elementType)) {
+                default:
+                    writeReferenceROBN(writer, start, dataSize);
+                    return;
+                case Type::Vector: {
+                    writeLengthROBN(writer, childCount);
+                    auto valType = Byte(childCount ? children[0]->elementType : Type::Undefined);
+                    writer.write(&valType, 1);
+                    for (std::uint64_t i = 0; i < childCount; ++i) {
+                        if (children[i]->elementType != children[0]->elementType) {
+                            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible type");
+                        }
+                        children[i]->writeData(writer);
+                    }
+                    return;
+                }
+                case Type::Pair: {
+                    children[0]->write(writer);
+                    children[1]->write(writer);
+                    return;
+                }
+                case Type::Map: {
+                    writeLengthROBN(writer, childCount);
+                    for (std::uint64_t i = 0; i < childCount; ++i) {
+                        children[i]->write(writer);
+                    }
+                    return;
+                }
+            }
+        }
+
+        /**
+         * full element, type header included
+         */
+        template<typename Writer>
+        void write(Writer& writer) const {
+            auto type = Byte(elementType);
+            writer.write(&type, 1);
+            writeData(writer);
+        }
+
+        [[nodiscard]] ROBN encode() const {
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            write(writer);
+            return bytes;
+        }
+    };
+
+    /**
+     * a ROBN blob of any shape, as a tree of nodes
+     *
+     * for when there is no C++ type to decode into, or only a few fields need to be read or changed
+     * the document keeps its own copy of the blob, nodes point into it until they are changed
+     * nodes (and references to them) stay valid as long as the document does, adding or removing siblings doesnt
+     * move them, a child removed from its container is still there, just no longer part of the document
+     * only Vector, Pair and Map can be edited below the node, see ROBNNode for the leaf types
+     */
+    class ROBNDocument {
+        ROBN source;
+        std::unique_ptr<ROBNArena> arena;
+        ROBNNode* rootNode;
+
+    public:
+        explicit ROBNDocument(ROBN bytes) : source(std::move(bytes)), arena(std::make_unique<ROBNArena>()) {
+            ROGUELIB_STACKTRACE
+            if (source.empty()) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            // only the outer element is checked here, the rest is checked as its expanded
+            auto* ptr = source.data() + 1;
+            const Byte* endPtr = source.data() + source.size();
+            auto type = static_cast<Type>(source[0]);
+            skipROBN(ptr, endPtr, type);
+            if (ptr != endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            rootNode = arena->allocateArray<ROBNNode>(1);
+            rootNode->initialize(arena.get(), type, source.data() + 1, source.size() - 1);
+        }
+
+        ROBNDocument(const Byte* data, std::size_t size) : ROBNDocument(ROBN(data, data + size)) {
+        }
+
+        ROBNNode& root() {
+            return *rootNode;
+        }
+
+        ROBNNode& operator*() {
+            return *rootNode;
+        }
+
+        ROBNNode* operator->() {
+            return rootNode;
+        }
+
+        template<typename Writer>
+        void write(Writer& writer) const {
+            rootNode->write(writer);
+        }
+
+        [[nodiscard]] ROBN encode() const {
+            return rootNode->encode();
+        }
+    };
+}
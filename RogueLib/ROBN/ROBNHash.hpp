@@ -0,0 +1,260 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+
+namespace RogueLib::ROBN {
+    /**
+     * wyhash style 64 bit hash over raw ROBN bytes
+     * this is for hash tables in the same process, its NOT stable across endiannesses and NOT cryptographic
+     *
+     * everything up to 16 bytes is two multiplies, which is most keys
+     */
+    namespace HashDetail {
+        constexpr std::uint64_t secret[4] = {
+                0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+        };
+
+        // 64x64->128 multiply, low half in a, high half in b
+        inline void multiply(std::uint64_t& a, std::uint64_t& b) {
+            __uint128_t result = __uint128_t(a) * b;
+            a = std::uint64_t(result);
+            b = std::uint64_t(result >> 64u);
+        }
+
+        inline std::uint64_t mix(std::uint64_t a, std::uint64_t b) {
+            multiply(a, b);
+            return a ^ b;
+        }
+
+        inline std::uint64_t read8(const Byte* ptr) {
+            std::uint64_t val;
+            std::memcpy(&val, ptr, 8);
+            return val;
+        }
+
+        inline std::uint64_t read4(const Byte* ptr) {
+            std::uint32_t val;
+            std::memcpy(&val, ptr, 4);
+            return val;
+        }
+
+        // 1-3 bytes, first middle and last, which covers all of them
+        inline std::uint64_t read3(const Byte* ptr, std::size_t size) {
+            return (std::to_integer<std::uint64_t>(ptr[0]) << 16u) |
+                   (std::to_integer<std::uint64_t>(ptr[size >> 1u]) << 8u) |
+                   std::to_integer<std::uint64_t>(ptr[size - 1]);
+        }
+    }
+
+    inline std::uint64_t hashROBN(const Byte* data, std::size_t size, std::uint64_t seed = 0) {
+        using namespace HashDetail;
+        const Byte* ptr = data;
+        seed ^= mix(seed ^ secret[0], secret[1]);
+        std::uint64_t a;
+        std::uint64_t b;
+        if (__builtin_expect(size <= 16, 1)) {
+            if (size >= 4) {
+                // two overlapping reads from each end
+                auto offset = (size >> 3u) << 2u;
+                a = (read4(ptr) << 32u) | read4(ptr + offset);
+                b = (read4(ptr + size - 4) << 32u) | read4(ptr + size - 4 - offset);
+            } else if (size > 0) {
+                a = read3(ptr, size);
+                b = 0;
+            } else {
+                a = b = 0;
+            }
+        } else {
+            std::size_t remaining = size;
+            if (remaining > 48) {
+                // three independent lanes, so the multiplies can overlap
+                std::uint64_t seed1 = seed;
+                std::uint64_t seed2 = seed;
+                do {
+                    seed = mix(read8(ptr) ^ secret[1], read8(ptr + 8) ^ seed);
+                    seed1 = mix(read8(ptr + 16) ^ secret[2], read8(ptr + 24) ^ seed1);
+                    seed2 = mix(read8(ptr + 32) ^ secret[3], read8(ptr + 40) ^ seed2);
+                    ptr += 48;
+                    remaining -= 48;
+                } while (remaining > 48);
+                seed ^= seed1 ^ seed2;
+            }
+            while (remaining > 16) {
+                seed = mix(read8(ptr) ^ secret[1], read8(ptr + 8) ^ seed);
+                ptr += 16;
+                remaining -= 16;
+            }
+            // last 16 bytes, overlapping whatever came before it
+            a = read8(ptr + remaining - 16);
+            b = read8(ptr + remaining - 8);
+        }
+        a ^= secret[1];
+        b ^= seed;
+        multiply(a, b);
+        return mix(a ^ secret[0] ^ size, b ^ secret[1]);
+    }
+
+    inline std::uint64_t hashROBN(const ROBN& robn, std::uint64_t seed = 0) {
+        return hashROBN(robn.data(), robn.size(), seed);
+    }
+
+    /**
+     * 128 bit hash of a whole ROBN payload, for telling payloads apart by content
+     * unlike hashROBN its the same on every host, so it can be sent around and stored
+     * still NOT cryptographic, someone who controls the input can make collisions
+     */
+    struct ContentHash {
+        std::uint64_t low = 0;
+        std::uint64_t high = 0;
+
+        bool operator==(const ContentHash& other) const {
+            return low == other.low && high == other.high;
+        }
+
+        bool operator!=(const ContentHash& other) const {
+            return !(*this == other);
+        }
+
+        bool operator<(const ContentHash& other) const {
+            return high != other.high ? high < other.high : low < other.low;
+        }
+    };
+
+    /**
+     * streaming ContentHash, write bytes into it in any sized pieces, same result as all at once
+     * its a writer, so anything can be encoded straight into it
+     *
+     * four independent lanes over 64 byte blocks, so the multiplies overlap
+     */
+    class ROBNHasher {
+        static constexpr std::size_t blockSize = 64;
+
+        std::uint64_t lanes[4];
+        Byte buffer[blockSize];
+        std::size_t buffered = 0;
+        std::uint64_t totalSize = 0;
+
+        // little endian everywhere, so the hash doesnt depend on the host
+        static std::uint64_t load(const Byte* ptr) {
+            return correctEndianness(HashDetail::read8(ptr), Endianness::LITTLE);
+        }
+
+        static void block(std::uint64_t (&lanes)[4], const Byte* ptr) {
+            using namespace HashDetail;
+            for (std::size_t i = 0; i < 4; ++i) {
+                lanes[i] ^= mix(load(ptr + i * 16) ^ secret[i], load(ptr + i * 16 + 8) ^ lanes[i]);
+            }
+        }
+
+    public:
+        explicit ROBNHasher(std::uint64_t seed = 0) {
+            for (std::size_t i = 0; i < 4; ++i) {
+                lanes[i] = seed ^ HashDetail::secret[i];
+            }
+        }
+
+        void write(const void* data, std::size_t size) {
+            auto* ptr = (const Byte*) data;
+            totalSize += size;
+            if (buffered != 0) {
+                auto taken = std::min(size, blockSize - buffered);
+                std::memcpy(buffer + buffered, ptr, taken);
+                buffered += taken;
+                ptr += taken;
+                size -= taken;
+                if (buffered != blockSize) {
+                    return;
+                }
+                block(lanes, buffer);
+                buffered = 0;
+            }
+            // whole blocks straight from the input
+            while (size >= blockSize) {
+                block(lanes, ptr);
+                ptr += blockSize;
+                size -= blockSize;
+            }
+            std::memcpy(buffer, ptr, size);
+            buffered = size;
+        }
+
+        /**
+         * hash of everything written so far, more can be written after
+         */
+        [[nodiscard]] ContentHash digest() const {
+            using namespace HashDetail;
+            std::uint64_t finalLanes[4] = {lanes[0], lanes[1], lanes[2], lanes[3]};
+            if (buffered != 0) {
+                // zero padded, the total size is mixed in below so that cant collide with real zeros
+                Byte last[blockSize] = {};
+                std::memcpy(last, buffer, buffered);
+                block(finalLanes, last);
+            }
+            auto x = mix(finalLanes[0] ^ secret[0], finalLanes[2] ^ totalSize);
+            auto y = mix(finalLanes[1] ^ secret[2], finalLanes[3] ^ totalSize ^ secret[3]);
+            return {mix(x ^ secret[1], y ^ secret[0]), mix(y ^ secret[3], x ^ secret[2])};
+        }
+
+        [[nodiscard]] std::uint64_t size() const {
+            return totalSize;
+        }
+    };
+
+    /**
+     * passes everything through to writer, hashing it on the way
+     */
+    template<typename Writer>
+    class ROBNHashingWriter {
+        Writer& writer;
+        ROBNHasher hasher;
+    public:
+        explicit ROBNHashingWriter(Writer& writer) : writer(writer) {
+        }
+
+        void write(const void* data, std::size_t size) {
+            hasher.write(data, size);
+            writer.write(data, size);
+        }
+
+        void writeReference(const void* data, std::size_t size) {
+            hasher.write(data, size);
+            writeReferenceROBN(writer, data, size);
+        }
+
+        [[nodiscard]] ContentHash digest() const {
+            return hasher.digest();
+        }
+    };
+}
+
+namespace std {
+    template<>
+    struct hash<RogueLib::ROBN::ContentHash> {
+        std::size_t operator()(const RogueLib::ROBN::ContentHash& hash) const noexcept {
+            // its already well mixed
+            return std::size_t(hash.low);
+        }
+    };
+}
@@ -0,0 +1,918 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+#include "ROBNChecksum.hpp"
+#include "ROBNCompression.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * JSON MAPPING Description
+ *
+ * ROBN to JSON is for people and log pipelines to read, each type becomes whatever JSON has thats closest
+ *
+ * String is a string, its bytes are copied as they are (so UTF-8 stays UTF-8), " \ and control characters are escaped
+ * Bool is true or false
+ * every integer type, BigInt included, is a number, exactly, however many digits that takes
+ * Float, Double, and LongDouble are the shortest number that reads back as the same value, always with a . or an
+ *      exponent so they stay floating point, NaN and the infinities are null
+ * BigFloat is {"mantissa":<integer>,"exponent":<integer>}
+ * Vector, Tuple, and Pair are arrays, a SparseVector is the dense array it stands for
+ * NDArray is {"shape":[<extents>],"data":[<every element, row major>]}
+ * Map is an object, keys that arent Strings are their own JSON, as a string
+ * Optional is null or its value, Variant is its value
+ * Polymorphic is null for a null pointer, or {"tag":<tag>,"value":<object>}
+ * Checksummed and Compressed are their payload, the checksum is checked
+ * consecutive elements are separate JSON values, one per line
+ *
+ * JSON to ROBN
+ *
+ * null is an empty Optional, true and false are Bools, strings are Strings, \u0000 isnt allowed
+ * numbers with a fraction or an exponent are Doubles, integers are Int64, or uInt64 if they dont fit, or BigInt
+ * objects are Maps from String keys, in the order they are written
+ * arrays whose elements all came out as the same type are Vectors of it, empty ones have an Undefined element type,
+ *      any other array is a Tuple
+ * lengths are uInt64, everything is native endian
+ * any number of JSON values, separated by whitespace, are consecutive elements
+ */
+
+namespace RogueLib::ROBN {
+    namespace JSONDetail {
+        struct DigitPairs {
+            char values[200];
+        };
+
+        constexpr DigitPairs makeDigitPairs() {
+            DigitPairs pairs{};
+            for (int i = 0; i < 100; ++i) {
+                pairs.values[i * 2] = char('0' + i / 10);
+                pairs.values[i * 2 + 1] = char('0' + i % 10);
+            }
+            return pairs;
+        }
+
+        inline constexpr DigitPairs digitPairs = makeDigitPairs();
+
+        // two digits per division, written backwards from end, returns where they start
+        inline char* formatUnsigned(char* end, std::uint64_t value) {
+            while (value >= 100) {
+                auto pair = (value % 100) * 2;
+                value /= 100;
+                end -= 2;
+                std::memcpy(end, digitPairs.values + pair, 2);
+            }
+            if (value >= 10) {
+                end -= 2;
+                std::memcpy(end, digitPairs.values + value * 2, 2);
+            } else {
+                *--end = char('0' + value);
+            }
+            return end;
+        }
+
+        inline void writeUnsigned(std::string& json, std::uint64_t value) {
+            char buffer[20];
+            auto* start = formatUnsigned(buffer + sizeof(buffer), value);
+            json.append(start, buffer + sizeof(buffer));
+        }
+
+        inline void writeSigned(std::string& json, std::int64_t value) {
+            if (value < 0) {
+                json += '-';
+                writeUnsigned(json, std::uint64_t(0) - std::uint64_t(value));
+            } else {
+                writeUnsigned(json, std::uint64_t(value));
+            }
+        }
+
+        inline void writeUnsigned128(std::string& json, unsigned __int128 value) {
+            char buffer[40];
+            auto* start = buffer + sizeof(buffer);
+            // 19 digits at a time, the most that always fit in 64 bits
+            constexpr std::uint64_t chunk = 10000000000000000000ull;
+            while (value > UINT64_MAX) {
+                auto* chunkEnd = start;
+                start = formatUnsigned(start, std::uint64_t(value % chunk));
+                value /= chunk;
+                while (chunkEnd - start < 19) {
+                    *--start = '0';
+                }
+            }
+            start = formatUnsigned(start, std::uint64_t(value));
+            json.append(start, buffer + sizeof(buffer));
+        }
+
+        inline void writeSigned128(std::string& json, __int128 value) {
+            if (value < 0) {
+                json += '-';
+                writeUnsigned128(json, (unsigned __int128) 0 - (unsigned __int128) value);
+            } else {
+                writeUnsigned128(json, (unsigned __int128) value);
+            }
+        }
+
+        template<typename T>
+        inline void writeFloating(std::string& json, T value) {
+            if (!std::isfinite(value)) {
+                json.append("null", 4);
+                return;
+            }
+            char buffer[64];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            json.append(buffer, result.ptr);
+            // integral values would read back as integers
+            if (std::find_if(buffer, result.ptr, [](char c) { return c == '.' || c == 'e'; }) == result.ptr) {
+                json.append(".0", 2);
+            }
+        }
+
+        /**
+         * the first " \ or control character from ptr, or end if there isnt one
+         * the only thing strings need escaped, so everything in between is copied as one block
+         */
+        inline const char* findSpecial(const char* ptr, const char* const end) {
+#if defined(__SSE2__)
+            auto quote = _mm_set1_epi8('"');
+            auto backslash = _mm_set1_epi8('\\');
+            auto control = _mm_set1_epi8(0x1F);
+            while (end - ptr >= 16) {
+                auto chunk = _mm_loadu_si128((const __m128i*) ptr);
+                // unsigned chunk <= 0x1F is min(chunk, 0x1F) == chunk
+                auto special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+                special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+                auto mask = _mm_movemask_epi8(special);
+                if (mask != 0) {
+                    return ptr + __builtin_ctz(unsigned(mask));
+                }
+                ptr += 16;
+            }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+            auto quote = vdupq_n_u8('"');
+            auto backslash = vdupq_n_u8('\\');
+            auto control = vdupq_n_u8(0x1F);
+            while (end - ptr >= 16) {
+                auto chunk = vld1q_u8((const std::uint8_t*) ptr);
+                auto special = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                        vcleq_u8(chunk, control));
+                if (vmaxvq_u8(special) != 0) {
+                    // theres one in these 16, the loop below finds which
+                    break;
+                }
+                ptr += 16;
+            }
+#endif
+            while (ptr < end) {
+                auto c = std::uint8_t(*ptr);
+                if (c == '"' || c == '\\' || c < 0x20) {
+                    return ptr;
+                }
+                ptr++;
+            }
+            return end;
+        }
+
+        inline void writeString(std::string& json, const char* data, std::size_t size) {
+            const char* end = data + size;
+            json += '"';
+            while (true) {
+                auto* special = findSpecial(data, end);
+                json.append(data, special);
+                if (special == end) {
+                    break;
+                }
+                switch (*special) {
+                    case '"':
+                        json.append("\\\"", 2);
+                        break;
+                    case '\\':
+                        json.append("\\\\", 2);
+                        break;
+                    case '\n':
+                        json.append("\\n", 2);
+                        break;
+                    case '\r':
+                        json.append("\\r", 2);
+                        break;
+                    case '\t':
+                        json.append("\\t", 2);
+                        break;
+                    default: {
+                        constexpr char hex[] = "0123456789abcdef";
+                        char escaped[6] = {'\\', 'u', '0', '0', hex[std::uint8_t(*special) >> 4u],
+                                           hex[std::uint8_t(*special) & 15u]};
+                        json.append(escaped, 6);
+                    }
+                }
+                data = special + 1;
+            }
+            json += '"';
+        }
+
+        // false if type isnt a primitive
+        inline bool writePrimitiveJSON(std::string& json, Byte*& ptr, const Byte* const endPtr, Type type) {
+            switch (removeEndianness(type)) {
+                default:
+                    return false;
+                case Type::Bool:
+                    if (fromROBN<bool>(ptr, endPtr, type)) {
+                        json.append("true", 4);
+                    } else {
+                        json.append("false", 5);
+                    }
+                    return true;
+                case Type::Int8:
+                    writeSigned(json, fromROBN<std::int8_t>(ptr, endPtr, type));
+                    return true;
+                case Type::Int16:
+                    writeSigned(json, fromROBN<std::int16_t>(ptr, endPtr, type));
+                    return true;
+                case Type::Int32:
+                    writeSigned(json, fromROBN<std::int32_t>(ptr, endPtr, type));
+                    return true;
+                case Type::Int64:
+                    writeSigned(json, fromROBN<std::int64_t>(ptr, endPtr, type));
+                    return true;
+                case Type::Int128:
+                    writeSigned128(json, fromROBN<__int128>(ptr, endPtr, type));
+                    return true;
+                case Type::uInt8:
+                    writeUnsigned(json, fromROBN<std::uint8_t>(ptr, endPtr, type));
+                    return true;
+                case Type::uInt16:
+                    writeUnsigned(json, fromROBN<std::uint16_t>(ptr, endPtr, type));
+                    return true;
+                case Type::uInt32:
+                    writeUnsigned(json, fromROBN<std::uint32_t>(ptr, endPtr, type));
+                    return true;
+                case Type::uInt64:
+                    writeUnsigned(json, fromROBN<std::uint64_t>(ptr, endPtr, type));
+                    return true;
+                case Type::uInt128:
+                    writeUnsigned128(json, fromROBN<unsigned __int128>(ptr, endPtr, type));
+                    return true;
+                case Type::Float:
+                    writeFloating(json, fromROBN<float>(ptr, endPtr, type));
+                    return true;
+                case Type::Double:
+                    writeFloating(json, fromROBN<double>(ptr, endPtr, type));
+                    return true;
+                case Type::LongDouble:
+                    writeFloating(json, fromROBN<long double>(ptr, endPtr, type));
+                    return true;
+            }
+        }
+
+        // count primitives in a row, as a JSON array's elements
+        inline void writePrimitivesJSON(std::string& json, Byte*& ptr, const Byte* const endPtr, Type type,
+                                        std::uint64_t count) {
+            for (std::uint64_t i = 0; i < count; ++i) {
+                if (i != 0) {
+                    json += ',';
+                }
+                writePrimitiveJSON(json, ptr, endPtr, type);
+            }
+        }
+
+        inline void writeElementJSON(std::string& json, Byte*& ptr, const Byte* const endPtr, Type type) {
+            ROGUELIB_STACKTRACE
+            if (writePrimitiveJSON(json, ptr, endPtr, type)) {
+                return;
+            }
+            DecodeDepthGuard depthGuard;
+            auto readType = [&]() {
+                if (ptr >= endPtr) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                return static_cast<Type>(*ptr++);
+            };
+            switch (removeEndianness(type)) {
+                default:
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                case Type::String: {
+                    auto length = strnlen((const char*) (ptr), std::size_t(endPtr - ptr));
+                    if (length == std::size_t(endPtr - ptr)) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    writeString(json, (const char*) ptr, length);
+                    ptr += length + 1;
+                    return;
+                }
+                case Type::Vector: {
+                    auto length = fromROBN<std::uint64_t>(ptr, endPtr, readType());
+                    auto valType = readType();
+                    auto valSize = primitiveTypeSize(removeEndianness(valType));
+                    json += '[';
+                    if (valSize) {
+                        if (length > std::uint64_t(endPtr - ptr) / valSize) {
+                            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                        }
+                        writePrimitivesJSON(json, ptr, endPtr, valType, length);
+                    } else {
+                        // every element takes at least a byte, so a bad length runs out of blob instead of looping
+                        for (std::uint64_t i = 0; i < length; ++i) {
+                            if (i != 0) {
+                                json += ',';
+                            }
+                            writeElementJSON(json, ptr, endPtr, valType);
+                        }
+                    }
+                    json += ']';
+                    return;
+                }
+                case Type::Pair: {
+                    json += '[';
+                    writeElementJSON(json, ptr, endPtr, readType());
+                    json += ',';
+                    writeElementJSON(json, ptr, endPtr, readType());
+                    json += ']';
+                    return;
+                }
+                case Type::Tuple: {
+                    auto count = fromROBN<std::uint64_t>(ptr, endPtr, readType());
+                    json += '[';
+                    for (std::uint64_t i = 0; i < count; ++i) {
+                        if (i != 0) {
+                            json += ',';
+                        }
+                        writeElementJSON(json, ptr, endPtr, readType());
+                    }
+                    json += ']';
+                    return;
+                }
+                case Type::Map: {
+                    auto length = fromROBN<std::uint64_t>(ptr, endPtr, readType());
+                    json += '{';
+                    for (std::uint64_t i = 0; i < length; ++i) {
+                        if (i != 0) {
+                            json += ',';
+                        }
+                        if (readType() != Type::Pair) {
+                            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                        }
+                        auto keyType = readType();
+                        if (removeEndianness(keyType) == Type::String) {
+                            writeElementJSON(json, ptr, endPtr, keyType);
+                        } else {
+                            // JSON keys are strings, so its the key's JSON, escaped into one
+                            auto keyStart = json.size();
+                            writeElementJSON(json, ptr, endPtr, keyType);
+                            std::string key(json, keyStart);
+                            json.resize(keyStart);
+                            writeString(json, key.data(), key.size());
+                        }
+                        json += ':';
+                        writeElementJSON(json, ptr, endPtr, readType());
+                    }
+                    json += '}';
+                    return;
+                }
+                case Type::SparseVector: {
+                    auto header = readSparseHeader(ptr, endPtr);
+                    // it can be far bigger than the blob, so it counts against the decode limits
+                    checkDecodeAllocation(header.length, 1, 0, ptr, endPtr);
+                    auto valSize = primitiveTypeSize(removeEndianness(header.valType));
+                    Byte zero[16] = {};
+                    std::uint64_t next = 0;
+                    auto writeZeros = [&](std::uint64_t until) {
+                        for (; next < until; ++next) {
+                            if (next != 0) {
+                                json += ',';
+                            }
+                            auto* zeroPtr = zero;
+                            writePrimitiveJSON(json, zeroPtr, zero + valSize, header.valType);
+                        }
+                    };
+                    json += '[';
+                    forEachSparseIndex(header, [&](std::uint64_t i, std::uint64_t index) {
+                        if (index < next) {
+                            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                        }
+                        writeZeros(index);
+                        if (next != 0) {
+                            json += ',';
+                        }
+                        auto* valuePtr = const_cast<Byte*>(header.values + i * valSize);
+                        writePrimitiveJSON(json, valuePtr, valuePtr + valSize, header.valType);
+                        next++;
+                    });
+                    writeZeros(header.length);
+                    json += ']';
+                    return;
+                }
+                case Type::NDArray: {
+                    json.append("{\"shape\":[", 10);
+                    bool first = true;
+                    auto header = readNDArrayHeader(ptr, endPtr, [&](std::uint64_t extent) {
+                        if (!first) {
+                            json += ',';
+                        }
+                        first = false;
+                        writeUnsigned(json, extent);
+                    });
+                    json.append("],\"data\":[", 10);
+                    writePrimitivesJSON(json, ptr, endPtr, header.valType, header.count);
+                    json.append("]}", 2);
+                    return;
+                }
+                case Type::Checksummed: {
+                    Byte* frameEnd;
+                    auto* payloadEnd = openChecksummedROBN(ptr, endPtr, type, frameEnd);
+                    auto payloadType = readType();
+                    writeElementJSON(json, ptr, payloadEnd, payloadType);
+                    ptr = frameEnd;
+                    return;
+                }
+                case Type::Compressed: {
+                    // back to the type header, decompressROBN reads it again
+                    auto payload = decompressROBN(--ptr, endPtr);
+                    auto* payloadPtr = payload.data();
+                    auto* payloadEnd = payload.data() + payload.size();
+                    if (payloadPtr == payloadEnd) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    auto payloadType = static_cast<Type>(*payloadPtr++);
+                    writeElementJSON(json, payloadPtr, payloadEnd, payloadType);
+                    return;
+                }
+                case Type::Polymorphic: {
+                    auto tag = readPolymorphicTag(ptr, endPtr);
+                    if (tag == 0) {
+                        json.append("null", 4);
+                        return;
+                    }
+                    json.append("{\"tag\":", 7);
+                    writeUnsigned(json, tag);
+                    json.append(",\"value\":", 9);
+                    writeElementJSON(json, ptr, endPtr, readType());
+                    json += '}';
+                    return;
+                }
+                case Type::Optional: {
+                    if (ptr >= endPtr || std::to_integer<std::uint8_t>(*ptr) > 1) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    if (*ptr++ == Byte{0}) {
+                        json.append("null", 4);
+                        return;
+                    }
+                    writeElementJSON(json, ptr, endPtr, readType());
+                    return;
+                }
+                case Type::Variant: {
+                    fromROBN<std::uint64_t>(ptr, endPtr, readType());
+                    writeElementJSON(json, ptr, endPtr, readType());
+                    return;
+                }
+                case Type::BigInt: {
+                    BigInt value;
+                    readBigIntData(value, ptr, endPtr, type);
+                    json += value.toString();
+                    return;
+                }
+                case Type::BigFloat: {
+                    BigFloat value;
+                    readBigFloat(value, ptr, endPtr, type);
+                    json.append("{\"mantissa\":", 12);
+                    json += value.mantissa.toString();
+                    json.append(",\"exponent\":", 12);
+                    writeSigned(json, value.exponent);
+                    json += '}';
+                    return;
+                }
+            }
+        }
+
+        class JSONReader {
+            const char* ptr;
+            const char* const end;
+            ROBN& robn;
+            ROBNWriter writer;
+            // where each element of the arrays being read starts, shared by all of them, its capacity sticks around
+            std::vector<std::size_t>& offsets;
+
+            static std::vector<std::size_t>& scratchOffsets() {
+                thread_local std::vector<std::size_t> offsets;
+                return offsets;
+            }
+
+            [[noreturn]] static void invalid() {
+                ROGUELIB_STACKTRACE
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Invalid JSON");
+            }
+
+            void skipWhitespace() {
+                while (ptr < end && (*ptr == ' ' || *ptr == '\n' || *ptr == '\r' || *ptr == '\t')) {
+                    ptr++;
+                }
+            }
+
+            void writeType(Type type) {
+                robn.push_back(Byte(type));
+            }
+
+            void expect(const char* literal, std::size_t size) {
+                if (std::size_t(end - ptr) < size || std::memcmp(ptr, literal, size) != 0) {
+                    invalid();
+                }
+                ptr += size;
+            }
+
+            // a uInt64 element to be filled in later, returns where its value goes
+            std::size_t writeLengthPlaceholder() {
+                BinaryConversion<std::uint64_t>::writeROBN(writer, 0);
+                return robn.size() - 8;
+            }
+
+            void patchLength(std::size_t position, std::uint64_t length) {
+                std::memcpy(robn.data() + position, &length, 8);
+            }
+
+            unsigned readHex4() {
+                if (end - ptr < 4) {
+                    invalid();
+                }
+                unsigned value = 0;
+                for (int i = 0; i < 4; ++i) {
+                    auto c = *ptr++;
+                    value <<= 4u;
+                    if (c >= '0' && c <= '9') {
+                        value |= unsigned(c - '0');
+                    } else if (c >= 'a' && c <= 'f') {
+                        value |= unsigned(c - 'a' + 10);
+                    } else if (c >= 'A' && c <= 'F') {
+                        value |= unsigned(c - 'A' + 10);
+                    } else {
+                        invalid();
+                    }
+                }
+                return value;
+            }
+
+            void writeUTF8(std::uint32_t codepoint) {
+                if (codepoint < 0x80) {
+                    robn.push_back(Byte(codepoint));
+                } else if (codepoint < 0x800) {
+                    robn.push_back(Byte(0xC0 | (codepoint >> 6u)));
+                    robn.push_back(Byte(0x80 | (codepoint & 0x3Fu)));
+                } else if (codepoint < 0x10000) {
+                    robn.push_back(Byte(0xE0 | (codepoint >> 12u)));
+                    robn.push_back(Byte(0x80 | ((codepoint >> 6u) & 0x3Fu)));
+                    robn.push_back(Byte(0x80 | (codepoint & 0x3Fu)));
+                } else {
+                    robn.push_back(Byte(0xF0 | (codepoint >> 18u)));
+                    robn.push_back(Byte(0x80 | ((codepoint >> 12u) & 0x3Fu)));
+                    robn.push_back(Byte(0x80 | ((codepoint >> 6u) & 0x3Fu)));
+                    robn.push_back(Byte(0x80 | (codepoint & 0x3Fu)));
+                }
+            }
+
+            // a whole String element, ptr is at the opening quote
+            void readString() {
+                writeType(Type::String);
+                ptr++;
+                while (true) {
+                    auto* special = findSpecial(ptr, end);
+                    robn.insert(robn.end(), (const Byte*) ptr, (const Byte*) special);
+                    ptr = special;
+                    if (ptr == end) {
+                        invalid();
+                    }
+                    auto c = *ptr++;
+                    if (c == '"') {
+                        break;
+                    }
+                    // raw control characters arent allowed, and neither is a null, ROBN strings end at one
+                    if (c != '\\' || ptr == end) {
+                        invalid();
+                    }
+                    switch (*ptr++) {
+                        case '"':
+                            robn.push_back(Byte('"'));
+                            break;
+                        case '\\':
+                            robn.push_back(Byte('\\'));
+                            break;
+                        case '/':
+                            robn.push_back(Byte('/'));
+                            break;
+                        case 'b':
+                            robn.push_back(Byte('\b'));
+                            break;
+                        case 'f':
+                            robn.push_back(Byte('\f'));
+                            break;
+                        case 'n':
+                            robn.push_back(Byte('\n'));
+                            break;
+                        case 'r':
+                            robn.push_back(Byte('\r'));
+                            break;
+                        case 't':
+                            robn.push_back(Byte('\t'));
+                            break;
+                        case 'u': {
+                            std::uint32_t codepoint = readHex4();
+                            if (codepoint >= 0xD800 && codepoint < 0xDC00) {
+                                // high surrogate, the low half has to be right after it
+                                expect("\\u", 2);
+                                auto low = readHex4();
+                                if (low < 0xDC00 || low >= 0xE000) {
+                                    invalid();
+                                }
+                                codepoint = 0x10000 + ((codepoint - 0xD800) << 10u) + (low - 0xDC00);
+                            } else if ((codepoint >= 0xDC00 && codepoint < 0xE000) || codepoint == 0) {
+                                invalid();
+                            }
+                            writeUTF8(codepoint);
+                            break;
+                        }
+                        default:
+                            invalid();
+                    }
+                }
+                robn.push_back(Byte{0});
+            }
+
+            void readNumber() {
+                auto* start = ptr;
+                bool negative = *ptr == '-';
+                ptr += negative;
+                auto* digitsStart = ptr;
+                if (ptr < end && *ptr == '0') {
+                    ptr++;
+                } else if (ptr < end && *ptr >= '1' && *ptr <= '9') {
+                    while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+                        ptr++;
+                    }
+                } else {
+                    invalid();
+                }
+                auto* digitsEnd = ptr;
+                bool integer = true;
+                auto readDigits = [&]() {
+                    auto* digits = ptr;
+                    while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+                        ptr++;
+                    }
+                    if (ptr == digits) {
+                        invalid();
+                    }
+                };
+                if (ptr < end && *ptr == '.') {
+                    ptr++;
+                    readDigits();
+                    integer = false;
+                }
+                if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+                    ptr++;
+                    if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+                        ptr++;
+                    }
+                    readDigits();
+                    integer = false;
+                }
+                if (!integer) {
+                    double value;
+                    auto result = std::from_chars(start, ptr, value);
+                    if (result.ec != std::errc() || result.ptr != ptr) {
+                        invalid();
+                    }
+                    BinaryConversion<double>::writeROBN(writer, value);
+                    return;
+                }
+                std::uint64_t magnitude = 0;
+                bool fits = true;
+                for (auto* digit = digitsStart; digit < digitsEnd; ++digit) {
+                    fits &= !__builtin_mul_overflow(magnitude, 10u, &magnitude) &&
+                            !__builtin_add_overflow(magnitude, std::uint64_t(*digit - '0'), &magnitude);
+                }
+                if (fits && !negative && magnitude <= std::uint64_t(INT64_MAX)) {
+                    BinaryConversion<std::int64_t>::writeROBN(writer, std::int64_t(magnitude));
+                } else if (fits && !negative) {
+                    BinaryConversion<std::uint64_t>::writeROBN(writer, magnitude);
+                } else if (fits && magnitude <= std::uint64_t(INT64_MAX) + 1) {
+                    BinaryConversion<std::int64_t>::writeROBN(writer, std::int64_t(std::uint64_t(0) - magnitude));
+                } else {
+                    BinaryConversion<BigInt>::writeROBN(writer, BigInt::fromString(std::string(start, digitsEnd)));
+                }
+            }
+
+            void readArray() {
+                ptr++;
+                DecodeDepthGuard depthGuard;
+                auto start = robn.size();
+                writeType(Type::Tuple);
+                auto lengthPosition = writeLengthPlaceholder();
+                skipWhitespace();
+                if (ptr < end && *ptr == ']') {
+                    ptr++;
+                    robn[start] = Byte{Type::Vector};
+                    writeType(Type::Undefined);
+                    return;
+                }
+                auto firstElement = offsets.size();
+                bool sameType = true;
+                while (true) {
+                    offsets.push_back(robn.size());
+                    readValue();
+                    sameType &= robn[offsets.back()] == robn[offsets[firstElement]];
+                    skipWhitespace();
+                    if (ptr < end && *ptr == ',') {
+                        ptr++;
+                    } else if (ptr < end && *ptr == ']') {
+                        ptr++;
+                        break;
+                    } else {
+                        invalid();
+                    }
+                }
+                auto count = offsets.size() - firstElement;
+                patchLength(lengthPosition, count);
+                if (sameType) {
+                    // a Tuple without the type headers of every element but the first is a Vector
+                    robn[start] = Byte{Type::Vector};
+                    auto write = robn.size();
+                    if (count > 1) {
+                        write = offsets[firstElement + 1];
+                        for (std::size_t i = 1; i < count; ++i) {
+                            auto elementStart = offsets[firstElement + i] + 1;
+                            auto elementEnd = i + 1 < count ? offsets[firstElement + i + 1] : robn.size();
+                            std::memmove(robn.data() + write, robn.data() + elementStart, elementEnd - elementStart);
+                            write += elementEnd - elementStart;
+                        }
+                    }
+                    robn.resize(write);
+                }
+                offsets.resize(firstElement);
+            }
+
+            void readObject() {
+                ptr++;
+                DecodeDepthGuard depthGuard;
+                writeType(Type::Map);
+                auto lengthPosition = writeLengthPlaceholder();
+                skipWhitespace();
+                if (ptr < end && *ptr == '}') {
+                    ptr++;
+                    return;
+                }
+                std::uint64_t count = 0;
+                while (true) {
+                    skipWhitespace();
+                    if (ptr >= end || *ptr != '"') {
+                        invalid();
+                    }
+                    writeType(Type::Pair);
+                    readString();
+                    skipWhitespace();
+                    expect(":", 1);
+                    readValue();
+                    count++;
+                    skipWhitespace();
+                    if (ptr < end && *ptr == ',') {
+                        ptr++;
+                    } else if (ptr < end && *ptr == '}') {
+                        ptr++;
+                        break;
+                    } else {
+                        invalid();
+                    }
+                }
+                patchLength(lengthPosition, count);
+            }
+
+        public:
+            JSONReader(std::string_view json, ROBN& robn)
+                    : ptr(json.data()), end(json.data() + json.size()), robn(robn), writer(robn),
+                      offsets(scratchOffsets()) {
+                offsets.clear();
+            }
+
+            void readValue() {
+                skipWhitespace();
+                if (ptr >= end) {
+                    invalid();
+                }
+                switch (*ptr) {
+                    case '{':
+                        readObject();
+                        return;
+                    case '[':
+                        readArray();
+                        return;
+                    case '"':
+                        readString();
+                        return;
+                    case 't':
+                        expect("true", 4);
+                        BinaryConversion<bool>::writeROBN(writer, true);
+                        return;
+                    case 'f':
+                        expect("false", 5);
+                        BinaryConversion<bool>::writeROBN(writer, false);
+                        return;
+                    case 'n':
+                        expect("null", 4);
+                        writeType(Type::Optional);
+                        robn.push_back(Byte{0});
+                        return;
+                    default:
+                        readNumber();
+                        return;
+                }
+            }
+
+            void readAll() {
+                skipWhitespace();
+                while (ptr < end) {
+                    readValue();
+                    // values have to be separated, or 01 would be two of them
+                    if (ptr < end && *ptr != ' ' && *ptr != '\n' && *ptr != '\r' && *ptr != '\t') {
+                        invalid();
+                    }
+                    skipWhitespace();
+                }
+            }
+        };
+    }
+
+    /**
+     * appends every element from data to the end of json, as compact JSON, one value per line
+     * nothing is decoded into objects on the way, json's capacity is reused, so a warmed up buffer doesnt allocate
+     */
+    inline void transcodeToJSON(const Byte* data, std::size_t size, std::string& json) {
+        ROGUELIB_STACKTRACE
+        auto* ptr = const_cast<Byte*>(data);
+        const Byte* endPtr = data + size;
+        while (ptr < endPtr) {
+            if (ptr != data) {
+                json += '\n';
+            }
+            Type type = static_cast<Type>(*ptr++);
+            JSONDetail::writeElementJSON(json, ptr, endPtr, type);
+        }
+    }
+
+    inline std::string toJSON(const ROBN& bytes) {
+        ROGUELIB_STACKTRACE
+        std::string json;
+        json.reserve(bytes.size() * 2);
+        transcodeToJSON(bytes.data(), bytes.size(), json);
+        return json;
+    }
+
+    /**
+     * appends an element to robn for each JSON value in json
+     * if json isnt valid, robn is left how it was
+     */
+    inline void transcodeFromJSON(std::string_view json, ROBN& robn) {
+        ROGUELIB_STACKTRACE
+        auto originalSize = robn.size();
+        try {
+            JSONDetail::JSONReader reader(json, robn);
+            reader.readAll();
+        } catch (...) {
+            robn.resize(originalSize);
+            throw;
+        }
+    }
+
+    inline ROBN fromJSON(std::string_view json) {
+        ROGUELIB_STACKTRACE
+        ROBN robn;
+        robn.reserve(json.size());
+        transcodeFromJSON(json, robn);
+        return robn;
+    }
+}
@@ -23,29 +23,127 @@
 #pragma  once
 
 #include "ROBNTranslation.hpp"
+#include "ROBNHash.hpp"
+#include "ROBNCanonical.hpp"
+
+#include <functional>
 
 namespace RogueLib::ROBN {
     class ROBNObject : public Serializable {
-        ROBN robn;
+        // anything this small is stored in the object itself, a bool or an int64 doesnt need a heap allocation
+        static constexpr std::size_t inlineCapacity = 32;
+
+        std::size_t length = 0;
+        union {
+            Byte inlineBytes[inlineCapacity];
+            Byte* heapBytes;
+        };
+
+        [[nodiscard]] bool isInline() const {
+            return length <= inlineCapacity;
+        }
+
+        void freeHeap() {
+            if (!isInline()) {
+                delete[] heapBytes;
+            }
+            length = 0;
+        }
+
+        void assign(const Byte* bytes, std::size_t size) {
+            if (size <= inlineCapacity) {
+                freeHeap();
+                std::memcpy(inlineBytes, bytes, size);
+            } else if (length != size) {
+                // allocate before freeing, so a throw leaves this as it was
+                auto* newBytes = new Byte[size];
+                std::memcpy(newBytes, bytes, size);
+                freeHeap();
+                heapBytes = newBytes;
+            } else {
+                // same size, the existing allocation is reused
+                std::memmove(heapBytes, bytes, size);
+            }
+            length = size;
+        }
+
+        // encoding goes here first, its capacity sticks around, so small values never touch the heap
+        static ROBN& scratchBuffer() {
+            thread_local ROBN scratch;
+            return scratch;
+        }
 
     public:
 
+        ROBNObject() = default;
+
+        ROBNObject(const ROBNObject& other) : Serializable(other) {
+            assign(other.data(), other.size());
+        }
+
+        ROBNObject(ROBNObject&& other) noexcept : Serializable(other) {
+            std::memcpy(inlineBytes, other.inlineBytes, inlineCapacity);
+            length = other.length;
+            // heap pointer was copied with the inline bytes, other just forgets it
+            other.length = 0;
+        }
+
+        ~ROBNObject() {
+            freeHeap();
+        }
+
         ROBNObject& operator=(const ROBNObject& other) {
             if (&other != this) {
-                robn = other.robn;
+                assign(other.data(), other.size());
             }
             return *this;
         }
 
-        template<typename T>
-        ROBNObject& operator=(T other) {
-            this->robn = RogueLib::ROBN::toROBN(other);
+        ROBNObject& operator=(ROBNObject&& other) noexcept {
+            if (&other != this) {
+                freeHeap();
+                std::memcpy(inlineBytes, other.inlineBytes, inlineCapacity);
+                length = other.length;
+                other.length = 0;
+            }
+            return *this;
+        }
+
+        /**
+         * stores the canonical form of other, so equal values are always equal objects
+         */
+        template<typename T, typename std::enable_if_t<!std::is_same<std::decay_t<T>, ROBNObject>::value, int> = 0>
+        ROBNObject& operator=(const T& other) {
+            ROGUELIB_STACKTRACE
+            auto& scratch = scratchBuffer();
+            scratch.clear();
+            ROBNWriter writer(scratch);
+            // single values and strings already come out canonical on little endian hosts
+            if constexpr ((std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+                           std::is_same<T, std::string>::value) && Endianness::NATIVE == Endianness::LITTLE) {
+                BinaryConversion<T>::writeROBN(writer, other);
+            } else {
+                CanonicalDetail::encodeCanonical(writer, other);
+            }
+            assign(scratch.data(), scratch.size());
             return *this;
         }
 
+        /**
+         * the encoded value this holds
+         */
+        [[nodiscard]] const Byte* data() const {
+            return isInline() ? inlineBytes : heapBytes;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return length;
+        }
+
         template<typename T>
         T as() const {
-            return RogueLib::ROBN::fromROBN<T>(robn);
+            auto* ptr = const_cast<Byte*>(data());
+            return BinaryConversion<T>::fromROBN(ptr, ptr + length);
         }
 
         template<typename T>
@@ -53,25 +151,23 @@ namespace RogueLib::ROBN {
             return as<T>();
         }
 
+        [[nodiscard]] std::uint64_t hash() const {
+            return hashROBN(data(), length);
+        }
+
         char threeWayComp(const ROBNObject& other) const {
             // smaller robn wins
-            if (this->robn.size() < other.robn.size()) {
+            if (this->length < other.length) {
                 return -1;
             }
-            if (this->robn.size() > other.robn.size()) {
+            if (this->length > other.length) {
                 return 1;
             }
 
             // didnt i say that smaller wins?
-            for (std::size_t i = 0; i < robn.size(); ++i) {
-                if (this->robn[i] < other.robn[i]) {
-                    return -1;
-                }
-                if (this->robn[i] > other.robn[i]) {
-                    return 1;
-                }
-            }
-            return 0;
+            // same size, so memcmp's ordering is the bytewise one, and its vectorized
+            auto result = std::memcmp(data(), other.data(), length);
+            return char((result > 0) - (result < 0));
         }
 
         bool operator<(const ROBNObject& other) const {
@@ -91,20 +187,54 @@ namespace RogueLib::ROBN {
         }
 
         bool operator==(const ROBNObject& other) const {
-            return threeWayComp(other) == 0;
+            return length == other.length && std::memcmp(data(), other.data(), length) == 0;
         }
 
-
         bool operator!=(const ROBNObject& other) const {
-            return threeWayComp(other) != 0;
+            return !(*this == other);
         }
 
+        // same wire format as a vector of uInt8, written directly
         ROBN toROBN() override {
-            return RogueLib::ROBN::toROBN(robn);
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            bytes.reserve(length + 11);
+            ROBNWriter writer(bytes);
+            Byte type{Type::Vector};
+            writer.write(&type, 1);
+            writeLengthROBN(writer, length);
+            type = Byte(length ? Type::uInt8 : Type::Undefined);
+            writer.write(&type, 1);
+            writer.write(data(), length);
+            return bytes;
         }
 
         void fromROBN(std::byte*& ptr, const std::byte* endPtr, Type type) override {
-            robn = RogueLib::ROBN::fromROBN<ROBN>(ptr, endPtr, type);
+            ROGUELIB_STACKTRACE
+            if (removeEndianness(type) != Type::Vector || ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type lengthType = static_cast<Type>(*ptr++);
+            auto byteCount = RogueLib::ROBN::fromROBN<std::uint64_t>(ptr, endPtr, lengthType);
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type valType = removeEndianness(static_cast<Type>(*ptr++));
+            if ((byteCount != 0 && valType != Type::uInt8 && valType != Type::Int8) ||
+                byteCount > std::uint64_t(endPtr - ptr)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            assign(ptr, byteCount);
+            ptr += byteCount;
+        }
+    };
+}
+
+namespace std {
+    template<>
+    struct hash<RogueLib::ROBN::ROBNObject> {
+        std::size_t operator()(const RogueLib::ROBN::ROBNObject& object) const noexcept {
+            return object.hash();
         }
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include "ROBNTranslation.hpp"
+
+#include <sys/uio.h>
+
+namespace RogueLib::ROBN {
+    /**
+     * scatter-gather ROBN output
+     *
+     * headers and small values are copied into an owned buffer, bulk payloads (primitive vectors, strings) at or
+     * over the reference threshold are pointed at where they already are
+     * Serializables that override writeROBN (AutoSerializable does) write straight into it, so their members are too
+     * the segments, in order, are the exact same bytes toROBN would give you, so iovecs() can go straight to writev
+     *
+     * WARNING: referenced segments point into the encoded value, it must outlive this and not be modified
+     */
+    class ROBNSegments {
+        struct Segment {
+            // nullptr if its in the owned buffer, the owned buffer can move while encoding, so offsets are used there
+            const Byte* reference;
+            std::size_t offset;
+            std::size_t size;
+        };
+
+        ROBN owned;
+        std::vector<Segment> segments;
+        std::size_t referenceThreshold;
+        std::size_t totalSize = 0;
+
+        [[nodiscard]] const Byte* segmentData(const Segment& segment) const {
+            return segment.reference ? segment.reference : owned.data() + segment.offset;
+        }
+
+    public:
+        explicit ROBNSegments(std::size_t referenceThreshold = 4096) : referenceThreshold(referenceThreshold) {
+        }
+
+        void write(const void* data, std::size_t size) {
+            if (size == 0) {
+                return;
+            }
+            auto* bytePtr = (const Byte*) data;
+            // back to back owned writes just grow the last segment
+            if (segments.empty() || segments.back().reference) {
+                segments.push_back({nullptr, owned.size(), 0});
+            }
+            owned.insert(owned.end(), bytePtr, bytePtr + size);
+            segments.back().size += size;
+            totalSize += size;
+        }
+
+        void writeReference(const void* data, std::size_t size) {
+            if (size < referenceThreshold) {
+                // an extra iovec costs more than copying something this small
+                write(data, size);
+                return;
+            }
+            segments.push_back({(const Byte*) data, 0, size});
+            totalSize += size;
+        }
+
+        /**
+         * total size of the encoded ROBN, across all segments
+         */
+        [[nodiscard]] std::size_t size() const {
+            return totalSize;
+        }
+
+        [[nodiscard]] std::size_t segmentCount() const {
+            return segments.size();
+        }
+
+        /**
+         * bytes copied into the owned buffer, everything else is referenced
+         */
+        [[nodiscard]] std::size_t ownedSize() const {
+            return owned.size();
+        }
+
+        /**
+         * calls function(const Byte* data, std::size_t size) for each segment, in order
+         */
+        template<typename Function>
+        void forEachSegment(Function&& function) const {
+            for (const auto& segment : segments) {
+                function(segmentData(segment), segment.size);
+            }
+        }
+
+        /**
+         * segment list for writev/sendmsg
+         * only valid until this is written to again
+         */
+        [[nodiscard]] std::vector<iovec> iovecs() const {
+            std::vector<iovec> vecs;
+            vecs.reserve(segments.size());
+            forEachSegment([&](const Byte* data, std::size_t size) {
+                vecs.push_back({const_cast<Byte*>(data), size});
+            });
+            return vecs;
+        }
+
+        /**
+         * copies everything into a single contiguous ROBN
+         */
+        [[nodiscard]] ROBN flatten() const {
+            ROBN bytes;
+            bytes.reserve(totalSize);
+            forEachSegment([&](const Byte* data, std::size_t size) {
+                bytes.insert(bytes.end(), data, data + size);
+            });
+            return bytes;
+        }
+
+        /**
+         * drops all segments, keeps the owned buffer's allocation
+         */
+        void clear() {
+            owned.clear();
+            segments.clear();
+            totalSize = 0;
+        }
+    };
+
+    template<typename T>
+    ROBNSegments toROBNSegments(const T& val, std::size_t referenceThreshold = 4096) {
+        ROGUELIB_STACKTRACE
+        ROBNSegments segments(referenceThreshold);
+        BinaryConversion<T>::writeROBN(segments, val);
+        return segments;
+    }
+}
@@ -28,11 +28,28 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <array>
+#include <tuple>
+#include <optional>
+#include <variant>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <byteswap.h>
 #include <cstring>
 #include <climits>
+#include <cfloat>
+#include <utility>
+#include <memory>
+#include <typeinfo>
 #include <RogueLib/Exceptions/Exceptions.hpp>
 
+#include "NDArray.hpp"
+#include "SparseVector.hpp"
+#include "SerializableRegistry.hpp"
+#include "BigInt.hpp"
+
 #if defined(__amd64__) || defined(__amd64) || defined(__x86_64__) || defined(__x86_64)
 #define X64
 #define SUPPORTED_ARCHITECTURE_FOUND
@@ -107,6 +124,14 @@ static_assert(sizeof(double) == 8);
  *          INTERNAL REPRESENTATION IS NOT CHANGED
  * Double, eight bytes copied to/from C++ representation, endianness may be flipped if required
  *          INTERNAL REPRESENTATION IS NOT CHANGED
+ * LongDouble, sixteen bytes, IEEE binary128, endianness may be flipped if required
+ *          copied when long double is binary128, converted from/to x87 extended, other formats arent supported
+ *
+ * BigInt, arbitrary size integer, a length element, the number of limbs, usually uInt64, type header required
+ *          a sign byte, 0 or 1 (negative), then the magnitude as 64 bit limbs, least significant limb first
+ *          each limb's endianness is the BigInt type header's, zero is no limbs and not negative
+ * BigFloat, mantissa * 2^exponent, an Int64 element (with type header) for the exponent
+ *          then the mantissa, exactly the same as a BigInt's data, limb endianness is the BigFloat type header's
  *
  * Vector, a length element, usually uInt64, but the decoder can handle any type here, type header required
  *          internal element type header, one byte, may be any ROBN type, vector included
@@ -119,14 +144,62 @@ static_assert(sizeof(double) == 8);
  * Map, a length element, usually uInt64, byt the decoder can handle any type here, type header required
  *      a list of pair elements with key/value data elements, full pair element including pair type header
  *
+ * NDArray, a shape element, a Vector of uInt64 (type header required), one extent per dimension, outermost first
+ *          element type header, one byte, must be a primitive type
+ *          every element, row major, densely packed, same as a vector of primitives, only one block for all of it
+ *
+ * SparseVector, a vector of primitives where most elements are zero (all bits zero), only the others are stored
+ *          a length element, the dense length, usually uInt64, type header required
+ *          a count element, how many elements are stored, usually uInt64, type header required
+ *          index type header, one byte, an unsigned integer type, then count indices densely packed, increasing
+ *          value type header, one byte, a primitive type, then count values densely packed
+ *          the encoder writes vectors of primitives like this when they are long and sparse enough, and decoders
+ *          for vectors of primitives accept it in place of a Vector
+ *
+ * Checksummed, the payload element (with type header), then a uInt32 element (with type header) holding the
+ *          CRC32C (Castagnoli) of the payload element's bytes, see ROBNChecksum.hpp
+ *
+ * Polymorphic, a Serializable that could be any registered subclass, see SerializableRegistry.hpp
+ *          a tag element, an unsigned integer, the smallest one that fits, type header required
+ *          then the object's own element (with type header), unless the tag is 0, which is a null pointer
+ *
+ * Tuple, a fixed number of elements of any types, a count element, usually uInt64, type header required
+ *          then each element (with type header), in order, a two element Tuple and a Pair decode as each other
+ *
+ * Optional, a byte, 0 if there is no value, or 1 and then the value's element (with type header)
+ *          a decoder expecting an Optional accepts the value's element on its own too
+ *
+ * Variant, one of a fixed list of types, an index element, an unsigned integer, the smallest one that fits,
+ *          type header required, then the value's element (with type header)
+ *
+ * Compressed, one element split into blocks that are compressed on their own, see ROBNCompression.hpp
+ *          a codec byte, 0 for none, 1 for LZ (the LZ4 block format)
+ *          then each block, a uInt32 element (with type header) with its size once decompressed, 0 ends the list,
+ *          a uInt32 element (with type header) with its size as stored, then the stored bytes
+ *          a block stored at its decompressed size wasnt compressed, its bytes are as is
+ *          every block's decompressed bytes, back to back, are the payload element (with type header)
+ *
+ * std::array, std::deque, std::set and std::unordered_set are Vectors, std::unordered_map is a Map
+ *
  */
 
-//todo long double?
 //todo update this with C++23, so there isn't any more undefined/implementation defined behavior
 namespace RogueLib::ROBN {
 
 #define ROGUELIB_UNUSED(x) (void)(x)
 
+// vectors of primitives at least this long are checked for being sparse when encoded, 0 turns that off
+#ifndef ROGUELIB_ROBN_SPARSE_MINIMUM_SIZE
+#define ROGUELIB_ROBN_SPARSE_MINIMUM_SIZE 256
+#endif
+
+// consteval when built as C++20, constexpr is as close as C++17 gets
+#ifdef __cpp_consteval
+#define ROGUELIB_ROBN_CONSTEVAL consteval
+#else
+#define ROGUELIB_ROBN_CONSTEVAL constexpr
+#endif
+
     typedef std::byte Byte;
 
     typedef std::vector<Byte> ROBN;
@@ -164,62 +237,57 @@ namespace RogueLib::ROBN {
             Vector = 15,
             Pair = 16,
             Map = 17,
+
+            Checksummed = 23,
+            NDArray = 24,
+            SparseVector = 25,
+            Polymorphic = 26,
+            Tuple = 27,
+            Optional = 28,
+            Variant = 29,
+            Compressed = 30,
         };
     }
     typedef NS_ENUM_TYPE::Type Type;
 
-    // consteval
     template<typename T>
-    constexpr Type primitiveTypeID() {
-        // should be optimized out by compiler
-
-        if (std::is_same<T, std::string>::value) {
+    ROGUELIB_ROBN_CONSTEVAL Type primitiveTypeID() {
+        if constexpr (std::is_same<T, std::string>::value) {
             return Type::String;
-        }
-        if (std::is_same<T, bool>::value) {
+        } else if constexpr (std::is_same<T, bool>::value) {
             return Type::Bool;
-        }
 
-        if (std::is_same<T, std::int8_t>::value) {
+        } else if constexpr (std::is_same<T, std::int8_t>::value) {
             return Type::Int8;
-        }
-        if (std::is_same<T, std::int16_t>::value) {
+        } else if constexpr (std::is_same<T, std::int16_t>::value) {
             return Type::Int16;
-        }
-        if (std::is_same<T, std::int32_t>::value) {
+        } else if constexpr (std::is_same<T, std::int32_t>::value) {
             return Type::Int32;
-        }
-        if (std::is_same<T, std::int64_t>::value) {
+        } else if constexpr (std::is_same<T, std::int64_t>::value) {
             return Type::Int64;
-        }
-        if (std::is_same<T, __int128>::value) {
+        } else if constexpr (std::is_same<T, __int128>::value) {
             return Type::Int128;
-        }
 
-        if (std::is_same<T, std::uint8_t>::value) {
+        } else if constexpr (std::is_same<T, std::uint8_t>::value) {
             return Type::uInt8;
-        }
-        if (std::is_same<T, std::uint16_t>::value) {
+        } else if constexpr (std::is_same<T, std::uint16_t>::value) {
             return Type::uInt16;
-        }
-        if (std::is_same<T, std::uint32_t>::value) {
+        } else if constexpr (std::is_same<T, std::uint32_t>::value) {
             return Type::uInt32;
-        }
-        if (std::is_same<T, std::uint64_t>::value) {
+        } else if constexpr (std::is_same<T, std::uint64_t>::value) {
             return Type::uInt64;
-        }
-        if (std::is_same<T, unsigned __int128>::value) {
+        } else if constexpr (std::is_same<T, unsigned __int128>::value) {
             return Type::uInt128;
-        }
 
-        if (std::is_same<T, float>::value) {
+        } else if constexpr (std::is_same<T, float>::value) {
             return Type::Float;
-        }
-        if (std::is_same<T, double>::value) {
+        } else if constexpr (std::is_same<T, double>::value) {
             return Type::Double;
+        } else if constexpr (std::is_same<T, long double>::value) {
+            return Type::LongDouble;
+        } else {
+            return Type::Undefined;
         }
-
-        return Type::Undefined;
     }
 
     constexpr size_t primitiveTypeSize(Type type) {
@@ -244,6 +312,7 @@ namespace RogueLib::ROBN {
                 return 8;
             case Type::Int128:
             case Type::uInt128:
+            case Type::LongDouble:
                 return 16;
         }
     }
@@ -305,33 +374,56 @@ namespace RogueLib::ROBN {
     }
 
     template<typename T, typename std::enable_if<
-            (sizeof(T) == 4) && (std::is_integral<T>::value || std::is_floating_point<T>::value), int>::type = 0>
+            (sizeof(T) == 4) && std::is_integral<T>::value, int>::type = 0>
     constexpr T swapEndianness(T val) {
         return bswap_32(val);
     }
 
     template<typename T, typename std::enable_if<
-            (sizeof(T) == 8) && (std::is_integral<T>::value || std::is_floating_point<T>::value), int>::type = 0>
+            (sizeof(T) == 8) && std::is_integral<T>::value, int>::type = 0>
     constexpr T swapEndianness(T val) {
         return bswap_64(val);
     }
 
+    // the bits get swapped, not the value, passing a float to bswap would convert it to an integer first
     template<typename T, typename std::enable_if<
-            std::is_same<T, __int128>::value || std::is_same<T, unsigned __int128>::value, int>::type = 0>
-    constexpr T swapEndianness(T val) {
-        // 128 bit endianness swap without a native way do to this
-        std::uint64_t sections[2] = {0};
-
-        std::memcpy(sections, &val, 16);
+            std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8), int>::type = 0>
+    inline T swapEndianness(T val) {
+        std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t> bits;
+        std::memcpy(&bits, &val, sizeof(T));
+        bits = swapEndianness(bits);
+        std::memcpy(&val, &bits, sizeof(T));
+        return val;
+    }
 
-        sections[0] = bswap_64(sections[0]);
-        sections[1] = bswap_64(sections[1]);
-        sections[0] ^= sections[1];
-        sections[1] ^= sections[0];
-        sections[0] ^= sections[1];
+// gcc 11+ and clang have a single instruction-ish 128 bit swap
+#ifdef __has_builtin
+#if __has_builtin(__builtin_bswap128)
+#define ROGUELIB_ROBN_HAS_BSWAP128
+#endif
+#endif
 
-        std::memcpy(&val, sections, 16);
+    template<typename T, typename std::enable_if<
+            std::is_same<T, __int128>::value || std::is_same<T, unsigned __int128>::value, int>::type = 0>
+    constexpr T swapEndianness(T val) {
+        auto bits = (unsigned __int128) val;
+#ifdef ROGUELIB_ROBN_HAS_BSWAP128
+        return T(__builtin_bswap128(bits));
+#else
+        // swap each half, and swap the halves, the compiler vectorizes this fine in loops
+        return T(((unsigned __int128) bswap_64(std::uint64_t(bits)) << 64u) | bswap_64(std::uint64_t(bits >> 64u)));
+#endif
+    }
 
+    // byte for byte, only reached when long double is binary128, other formats are converted instead
+    template<typename T, typename std::enable_if<std::is_same<T, long double>::value && (sizeof(T) > 8), int>::type = 0>
+    inline T swapEndianness(T val) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &val, sizeof(T));
+        for (std::size_t i = 0; i < sizeof(T) / 2; ++i) {
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+        std::memcpy(&val, bytes, sizeof(T));
         return val;
     }
 
@@ -343,10 +435,158 @@ namespace RogueLib::ROBN {
         return val;
     }
 
+    /**
+     * LongDouble is IEEE binary128 on the wire, whatever long double is on the host
+     * where long double is binary128 already its a copy, x87 80 bit extended is converted, exactly in that
+     * direction, and rounded to nearest even coming back, anything else isnt supported
+     */
+    namespace LongDoubleDetail {
+        constexpr unsigned __int128 one = 1;
+        constexpr unsigned __int128 fractionMask = (one << 112u) - 1;
+
+        inline unsigned __int128 toBinary128(long double val) {
+            ROGUELIB_STACKTRACE
+#if LDBL_MANT_DIG == 113
+            unsigned __int128 bits;
+            std::memcpy(&bits, &val, 16);
+            return bits;
+#elif LDBL_MANT_DIG == 64 && defined(ROBN_LITTLE_ENDIAN)
+            // x87, 64 bit mantissa with an explicit integer bit, then the sign and the same 15 bit exponent
+            std::uint64_t mantissa;
+            std::uint16_t signExponent;
+            std::memcpy(&mantissa, &val, 8);
+            std::memcpy(&signExponent, (const char*) &val + 8, 2);
+            unsigned __int128 exponent = signExponent & 0x7FFFu;
+            if (exponent == 0 && (mantissa >> 63u) != 0) {
+                // pseudo denormal, its the smallest normal exponent really
+                exponent = 1;
+            }
+            auto fraction = (unsigned __int128) (mantissa & ~(std::uint64_t(1) << 63u)) << 49u;
+            return (unsigned __int128) (signExponent >> 15u) << 127u | exponent << 112u | fraction;
+#else
+            ROGUELIB_UNUSED(val);
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "long double format not supported");
+#endif
+        }
+
+        inline long double fromBinary128(unsigned __int128 bits) {
+            ROGUELIB_STACKTRACE
+#if LDBL_MANT_DIG == 113
+            long double val;
+            std::memcpy(&val, &bits, 16);
+            return val;
+#elif LDBL_MANT_DIG == 64 && defined(ROBN_LITTLE_ENDIAN)
+            auto sign = std::uint16_t(bits >> 127u);
+            auto exponent = std::uint16_t(bits >> 112u) & 0x7FFFu;
+            auto fraction = bits & fractionMask;
+            std::uint64_t mantissa;
+            if (exponent == 0x7FFF) {
+                mantissa = std::uint64_t(fraction >> 49u);
+                if (fraction != 0 && mantissa == 0) {
+                    // NaN payload only in the bits that dont fit, keep it a NaN
+                    mantissa = std::uint64_t(1) << 62u;
+                }
+                mantissa |= std::uint64_t(1) << 63u;
+            } else {
+                // the integer bit is implicit in binary128, except for denormals
+                auto significand = exponent == 0 ? fraction : fraction | (one << 112u);
+                auto rounded = significand >> 49u;
+                auto remainder = significand & ((one << 49u) - 1);
+                auto half = one << 48u;
+                if (remainder > half || (remainder == half && (rounded & 1u) != 0)) {
+                    rounded++;
+                }
+                if (rounded >> 64u) {
+                    // rounded up past the top, the exponent goes up one, maybe to infinity
+                    rounded >>= 1u;
+                    exponent++;
+                } else if (exponent == 0 && (rounded >> 63u) != 0) {
+                    // denormal rounded up to the smallest normal
+                    exponent = 1;
+                }
+                mantissa = exponent == 0x7FFF ? std::uint64_t(1) << 63u : std::uint64_t(rounded);
+            }
+            std::uint16_t signExponent = std::uint16_t(sign << 15u | exponent);
+            long double val = 0;
+            std::memcpy(&val, &mantissa, 8);
+            std::memcpy((char*) &val + 8, &signExponent, 2);
+            return val;
+#else
+            ROGUELIB_UNUSED(bits);
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "long double format not supported");
+#endif
+        }
+    }
+
+    /**
+     * if T in memory is exactly T on the wire, which is what lets whole blocks of them be copied
+     * its every number type, except long double when that isnt binary128
+     */
+    template<typename T>
+    constexpr bool isWireIdentical() {
+        if constexpr (std::is_same<T, long double>::value) {
+            return LDBL_MANT_DIG == 113;
+        } else {
+            return (std::is_integral<T>::value || std::is_floating_point<T>::value) &&
+                   primitiveTypeID<T>() != Type::Undefined;
+        }
+    }
+
+    template<typename Writer, typename = void>
+    struct has_write_reference : std::false_type {
+    };
+
+    template<typename Writer>
+    struct has_write_reference<Writer, std::void_t<decltype(std::declval<Writer&>().writeReference(
+            std::declval<const void*>(), std::size_t()))>> : std::true_type {
+    };
+
+    /**
+     * any writer, behind two function pointers, for encoders that cant be templates, like Serializable's
+     * writeReference is passed through if the writer has one, otherwise its a copy like any other write
+     */
+    class ROBNAnyWriter {
+        void* writer;
+        void (* writeFunction)(void* writer, const void* data, std::size_t size);
+        void (* writeReferenceFunction)(void* writer, const void* data, std::size_t size);
+
+    public:
+        template<typename Writer>
+        explicit ROBNAnyWriter(Writer& writer) : writer(&writer) {
+            writeFunction = [](void* writer, const void* data, std::size_t size) {
+                static_cast<Writer*>(writer)->write(data, size);
+            };
+            writeReferenceFunction = [](void* writer, const void* data, std::size_t size) {
+                if constexpr (has_write_reference<Writer>::value) {
+                    static_cast<Writer*>(writer)->writeReference(data, size);
+                } else {
+                    static_cast<Writer*>(writer)->write(data, size);
+                }
+            };
+        }
+
+        void write(const void* data, std::size_t size) {
+            writeFunction(writer, data, size);
+        }
+
+        void writeReference(const void* data, std::size_t size) {
+            writeReferenceFunction(writer, data, size);
+        }
+    };
+
     class Serializable {
     public:
         virtual ROBN toROBN() = 0;
 
+        /**
+         * the same bytes as toROBN, into whatever writer is encoding it
+         * the default goes through toROBN, override it to write straight through, so payloads can be referenced
+         */
+        virtual void writeROBN(ROBNAnyWriter& writer) {
+            auto bytes = toROBN();
+            writer.write(bytes.data(), bytes.size());
+        }
+
         virtual void fromROBN(Byte*& ptr, const Byte* endPtr, Type type) = 0;
 
         [[nodiscard]] virtual bool isFixedBinarySize() const {
@@ -358,14 +598,130 @@ namespace RogueLib::ROBN {
         }
     };
 
+    /**
+     * limits on what decoding can do, for blobs that come from somewhere you dont trust
+     *
+     * lengths are always checked against whats left in the blob before anything is allocated, these go on top of that
+     * sparse vectors are the one thing that can legitimately decode to far more than their size, so without
+     * maxTotalBytes or maxElements a small blob can still ask for a large vector through one
+     */
+    struct DecodeLimits {
+        // bytes allocated for vectors, strings, arrays, and map entries, over everything decoded in the scope
+        std::uint64_t maxTotalBytes = UINT64_MAX;
+        // elements in any one vector, map, or array
+        std::uint64_t maxElements = UINT64_MAX;
+        // containers and Serializables inside each other, limited by default so a blob cant overflow the stack
+        std::uint32_t maxDepth = 512;
+        std::uint64_t maxStringLength = UINT64_MAX;
+    };
+
+    namespace DecodeBudgetDetail {
+        struct State {
+            DecodeLimits limits;
+            std::uint64_t bytesUsed = 0;
+            std::uint32_t depth = 0;
+        };
+
+        inline State& state() {
+            thread_local State state;
+            return state;
+        }
+    }
+
+    /**
+     * applies limits to every decode on this thread until its destroyed, the previous limits come back after
+     * scopes nest, the inner one doesnt see what the outer one used
+     */
+    class DecodeLimitScope {
+        DecodeBudgetDetail::State previous;
+    public:
+        explicit DecodeLimitScope(const DecodeLimits& limits) : previous(DecodeBudgetDetail::state()) {
+            DecodeBudgetDetail::state() = {limits, 0, 0};
+        }
+
+        DecodeLimitScope(const DecodeLimitScope&) = delete;
+
+        DecodeLimitScope& operator=(const DecodeLimitScope&) = delete;
+
+        ~DecodeLimitScope() {
+            DecodeBudgetDetail::state() = previous;
+        }
+
+        /**
+         * bytes charged against maxTotalBytes so far
+         */
+        [[nodiscard]] std::uint64_t bytesUsed() const {
+            return DecodeBudgetDetail::state().bytesUsed;
+        }
+    };
+
+    /**
+     * called by decoders before allocating length elements of elementSize bytes
+     * each element takes at least minEncodedSize bytes in the blob, so a length that couldnt fit in whats left is
+     * rejected here, a 0 minEncodedSize skips that (sparse vectors)
+     */
+    inline void checkDecodeAllocation(std::uint64_t length, std::uint64_t elementSize, std::uint64_t minEncodedSize,
+                                      const Byte* ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        if (minEncodedSize != 0 && length > std::uint64_t(endPtr - ptr) / minEncodedSize) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        auto& state = DecodeBudgetDetail::state();
+        std::uint64_t bytes;
+        if (length > state.limits.maxElements || __builtin_mul_overflow(length, elementSize, &bytes) ||
+            bytes > state.limits.maxTotalBytes - state.bytesUsed) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Decode limit exceeded");
+        }
+        state.bytesUsed += bytes;
+    }
+
+    inline void checkDecodeString(std::uint64_t length) {
+        ROGUELIB_STACKTRACE
+        auto& state = DecodeBudgetDetail::state();
+        if (length > state.limits.maxStringLength || length > state.limits.maxTotalBytes - state.bytesUsed) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Decode limit exceeded");
+        }
+        state.bytesUsed += length;
+    }
+
+    /**
+     * one per level of nesting, for as long as that level is being decoded
+     */
+    class DecodeDepthGuard {
+    public:
+        DecodeDepthGuard() {
+            ROGUELIB_STACKTRACE
+            auto& state = DecodeBudgetDetail::state();
+            if (state.depth >= state.limits.maxDepth) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Decode limit exceeded");
+            }
+            state.depth++;
+        }
+
+        DecodeDepthGuard(const DecodeDepthGuard&) = delete;
+
+        DecodeDepthGuard& operator=(const DecodeDepthGuard&) = delete;
+
+        ~DecodeDepthGuard() {
+            DecodeBudgetDetail::state().depth--;
+        }
+    };
+
     // as fast as it gets for a single value
     template<typename T>
     inline ROBN primitiveToROBN(T val) {
         ROGUELIB_STACKTRACE
         ROBN bytes;
-        bytes.resize(sizeof(val) + 1);
-        bytes[0] = Byte{primitiveTypeID<T>()};
-        std::memcpy(bytes.data() + 1, &val, sizeof(val));
+        if constexpr (isWireIdentical<T>()) {
+            bytes.resize(sizeof(val) + 1);
+            bytes[0] = Byte{primitiveTypeID<T>()};
+            std::memcpy(bytes.data() + 1, &val, sizeof(val));
+        } else {
+            auto bits = LongDoubleDetail::toBinary128(val);
+            bytes.resize(sizeof(bits) + 1);
+            bytes[0] = Byte(primitiveTypeID<T>()) | Byte(Endianness::NATIVE);
+            std::memcpy(bytes.data() + 1, &bits, sizeof(bits));
+        }
         return bytes;
     }
 
@@ -392,11 +748,15 @@ namespace RogueLib::ROBN {
     }
 
 
-    // i support casting here, i cant really make it much better
-    // TODO: string interpretation?
     template<typename T, typename std::enable_if<
             std::is_integral<T>::value || std::is_floating_point<T>::value, int>::type = 0>
-    inline T fromROBN(Byte*& ptr, const Byte* endPtr, Type type) {
+    inline T fromROBN(Byte*& ptr, const Byte* endPtr, Type type);
+
+    // i support casting here, i cant really make it much better
+    // its out of line and cold, the wire type almost always is the requested type, so fromROBN rarely ends up here
+    // TODO: string interpretation?
+    template<typename T>
+    [[gnu::cold, gnu::noinline]] T convertPrimitiveROBN(Byte*& ptr, const Byte* endPtr, Type type) {
         ROGUELIB_STACKTRACE
         switch (removeEndianness(type)) {
             default:
@@ -517,7 +877,36 @@ namespace RogueLib::ROBN {
                 ptr += sizeof(tempval);
                 return correctEndianness(tempval, typeEndianness(type));
             }
+            case Type::LongDouble: {
+                unsigned __int128 bits;
+                if ((ptr + sizeof(bits)) > endPtr) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                std::memcpy(&bits, ptr, sizeof(bits));
+                ptr += sizeof(bits);
+                return T(LongDoubleDetail::fromBinary128(correctEndianness(bits, typeEndianness(type))));
+            }
+        }
+    }
+
+    template<typename T, typename std::enable_if<
+            std::is_integral<T>::value || std::is_floating_point<T>::value, int>::type>
+    inline T fromROBN(Byte*& ptr, const Byte* endPtr, Type type) {
+        if constexpr (isWireIdentical<T>()) {
+            // exactly what was asked for, native endianness, and enough bytes left, so its just a copy
+            constexpr auto nativeType = static_cast<Type>(primitiveTypeID<T>() | Endianness::NATIVE);
+            if (__builtin_expect(type == nativeType && std::size_t(endPtr - ptr) >= sizeof(T), 1)) {
+                T val;
+                if constexpr (std::is_same<T, bool>::value) {
+                    val = *ptr != Byte{0};
+                } else {
+                    std::memcpy(&val, ptr, sizeof(T));
+                }
+                ptr += sizeof(T);
+                return val;
+            }
         }
+        return convertPrimitiveROBN<T>(ptr, endPtr, type);
     }
 
     template<typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
@@ -526,36 +915,94 @@ namespace RogueLib::ROBN {
                               (ptr, endPtr, type));
     }
 
-    // consteval
+    template<typename>
+    struct is_std_array : std::false_type {
+    };
+
+    template<typename T, std::size_t N>
+    struct is_std_array<std::array<T, N>> : std::true_type {
+    };
+
+    template<typename>
+    struct is_std_tuple : std::false_type {
+    };
+
+    template<typename... Ts>
+    struct is_std_tuple<std::tuple<Ts...>> : std::true_type {
+    };
+
+    // a std::array of numbers this long could be written as a SparseVector, so its size isnt known ahead of time
+    template<typename T, std::size_t N>
+    constexpr bool canBeSparse() {
+        return isWireIdentical<T>() && !std::is_same<T, bool>::value &&
+               ROGUELIB_ROBN_SPARSE_MINIMUM_SIZE != 0 && N >= ROGUELIB_ROBN_SPARSE_MINIMUM_SIZE;
+    }
+
+    template<typename T>
+    constexpr bool isFixedBinarySize();
+
+    template<typename T>
+    constexpr std::uint64_t typeBinarySize();
+
+    template<typename>
+    struct TupleBinarySize;
+
+    template<typename... Ts>
+    struct TupleBinarySize<std::tuple<Ts...>> {
+        static constexpr bool isFixed() {
+            return (isFixedBinarySize<Ts>() && ...);
+        }
+
+        // count element, then every element with its type header
+        static constexpr std::uint64_t size() {
+            return 9 + (std::uint64_t(0) + ... + (1 + typeBinarySize<Ts>()));
+        }
+    };
+
+    // cant be consteval, Serializables have to be asked at runtime
     template<typename T>
     constexpr bool isFixedBinarySize() {
-        if (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
             return true;
-        }
-        if (std::is_base_of<Serializable, T>::value) {
+        } else if constexpr (std::is_base_of<Serializable, T>::value) {
             T t;
             auto* serializable = (Serializable*) (&t);
             return serializable->isFixedBinarySize();
+        } else if constexpr (is_std_array<T>::value) {
+            typedef typename T::value_type V;
+            return isFixedBinarySize<V>() && !canBeSparse<V, std::tuple_size<T>::value>();
+        } else if constexpr (is_std_tuple<T>::value) {
+            return TupleBinarySize<T>::isFixed();
+        } else {
+            return false;
         }
-        return false;
     }
 
-    // consteval
+    /**
+     * the size of the data, not including the type header
+     */
     template<typename T>
     constexpr std::uint64_t typeBinarySize() {
-        if (!isFixedBinarySize<T>()) {
-            return 0;
-        }
-        std::uint64_t size = primitiveTypeSize(primitiveTypeID<T>());
-        if (size) {
-            return size;
-        }
-        if (std::is_base_of<Serializable, T>::value) {
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            return primitiveTypeSize(primitiveTypeID<T>());
+        } else if constexpr (std::is_base_of<Serializable, T>::value) {
+            if (!isFixedBinarySize<T>()) {
+                return 0;
+            }
             T t;
             auto* serializable = (Serializable*) (&t);
             return serializable->binarySize();
+        } else if constexpr (is_std_array<T>::value) {
+            if (!isFixedBinarySize<T>()) {
+                return 0;
+            }
+            // length element and element type, the first element's type header is the element type
+            return 10 + std::tuple_size<T>::value * typeBinarySize<typename T::value_type>();
+        } else if constexpr (is_std_tuple<T>::value) {
+            return isFixedBinarySize<T>() ? TupleBinarySize<T>::size() : 0;
+        } else {
+            return 0;
         }
-        return 0;
     }
 
     template<typename T>
@@ -575,6 +1022,11 @@ namespace RogueLib::ROBN {
         ROGUELIB_STACKTRACE
         if (type == Type::String) {
             auto length = strnlen((const char*) (ptr), std::size_t(endPtr - ptr));
+            // no null terminator before the end
+            if (length == std::size_t(endPtr - ptr)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            checkDecodeString(length);
             std::string str{(const char*) (ptr), length};
             ptr += length;
             ptr++;
@@ -586,6 +1038,7 @@ namespace RogueLib::ROBN {
     template<typename T, typename std::enable_if_t<std::is_base_of<Serializable, T>::value, int> = 0>
     inline T fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
         ROGUELIB_STACKTRACE
+        DecodeDepthGuard depthGuard;
         T t{};
         auto* tPtr = (Serializable*) &t;
         tPtr->fromROBN(ptr, endPtr, type);
@@ -605,73 +1058,293 @@ namespace RogueLib::ROBN {
     };
 
 
-    template<typename V, typename std::enable_if_t<std::is_same<V, std::vector<bool>>::value, int> = 0>
-    V fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+    struct SparseHeader {
+        std::uint64_t length;
+        std::uint64_t count;
+        Type indexType;
+        const Byte* indices;
+        Type valType;
+        const Byte* values;
+    };
+
+    /**
+     * reads a SparseVector element, whose type header has already been read
+     * ptr is left after the whole element, the indices and values are checked to be there, not what they are
+     */
+    inline SparseHeader readSparseHeader(Byte*& ptr, const Byte* const endPtr) {
         ROGUELIB_STACKTRACE
-        std::vector<bool> vector;
-        auto checkPtr = [&](std::uint64_t neededBytes) {
-            if ((ptr + neededBytes) > endPtr) {
+        auto readType = [&]() {
+            if (ptr >= endPtr) {
                 throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
             }
+            return static_cast<Type>(*ptr++);
         };
-
-        if (type != Type::Vector) {
+        SparseHeader header{};
+        header.length = fromROBN<std::uint64_t>(ptr, endPtr, readType());
+        header.count = fromROBN<std::uint64_t>(ptr, endPtr, readType());
+        if (header.count > header.length) {
             throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
         }
-        checkPtr(1);
-        Type lengthType = static_cast<Type>(*ptr++);
-        auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
-        checkPtr(1);
-        Type valType = static_cast<Type>(*ptr++);
-        vector.resize(length);
+        auto readBlock = [&](Type& type, const Byte*& block) {
+            type = readType();
+            auto size = primitiveTypeSize(removeEndianness(type));
+            if (header.count != 0 && (size == 0 || header.count > std::uint64_t(endPtr - ptr) / size)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            block = ptr;
+            ptr += header.count * size;
+        };
+        readBlock(header.indexType, header.indices);
+        readBlock(header.valType, header.values);
+        return header;
+    }
 
-        if (primitiveTypeSize(valType) == 0) {
-            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+    /**
+     * calls function(std::uint64_t i, std::uint64_t index) for each stored element
+     * indices are checked against the length, so they can be used to write into a dense vector directly
+     */
+    template<typename Function>
+    inline void forEachSparseIndex(const SparseHeader& header, Function&& function) {
+        ROGUELIB_STACKTRACE
+        auto each = [&](auto typeTag) {
+            typedef decltype(typeTag) I;
+            for (std::uint64_t i = 0; i < header.count; ++i) {
+                I index;
+                std::memcpy(&index, header.indices + i * sizeof(I), sizeof(I));
+                index = correctEndianness(index, typeEndianness(header.indexType));
+                if (index >= header.length) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                function(i, std::uint64_t(index));
+            }
+        };
+        if (header.count == 0) {
+            return;
+        }
+        switch (removeEndianness(header.indexType)) {
+            default:
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            case Type::uInt8:
+                each(std::uint8_t{});
+                return;
+            case Type::uInt16:
+                each(std::uint16_t{});
+                return;
+            case Type::uInt32:
+                each(std::uint32_t{});
+                return;
+            case Type::uInt64:
+                each(std::uint64_t{});
+                return;
         }
+    }
 
-        for (std::uint64_t i = 0; i < length; ++i) {
-            vector[i] = RogueLib::ROBN::fromROBN<bool>(ptr, endPtr, type);
+    // stored value i, cast to T if its a different type
+    template<typename T>
+    inline T readSparseValue(const SparseHeader& header, std::uint64_t i) {
+        if (isWireIdentical<T>() && removeEndianness(header.valType) == primitiveTypeID<T>()) {
+            T val;
+            std::memcpy(&val, header.values + i * sizeof(T), sizeof(T));
+            return correctEndianness(val, typeEndianness(header.valType));
         }
+        auto valSize = primitiveTypeSize(removeEndianness(header.valType));
+        auto* ptr = const_cast<Byte*>(header.values + i * valSize);
+        return convertPrimitiveROBN<T>(ptr, ptr + valSize, header.valType);
+    }
 
-        return vector;
+    /**
+     * writes the stored values into dense, which has to be zeroed and header.length long already
+     */
+    template<typename T>
+    inline void scatterSparseROBN(const SparseHeader& header, T* dense) {
+        forEachSparseIndex(header, [&](std::uint64_t i, std::uint64_t index) {
+            dense[index] = readSparseValue<T>(header, i);
+        });
     }
 
-    template<typename V, typename std::enable_if_t<
-            is_std_vector<V>::value && !std::is_same<V, std::vector<bool>>::value, int> = 0>
-    V fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
-        ROGUELIB_STACKTRACE
+    template<typename>
+    struct is_sparse_vector : std::false_type {
+    };
 
-        typedef typename V::value_type T;
+    template<typename T>
+    struct is_sparse_vector<SparseVector<T>> : std::true_type {
+    };
 
-        auto checkPtr = [&](std::uint64_t neededBytes) {
-            if ((ptr + neededBytes) > endPtr) {
-                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
-            }
-        };
+    template<typename S, typename std::enable_if_t<is_sparse_vector<S>::value, int> = 0>
+    inline S fromROBN(Byte*& ptr, const Byte* const endPtr, Type type);
 
+    template<typename>
+    struct is_nd_array : std::false_type {
+    };
 
-        auto* startPtr = ptr;
+    template<typename T>
+    struct is_nd_array<NDArray<T>> : std::true_type {
+    };
 
+    template<typename A, typename std::enable_if_t<is_nd_array<A>::value, int> = 0>
+    inline A fromROBN(Byte*& ptr, const Byte* const endPtr, Type type);
 
-        if (type != Type::Vector) {
-            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
-        }
-//            auto length = BinaryConversion<std::uint64_t>::fromROBN(ptr, endPtr);
+    template<typename>
+    struct is_serializable_pointer : std::false_type {
+    };
 
-        if (std::is_integral<T>::value || std::is_floating_point<T>::value) {
-            checkPtr(1);
-            Type lengthType = static_cast<Type>(*ptr++);
-            auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
-            checkPtr(1);
-            Type valType = static_cast<Type>(*ptr++);
-            std::vector<T> vector;
-            vector.resize(length);
-            // if its the same size, then i can do a memory copy
-            if (removeEndianness(valType) == primitiveTypeID<T>()) {
-                checkPtr(length * sizeof(T));
-                // if its identical to the host representation then its only a memory copy
+    template<typename T>
+    struct is_serializable_pointer<std::shared_ptr<T>> : std::is_base_of<Serializable, T> {
+    };
+
+    template<typename P, typename std::enable_if_t<is_serializable_pointer<P>::value, int> = 0>
+    inline P fromROBN(Byte*& ptr, const Byte* const endPtr, Type type);
+
+    template<typename B, typename std::enable_if_t<std::is_same<B, BigInt>::value, int> = 0>
+    inline B fromROBN(Byte*& ptr, const Byte* const endPtr, Type type);
+
+    template<typename B, typename std::enable_if_t<std::is_same<B, BigFloat>::value, int> = 0>
+    inline B fromROBN(Byte*& ptr, const Byte* const endPtr, Type type);
+
+    template<typename>
+    struct is_std_optional : std::false_type {
+    };
+
+    template<typename T>
+    struct is_std_optional<std::optional<T>> : std::true_type {
+    };
+
+    template<typename>
+    struct is_std_variant : std::false_type {
+    };
+
+    template<typename... Ts>
+    struct is_std_variant<std::variant<Ts...>> : std::true_type {
+    };
+
+    template<typename>
+    struct is_std_unordered_map : std::false_type {
+    };
+
+    template<typename K, typename V, typename H, typename E, typename A>
+    struct is_std_unordered_map<std::unordered_map<K, V, H, E, A>> : std::true_type {
+    };
+
+    // containers that are Vectors on the wire, but get filled one element at a time
+    template<typename>
+    struct is_std_collection : std::false_type {
+    };
+
+    template<typename T, typename A>
+    struct is_std_collection<std::deque<T, A>> : std::true_type {
+    };
+
+    template<typename T, typename C, typename A>
+    struct is_std_collection<std::set<T, C, A>> : std::true_type {
+    };
+
+    template<typename T, typename H, typename E, typename A>
+    struct is_std_collection<std::unordered_set<T, H, E, A>> : std::true_type {
+    };
+
+    // everything here is decoded by decoding into a default constructed one
+    template<typename C>
+    struct is_std_composite : std::integral_constant<bool, is_std_array<C>::value || is_std_tuple<C>::value ||
+                                                           is_std_optional<C>::value || is_std_variant<C>::value ||
+                                                           is_std_unordered_map<C>::value ||
+                                                           is_std_collection<C>::value> {
+    };
+
+    template<typename C, typename std::enable_if_t<is_std_composite<C>::value, int> = 0>
+    inline C fromROBN(Byte*& ptr, const Byte* const endPtr, Type type);
+
+    template<typename V, typename std::enable_if_t<std::is_same<V, std::vector<bool>>::value, int> = 0>
+    V fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        std::vector<bool> vector;
+        auto checkPtr = [&](std::uint64_t neededBytes) {
+            if ((ptr + neededBytes) > endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+        };
+
+        if (type != Type::Vector) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        checkPtr(1);
+        Type lengthType = static_cast<Type>(*ptr++);
+        auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+        checkPtr(1);
+        Type valType = static_cast<Type>(*ptr++);
+
+        if (length != 0 && primitiveTypeSize(valType) == 0) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        checkDecodeAllocation(length, 1, 1, ptr, endPtr);
+        vector.resize(length);
+
+        for (std::uint64_t i = 0; i < length; ++i) {
+            vector[i] = RogueLib::ROBN::fromROBN<bool>(ptr, endPtr, valType);
+        }
+
+        return vector;
+    }
+
+    template<typename V, typename std::enable_if_t<
+            is_std_vector<V>::value && !std::is_same<V, std::vector<bool>>::value, int> = 0>
+    V fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+
+        typedef typename V::value_type T;
+
+        auto checkPtr = [&](std::uint64_t neededBytes) {
+            if ((ptr + neededBytes) > endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+        };
+
+
+        auto* startPtr = ptr;
+
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            if (type == Type::SparseVector) {
+                auto header = readSparseHeader(ptr, endPtr);
+                checkDecodeAllocation(header.length, sizeof(T), 0, ptr, endPtr);
+                V vector(header.length);
+                scatterSparseROBN(header, vector.data());
+                return vector;
+            }
+        }
+
+        if (type != Type::Vector) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+//            auto length = BinaryConversion<std::uint64_t>::fromROBN(ptr, endPtr);
+
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            checkPtr(1);
+            Type lengthType = static_cast<Type>(*ptr++);
+            auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+            checkPtr(1);
+            Type valType = static_cast<Type>(*ptr++);
+            std::vector<T> vector;
+            if constexpr (std::is_floating_point<T>::value && !isWireIdentical<T>()) {
+                // long double thats not binary128, every element has to be converted on its own
+                if (length != 0 && primitiveTypeSize(removeEndianness(valType)) == 0) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                checkDecodeAllocation(length, sizeof(T), primitiveTypeSize(removeEndianness(valType)), ptr, endPtr);
+                vector.resize(length);
+                for (std::uint64_t i = 0; i < length; ++i) {
+                    vector[i] = convertPrimitiveROBN<T>(ptr, endPtr, valType);
+                }
+                return vector;
+            }
+            // if its the same size, then i can do a memory copy
+            // empty vectors dont have an element type, so they go this way too
+            if (length == 0 || removeEndianness(valType) == primitiveTypeID<T>()) {
+                // checked before resizing, the length can be anything
+                checkDecodeAllocation(length, sizeof(T), sizeof(T), ptr, endPtr);
+                vector.resize(length);
+                // if its identical to the host representation then its only a memory copy
                 if (sizeof(T) == 1 || typeEndianness(valType) == Endianness::NATIVE) {
                     std::memcpy(vector.data(), ptr, length * sizeof(T));
+                    ptr += length * sizeof(T);
                 } else {
                     // fuck, i need to swap the endianness,
 
@@ -691,7 +1364,7 @@ namespace RogueLib::ROBN {
                 // well, shit, its a different type
 
                 // yes this is slow, there isn't much i can do about that
-                switch (removeEndianness(type)) {
+                switch (removeEndianness(valType)) {
                     default: {
                         throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
                     }
@@ -778,6 +1451,9 @@ namespace RogueLib::ROBN {
             auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
             checkPtr(1);
             Type valType = static_cast<Type>(*ptr++);
+            DecodeDepthGuard depthGuard;
+            // every element is at least a byte
+            checkDecodeAllocation(length, sizeof(T), 1, ptr, endPtr);
             std::vector<T> vector;
             vector.resize(length);
 
@@ -790,6 +1466,20 @@ namespace RogueLib::ROBN {
     }
 
 
+    /**
+     * a Tuple's count element, which has to be count, ptr is left at the first element
+     */
+    inline void readTupleHeader(Byte*& ptr, const Byte* const endPtr, std::uint64_t count) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type countType = static_cast<Type>(*ptr++);
+        if (fromROBN<std::uint64_t>(ptr, endPtr, countType) != count) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+    }
+
     template<typename>
     struct is_std_pair : std::false_type {
     };
@@ -804,9 +1494,15 @@ namespace RogueLib::ROBN {
         typedef typename P::first_type FT;
         typedef typename P::second_type ST;
 
-        if (type != Type::Pair || ptr >= endPtr) {
+        if (type == Type::Tuple) {
+            readTupleHeader(ptr, endPtr, 2);
+        } else if (type != Type::Pair) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        if (ptr >= endPtr) {
             throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
         }
+        DecodeDepthGuard depthGuard;
         P pair{};
         Type firstType = static_cast<Type>(*ptr);
         ptr++;
@@ -838,9 +1534,12 @@ namespace RogueLib::ROBN {
             throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
         }
 
+        DecodeDepthGuard depthGuard;
         M map{};
         Type lengthType = static_cast<Type>(*ptr++);
         auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+        // a pair is at least its header and two type headers
+        checkDecodeAllocation(length, sizeof(typename M::value_type), 3, ptr, endPtr);
         for (std::uint64_t i = 0; i < length; ++i) {
             if (ptr >= endPtr || *(ptr++) != Byte{Type::Pair}) {
                 throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
@@ -852,256 +1551,2086 @@ namespace RogueLib::ROBN {
         return map;
     }
 
-    // i cant do *function* partial specialization
-    // but i can classes.......
-    template<typename T>
-    class BinaryConversion {
-    public:
-        static ROBN toROBN(T val) {
-            ROGUELIB_STACKTRACE
-            if (std::is_integral<T>::value || std::is_floating_point<T>::value) {
-                return primitiveToROBN(val);
-            }
-            if (std::is_same<std::string, T>::value) {
-                ROBN bytes;
-                auto* valPtr = (std::string*) &val;
-                bytes.resize(valPtr->size() + 2);
-                bytes[0] = Byte{Type::String};
-                std::memcpy(bytes.data() + 1, valPtr->data(), valPtr->size());
-                *(bytes.end() - 1) = Byte{0}; // null termination
-                return bytes;
+    struct NDArrayHeader {
+        Type valType;
+        std::uint64_t count;
+    };
+
+    /**
+     * reads an NDArray's shape and element type, ptr is left at the first element
+     * onExtent(std::uint64_t) is called for each dimension, outermost first
+     * the element count is checked against what is left, so its safe to allocate for
+     */
+    template<typename ExtentFunction>
+    inline NDArrayHeader readNDArrayHeader(Byte*& ptr, const Byte* const endPtr, ExtentFunction&& onExtent) {
+        ROGUELIB_STACKTRACE
+        auto readType = [&]() {
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
             }
-            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible type");
+            return static_cast<Type>(*ptr++);
+        };
+        if (removeEndianness(readType()) != Type::Vector) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        auto rank = fromROBN<std::uint64_t>(ptr, endPtr, readType());
+        auto extentType = readType();
+        // each extent is at least a byte
+        if (rank > std::uint64_t(endPtr - ptr)) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        std::uint64_t count = 1;
+        bool overflow = false;
+        for (std::uint64_t i = 0; i < rank; ++i) {
+            auto extent = fromROBN<std::uint64_t>(ptr, endPtr, extentType);
+            overflow |= __builtin_mul_overflow(count, extent, &count);
+            onExtent(extent);
+        }
+        auto valType = readType();
+        auto valSize = primitiveTypeSize(removeEndianness(valType));
+        if (overflow || (count != 0 && (valSize == 0 || count > std::uint64_t(endPtr - ptr) / valSize))) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
         }
+        return {valType, count};
+    }
 
-        static T fromROBN(Byte*& ptr, const Byte* const endPtr) {
-            ROGUELIB_STACKTRACE
-            if (ptr > endPtr) {
-                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+    /**
+     * count elements of valType into output, the bytes are already known to be there
+     */
+    template<typename T>
+    inline void readNDArrayElements(Byte*& ptr, const Byte* const endPtr, Type valType, std::uint64_t count, T* output) {
+        ROGUELIB_STACKTRACE
+        if (isWireIdentical<T>() && removeEndianness(valType) == primitiveTypeID<T>()) {
+            if (sizeof(T) == 1 || typeEndianness(valType) == Endianness::NATIVE) {
+                // the whole array, one copy
+                std::memcpy(output, ptr, count * sizeof(T));
+                ptr += count * sizeof(T);
+                return;
             }
-            Type type = static_cast<Type>(*ptr++);
-            return RogueLib::ROBN::fromROBN<T>(ptr, endPtr, type);
+            for (std::uint64_t i = 0; i < count; ++i) {
+                T t;
+                std::memcpy(&t, ptr, sizeof(T));
+                output[i] = swapEndianness(t);
+                ptr += sizeof(T);
+            }
+            return;
         }
-    };
+        // different type, each one gets cast
+        for (std::uint64_t i = 0; i < count; ++i) {
+            output[i] = convertPrimitiveROBN<T>(ptr, endPtr, valType);
+        }
+    }
 
-    // special case for boolean because it can be stored as packed values, so .data() doesnt work
-    template<typename A>
-    class BinaryConversion<std::vector<bool, A>> {
-    public:
-        static ROBN toROBN(std::vector<bool, A> val) {
-            ROGUELIB_STACKTRACE
-            // vectors of bools are really weird, because they *can* be compacted
-            // because i dont use it much, i just encode each bool as a byte
+    template<typename A, typename std::enable_if_t<is_nd_array<A>::value, int>>
+    inline A fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        typedef typename A::value_type T;
+        if (type != Type::NDArray) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        A array;
+        auto& shape = array.shapeStorage();
+        shape.clear();
+        auto header = readNDArrayHeader(ptr, endPtr, [&](std::uint64_t extent) {
+            shape.emplace_back(extent);
+        });
+        checkDecodeAllocation(header.count, sizeof(T), 0, ptr, endPtr);
+        auto& elements = array.elementStorage();
+        elements.resize(header.count);
+        readNDArrayElements<T>(ptr, endPtr, header.valType, header.count, elements.data());
+        return array;
+    }
 
-            // most of this is duplicate from the normal vector code
+    /**
+     * decodes a full NDArray element into storage the caller already has, a tensor's buffer or whatever else
+     * throws if it needs more than capacity elements, shape is filled in with the extents
+     */
+    template<typename T>
+    inline std::uint64_t decodeNDArray(Byte*& ptr, const Byte* const endPtr, T* storage, std::uint64_t capacity,
+                                       std::vector<std::uint64_t>& shape) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr || static_cast<Type>(*ptr++) != Type::NDArray) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        shape.clear();
+        auto header = readNDArrayHeader(ptr, endPtr, [&](std::uint64_t extent) {
+            shape.emplace_back(extent);
+        });
+        if (header.count > capacity) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "NDArray larger than storage");
+        }
+        readNDArrayElements<T>(ptr, endPtr, header.valType, header.count, storage);
+        return header.count;
+    }
 
-            if (val.size() == 0) {
-                // empty vector
-                ROBN bytes;
-                bytes.resize(11);
-                bytes[0] = Byte{Type::Vector};
-                bytes[1] = Byte(Type::uInt64) |
-                           Byte(Endianness::NATIVE); // endianness doesnt matter because its zero
-                memset(bytes.data() + 2, 0, 9);
-                return bytes;
-            }
+    /**
+     * accepts a dense Vector as well, the encoder decides which one to send
+     */
+    template<typename S, typename std::enable_if_t<is_sparse_vector<S>::value, int>>
+    inline S fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        S sparse;
+        fromROBNInto(sparse, ptr, endPtr, type);
+        return sparse;
+    }
 
-            ROBN bytes;
-            // the size is defined already
-            bytes.resize(11 + (val.size()));
-            auto* dataPtr = bytes.data();
-
-            dataPtr[0] = Byte{Type::Vector};
-            dataPtr[1] = Byte(Type::uInt64) | Byte(Endianness::NATIVE);
-            dataPtr += 2;
-            std::uint64_t length = val.size();
-            std::memcpy(dataPtr, &length, 8);
-            dataPtr += 8;
-            *dataPtr = Byte{primitiveTypeID<bool>()};
-            dataPtr++;
-            // ok, header is done, now copy in the values
-            for (int i = 0; i < val.size(); ++i) {
-                *dataPtr++ = val[i]; // no, there isn't a better way to access a vector of bools
-            }
-            return bytes;
+    /**
+     * reads a Polymorphic element's tag, whose type header has already been read
+     */
+    inline std::uint32_t readPolymorphicTag(Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type tagType = static_cast<Type>(*ptr++);
+        auto tag = fromROBN<std::uint64_t>(ptr, endPtr, tagType);
+        if (tag > SerializableRegistry::maxTag) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Unknown type tag");
         }
+        if (tag != 0 && ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        return std::uint32_t(tag);
+    }
 
-        static std::vector<bool, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
-            ROGUELIB_STACKTRACE
-            if ((ptr + 1) > endPtr) {
+    /**
+     * the object is created by the factory registered for its tag, and then decodes itself
+     * throws if its not a P, even if it was registered
+     */
+    template<typename P, typename std::enable_if_t<is_serializable_pointer<P>::value, int>>
+    inline P fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        typedef typename P::element_type T;
+        if (removeEndianness(type) != Type::Polymorphic) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        DecodeDepthGuard depthGuard;
+        auto tag = readPolymorphicTag(ptr, endPtr);
+        if (tag == 0) {
+            return nullptr;
+        }
+        auto object = SerializableRegistry::global().create(tag);
+        object->fromROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+        if constexpr (std::is_same<std::remove_const_t<T>, Serializable>::value) {
+            return object;
+        } else {
+            auto cast = std::dynamic_pointer_cast<T>(object);
+            if (!cast) {
                 throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
             }
-            Type type = static_cast<Type>(*ptr++);
-
-            return RogueLib::ROBN::fromROBN<std::vector<bool>>(ptr, endPtr, type);
+            return cast;
         }
+    }
+
+    struct BigIntHeader {
+        std::uint64_t limbCount;
+        bool negative;
     };
 
-    template<typename T, typename A>
-    class BinaryConversion<std::vector<T, A>> {
-    public:
-        static ROBN toROBN(std::vector<T, A>& val) {
-            ROGUELIB_STACKTRACE
-            if (val.size() == 0) {
-                // empty vector
-                ROBN bytes;
-                bytes.resize(11);
-                bytes[0] = Byte{Type::Vector};
-                bytes[1] = Byte(Type::uInt64) |
-                           Byte(Endianness::NATIVE); // endianness doesnt matter because its zero
-                for (int i = 2; i < 11; ++i) {
-                    bytes[i] = Byte{0};
-                }
-                return bytes;
-            }
+    /**
+     * the limb count and sign of a BigInt, the limbs are checked to be there, ptr is left at the first one
+     */
+    inline BigIntHeader readBigIntHeader(Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type lengthType = static_cast<Type>(*ptr++);
+        BigIntHeader header{};
+        header.limbCount = fromROBN<std::uint64_t>(ptr, endPtr, lengthType);
+        if (ptr >= endPtr || std::to_integer<std::uint8_t>(*ptr) > 1) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        header.negative = *ptr++ != Byte{0};
+        checkDecodeAllocation(header.limbCount, 8, 8, ptr, endPtr);
+        return header;
+    }
 
-            if (std::is_integral<T>::value || std::is_floating_point<T>::value) {
-                ROBN bytes;
-                // the size is defined already
-                bytes.resize(11 + (val.size() * sizeof(T)));
-                auto* dataPtr = bytes.data();
-
-                dataPtr[0] = Byte{Type::Vector};
-                dataPtr[1] = Byte(Type::uInt64) | Byte(Endianness::NATIVE);
-                dataPtr += 2;
-                std::uint64_t length = val.size();
-                std::memcpy(dataPtr, &length, 8);
-                dataPtr += 8;
-                *dataPtr = Byte{primitiveTypeID<T>()};
-                dataPtr++;
-                // ok, header is done, now copy in the values
-                std::memcpy(dataPtr, val.data(), val.size() * sizeof(T));
-                return bytes;
-            } else {
+    /**
+     * the data of a BigInt element into target, its limbs keep their capacity
+     * the limbs are one copy when they are native endian
+     */
+    inline void readBigIntData(BigInt& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        auto header = readBigIntHeader(ptr, endPtr);
+        auto& limbs = target.limbStorage();
+        limbs.resize(header.limbCount);
+        std::memcpy(limbs.data(), ptr, header.limbCount * 8);
+        ptr += header.limbCount * 8;
+        if (typeEndianness(type) != Endianness::NATIVE) {
+            for (auto& limb : limbs) {
+                limb = swapEndianness(limb);
+            }
+        }
+        target.setNegative(header.negative);
+        // an encoder could have left zeros on top
+        target.normalize();
+    }
 
-                // i cant get it to go faster...
+    /**
+     * reads into target, any integer type is accepted as well
+     */
+    inline void readBigInt(BigInt& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        switch (removeEndianness(type)) {
+            default:
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            case Type::BigInt:
+                readBigIntData(target, ptr, endPtr, type);
+                return;
+            case Type::Int8:
+            case Type::Int16:
+            case Type::Int32:
+            case Type::Int64:
+            case Type::Int128:
+                target = BigInt(convertPrimitiveROBN<__int128>(ptr, endPtr, type));
+                return;
+            case Type::uInt8:
+            case Type::uInt16:
+            case Type::uInt32:
+            case Type::uInt64:
+            case Type::uInt128:
+                target = BigInt(convertPrimitiveROBN<unsigned __int128>(ptr, endPtr, type));
+                return;
+        }
+    }
 
-                ROBN bytes;
+    /**
+     * reads into target, a BigInt or integer is accepted as well, with a zero exponent
+     */
+    inline void readBigFloat(BigFloat& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (removeEndianness(type) != Type::BigFloat) {
+            readBigInt(target.mantissa, ptr, endPtr, type);
+            target.exponent = 0;
+            return;
+        }
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type exponentType = static_cast<Type>(*ptr++);
+        target.exponent = fromROBN<std::int64_t>(ptr, endPtr, exponentType);
+        readBigIntData(target.mantissa, ptr, endPtr, type);
+    }
 
-//                if (is_std_vector<T>::value) {
-//                    // if its a vector, then i may be able to deduce its size
-//                    bytes.resize(findVectorTreeSize(val));
-//                }
+    template<typename B, typename std::enable_if_t<std::is_same<B, BigInt>::value, int>>
+    inline B fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        BigInt value;
+        readBigInt(value, ptr, endPtr, type);
+        return value;
+    }
 
-                // ok, so, lets see if the size is fixed so i can do pre-allocation
-                if (isFixedBinarySize < T > ()) {
-                    bytes.reserve(11 + typeBinarySize<T>() * val.size());
-                }
+    template<typename B, typename std::enable_if_t<std::is_same<B, BigFloat>::value, int>>
+    inline B fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        BigFloat value;
+        readBigFloat(value, ptr, endPtr, type);
+        return value;
+    }
 
-                auto* dataPtr = bytes.data();
-                std::uint64_t usedBytes = bytes.size();
-                auto requestBytes = [&](std::uint64_t requestedBytes) {
-                    if (usedBytes + requestedBytes > bytes.size()) {
-                        bytes.resize(usedBytes + requestedBytes);
-                        dataPtr = bytes.data() + usedBytes;
-                        usedBytes += requestedBytes;
-                    }
-                };
+    /**
+     * moves ptr past the data of an element of the given type, without decoding it
+     * used to step over elements that the decoder doesnt care about (unknown AutoSerializable fields, etc)
+     */
+    inline void skipROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        // its recursive too, so its limited the same way
+        DecodeDepthGuard depthGuard;
+        auto checkPtr = [&](std::uint64_t neededBytes) {
+            if (neededBytes > std::uint64_t(endPtr - ptr)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+        };
 
-                requestBytes(11);
+        auto primitiveSize = primitiveTypeSize(removeEndianness(type));
+        if (primitiveSize) {
+            checkPtr(primitiveSize);
+            ptr += primitiveSize;
+            return;
+        }
 
-                dataPtr[0] = Byte{Type::Vector};
-                dataPtr[1] = Byte(Type::uInt64) | Byte(Endianness::NATIVE);
-                dataPtr += 2;
-                std::uint64_t length = bytes.size();
-                std::memcpy(dataPtr, &length, 8);
-                dataPtr += 8;
-                *dataPtr = Byte{primitiveTypeID<T>()};
+        switch (removeEndianness(type)) {
+            default:
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            case Type::String: {
+                auto length = strnlen((const char*) (ptr), std::size_t(endPtr - ptr));
+                checkPtr(length + 1);
+                ptr += length + 1;
+                return;
+            }
+            case Type::Vector: {
+                checkPtr(1);
+                Type lengthType = static_cast<Type>(*ptr++);
+                auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+                checkPtr(1);
+                Type valType = static_cast<Type>(*ptr++);
+                auto valSize = primitiveTypeSize(removeEndianness(valType));
+                if (valSize) {
+                    if (length > std::uint64_t(endPtr - ptr) / valSize) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    ptr += length * valSize;
+                    return;
+                }
+                for (std::uint64_t i = 0; i < length; ++i) {
+                    skipROBN(ptr, endPtr, valType);
+                }
+                return;
+            }
+            case Type::Pair: {
+                checkPtr(1);
+                skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                checkPtr(1);
+                skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                return;
+            }
+            case Type::Map: {
+                checkPtr(1);
+                Type lengthType = static_cast<Type>(*ptr++);
+                auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+                for (std::uint64_t i = 0; i < length; ++i) {
+                    checkPtr(1);
+                    if (*(ptr++) != Byte{Type::Pair}) {
+                        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                    }
+                    skipROBN(ptr, endPtr, Type::Pair);
+                }
+                return;
+            }
+            case Type::SparseVector: {
+                readSparseHeader(ptr, endPtr);
+                return;
+            }
+            case Type::NDArray: {
+                auto header = readNDArrayHeader(ptr, endPtr, [](std::uint64_t) {});
+                ptr += header.count * primitiveTypeSize(removeEndianness(header.valType));
+                return;
+            }
+            case Type::Checksummed: {
+                // payload, then the checksum
+                checkPtr(1);
+                skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                checkPtr(1);
+                skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                return;
+            }
+            case Type::Polymorphic: {
+                if (readPolymorphicTag(ptr, endPtr) != 0) {
+                    skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                }
+                return;
+            }
+            case Type::Compressed: {
+                checkPtr(1);
+                if (std::to_integer<std::uint8_t>(*ptr++) > 1) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                while (true) {
+                    checkPtr(1);
+                    Type sizeType = static_cast<Type>(*ptr++);
+                    if (fromROBN<std::uint32_t>(ptr, endPtr, sizeType) == 0) {
+                        return;
+                    }
+                    checkPtr(1);
+                    sizeType = static_cast<Type>(*ptr++);
+                    auto storedSize = fromROBN<std::uint32_t>(ptr, endPtr, sizeType);
+                    checkPtr(storedSize);
+                    ptr += storedSize;
+                }
+            }
+            case Type::Tuple: {
+                checkPtr(1);
+                Type countType = static_cast<Type>(*ptr++);
+                auto count = fromROBN<std::uint64_t>(ptr, endPtr, countType);
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    checkPtr(1);
+                    skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                }
+                return;
+            }
+            case Type::Optional: {
+                checkPtr(1);
+                if (std::to_integer<std::uint8_t>(*ptr) > 1) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                if (*ptr++ != Byte{0}) {
+                    checkPtr(1);
+                    skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                }
+                return;
+            }
+            case Type::Variant: {
+                // index, then the value
+                checkPtr(1);
+                skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                checkPtr(1);
+                skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                return;
+            }
+            case Type::BigFloat: {
+                // exponent, then the same as a BigInt
+                checkPtr(1);
+                skipROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+                [[fallthrough]];
+            }
+            case Type::BigInt: {
+                ptr += readBigIntHeader(ptr, endPtr).limbCount * 8;
+                return;
+            }
+        }
+    }
+
+    /*
+     * decode-into overloads
+     *
+     * same as the fromROBN overloads, but they write into an object that already exists
+     * vectors and strings keep their capacity, maps reuse their nodes, Serializables decode in place
+     * so decoding a stream of the same shape of message stops allocating once everything has grown to size
+     *
+     * they are all declared up here so they can find each other no matter how deep things are nested
+     */
+
+    template<typename T, typename std::enable_if_t<
+            std::is_integral<T>::value || std::is_floating_point<T>::value || std::is_enum<T>::value, int> = 0>
+    inline void fromROBNInto(T& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T, typename std::enable_if_t<std::is_same<std::string, T>::value, int> = 0>
+    inline void fromROBNInto(T& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T, typename std::enable_if_t<std::is_base_of<Serializable, T>::value, int> = 0>
+    inline void fromROBNInto(T& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename A>
+    inline void fromROBNInto(std::vector<bool, A>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T, typename A, typename std::enable_if_t<!std::is_same<T, bool>::value, int> = 0>
+    inline void fromROBNInto(std::vector<T, A>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename F, typename S>
+    inline void fromROBNInto(std::pair<F, S>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename K, typename V, typename C, typename A>
+    inline void fromROBNInto(std::map<K, V, C, A>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T>
+    inline void fromROBNInto(NDArray<T>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T>
+    inline void fromROBNInto(SparseVector<T>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T>
+    inline void fromROBNInto(std::shared_ptr<T>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    inline void fromROBNInto(BigInt& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    inline void fromROBNInto(BigFloat& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T, std::size_t N>
+    inline void fromROBNInto(std::array<T, N>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename... Ts>
+    inline void fromROBNInto(std::tuple<Ts...>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T>
+    inline void fromROBNInto(std::optional<T>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename... Ts>
+    inline void fromROBNInto(std::variant<Ts...>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename K, typename V, typename H, typename E, typename A>
+    inline void fromROBNInto(std::unordered_map<K, V, H, E, A>& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename C, typename std::enable_if_t<is_std_collection<C>::value, int> = 0>
+    inline void fromROBNInto(C& target, Byte*& ptr, const Byte* endPtr, Type type);
+
+    template<typename T, typename std::enable_if_t<
+            std::is_integral<T>::value || std::is_floating_point<T>::value || std::is_enum<T>::value, int>>
+    inline void fromROBNInto(T& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        target = RogueLib::ROBN::fromROBN<T>(ptr, endPtr, type);
+    }
+
+    template<typename T, typename std::enable_if_t<std::is_same<std::string, T>::value, int>>
+    inline void fromROBNInto(T& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (type == Type::String) {
+            auto length = strnlen((const char*) (ptr), std::size_t(endPtr - ptr));
+            if (length == std::size_t(endPtr - ptr)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            checkDecodeString(length);
+            // assign doesnt release the old buffer if it fits
+            target.assign((const char*) (ptr), length);
+            ptr += length;
+            ptr++;
+            return;
+        }
+        throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+    }
+
+    template<typename T, typename std::enable_if_t<std::is_base_of<Serializable, T>::value, int>>
+    inline void fromROBNInto(T& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        DecodeDepthGuard depthGuard;
+        auto* tPtr = (Serializable*) &target;
+        tPtr->fromROBN(ptr, endPtr, type);
+    }
+
+    template<typename A>
+    inline void fromROBNInto(std::vector<bool, A>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        auto checkPtr = [&](std::uint64_t neededBytes) {
+            if ((ptr + neededBytes) > endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+        };
+
+        if (type != Type::Vector) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        checkPtr(1);
+        Type lengthType = static_cast<Type>(*ptr++);
+        auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+        checkPtr(1);
+        Type valType = static_cast<Type>(*ptr++);
+
+        if (length != 0 && primitiveTypeSize(valType) == 0) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        checkDecodeAllocation(length, 1, 1, ptr, endPtr);
+
+        target.resize(length);
+        for (std::uint64_t i = 0; i < length; ++i) {
+            target[i] = RogueLib::ROBN::fromROBN<bool>(ptr, endPtr, valType);
+        }
+    }
+
+    template<typename T, typename A, typename std::enable_if_t<!std::is_same<T, bool>::value, int>>
+    inline void fromROBNInto(std::vector<T, A>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        auto checkPtr = [&](std::uint64_t neededBytes) {
+            if ((ptr + neededBytes) > endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+        };
+
+        auto* startPtr = ptr;
+
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            if (type == Type::SparseVector) {
+                auto header = readSparseHeader(ptr, endPtr);
+                checkDecodeAllocation(header.length, sizeof(T), 0, ptr, endPtr);
+                // assign keeps the capacity too
+                target.assign(header.length, T{});
+                scatterSparseROBN(header, target.data());
+                return;
+            }
+        }
+
+        if (type != Type::Vector) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+
+        checkPtr(1);
+        Type lengthType = static_cast<Type>(*ptr++);
+        auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+        checkPtr(1);
+        Type valType = static_cast<Type>(*ptr++);
+
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            if (length != 0 && (!isWireIdentical<T>() || removeEndianness(valType) != primitiveTypeID<T>())) {
+                // different type, the casting path allocates anyway, so just hand it off
+                ptr = startPtr;
+                target = RogueLib::ROBN::fromROBN<std::vector<T, A>>(ptr, endPtr, type);
+                return;
+            }
+            checkDecodeAllocation(length, sizeof(T), sizeof(T), ptr, endPtr);
+            // resize keeps the capacity, so this only allocates if its bigger than anything before it
+            target.resize(length);
+            if (sizeof(T) == 1 || typeEndianness(valType) == Endianness::NATIVE) {
+                std::memcpy(target.data(), ptr, length * sizeof(T));
+                ptr += length * sizeof(T);
+            } else {
+                for (std::size_t i = 0; i < target.size(); ++i) {
+                    T t;
+                    std::memcpy(&t, ptr, sizeof(T));
+                    target[i] = swapEndianness(t);
+                    ptr += sizeof(T);
+                }
+            }
+        } else {
+            DecodeDepthGuard depthGuard;
+            checkDecodeAllocation(length, sizeof(T), 1, ptr, endPtr);
+            // existing elements are decoded into too, so nested containers keep their allocations as well
+            target.resize(length);
+            for (std::uint64_t i = 0; i < length; ++i) {
+                fromROBNInto(target[i], ptr, endPtr, valType);
+            }
+        }
+    }
+
+    template<typename F, typename S>
+    inline void fromROBNInto(std::pair<F, S>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (type == Type::Tuple) {
+            readTupleHeader(ptr, endPtr, 2);
+        } else if (type != Type::Pair) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        DecodeDepthGuard depthGuard;
+        Type firstType = static_cast<Type>(*ptr);
+        ptr++;
+        fromROBNInto(target.first, ptr, endPtr, firstType);
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type secondType = static_cast<Type>(*ptr);
+        ptr++;
+        fromROBNInto(target.second, ptr, endPtr, secondType);
+    }
+
+    template<typename K, typename V, typename C, typename A>
+    inline void fromROBNInto(std::map<K, V, C, A>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (type != Type::Map || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+
+        DecodeDepthGuard depthGuard;
+        Type lengthType = static_cast<Type>(*ptr++);
+        auto length = fromROBN < std::uint64_t > (ptr, endPtr, lengthType);
+        checkDecodeAllocation(length, sizeof(typename std::map<K, V, C, A>::value_type), 3, ptr, endPtr);
+
+        // the old nodes get pulled out of here and refilled, swapping doesnt allocate
+        std::map<K, V, C, A> spare;
+        spare.swap(target);
+
+        for (std::uint64_t i = 0; i < length; ++i) {
+            if (ptr >= endPtr || *(ptr++) != Byte{Type::Pair}) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            if (spare.empty()) {
+                std::pair<K, V> pair{};
+                fromROBNInto(pair, ptr, endPtr, Type::Pair);
+                target.emplace_hint(target.end(), std::move(pair));
+                continue;
+            }
+
+            auto node = spare.extract(spare.begin());
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type keyType = static_cast<Type>(*ptr++);
+            fromROBNInto(node.key(), ptr, endPtr, keyType);
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type valueType = static_cast<Type>(*ptr++);
+            fromROBNInto(node.mapped(), ptr, endPtr, valueType);
+            // encoded maps are sorted, so the hint is almost always right
+            target.insert(target.end(), std::move(node));
+        }
+    }
+
+    template<typename T>
+    inline void fromROBNInto(NDArray<T>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (type != Type::NDArray) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        auto& shape = target.shapeStorage();
+        shape.clear();
+        auto header = readNDArrayHeader(ptr, endPtr, [&](std::uint64_t extent) {
+            shape.emplace_back(extent);
+        });
+        checkDecodeAllocation(header.count, sizeof(T), 0, ptr, endPtr);
+        auto& elements = target.elementStorage();
+        elements.resize(header.count);
+        readNDArrayElements<T>(ptr, endPtr, header.valType, header.count, elements.data());
+    }
+
+    template<typename T>
+    inline void fromROBNInto(SparseVector<T>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        auto& indices = target.indexStorage();
+        auto& values = target.valueStorage();
+        if (type != Type::SparseVector) {
+            // dense on the wire, the non zero elements get picked out
+            auto dense = RogueLib::ROBN::fromROBN<std::vector<T>>(ptr, endPtr, type);
+            target.clear(dense.size());
+            for (std::size_t i = 0; i < dense.size(); ++i) {
+                if (isNonZero(dense[i])) {
+                    indices.emplace_back(i);
+                    values.emplace_back(dense[i]);
+                }
+            }
+            return;
+        }
+        auto header = readSparseHeader(ptr, endPtr);
+        checkDecodeAllocation(header.count, sizeof(std::uint64_t) + sizeof(T), 0, ptr, endPtr);
+        target.clear(header.length);
+        indices.resize(header.count);
+        values.resize(header.count);
+        std::uint64_t lastIndex = 0;
+        forEachSparseIndex(header, [&](std::uint64_t i, std::uint64_t index) {
+            // SparseVector relies on them being in order
+            if (i != 0 && index <= lastIndex) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            lastIndex = index;
+            indices[i] = index;
+            values[i] = readSparseValue<T>(header, i);
+        });
+    }
+
+    /**
+     * if target is the only owner of an object of the same type, that object decodes in place
+     * a shared one is left alone, something else is looking at it
+     */
+    template<typename T>
+    inline void fromROBNInto(std::shared_ptr<T>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        static_assert(std::is_base_of<Serializable, T>::value, "only Serializables can be Polymorphic");
+        if (removeEndianness(type) != Type::Polymorphic || !target || target.use_count() != 1) {
+            target = RogueLib::ROBN::fromROBN<std::shared_ptr<T>>(ptr, endPtr, type);
+            return;
+        }
+        auto* startPtr = ptr;
+        auto tag = readPolymorphicTag(ptr, endPtr);
+        auto& registry = SerializableRegistry::global();
+        auto& object = *target;
+        if (tag == 0 || registry.findTag(typeid(object)) != tag) {
+            ptr = startPtr;
+            target = RogueLib::ROBN::fromROBN<std::shared_ptr<T>>(ptr, endPtr, type);
+            return;
+        }
+        DecodeDepthGuard depthGuard;
+        static_cast<Serializable&>(object).fromROBN(ptr, endPtr, static_cast<Type>(*ptr++));
+    }
+
+    inline void fromROBNInto(BigInt& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        readBigInt(target, ptr, endPtr, type);
+    }
+
+    inline void fromROBNInto(BigFloat& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        readBigFloat(target, ptr, endPtr, type);
+    }
+
+    /**
+     * a Vector of exactly N elements, or a SparseVector N long
+     * numbers of the same type are one copy, straight into the array
+     */
+    template<typename T, std::size_t N>
+    inline void fromROBNInto(std::array<T, N>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        constexpr bool isNumber = std::is_integral<T>::value || std::is_floating_point<T>::value;
+        if constexpr (isNumber) {
+            if (type == Type::SparseVector) {
+                auto header = readSparseHeader(ptr, endPtr);
+                if (header.length != N) {
+                    throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+                }
+                target.fill(T{});
+                scatterSparseROBN(header, target.data());
+                return;
+            }
+        }
+        if (type != Type::Vector || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type lengthType = static_cast<Type>(*ptr++);
+        auto length = fromROBN<std::uint64_t>(ptr, endPtr, lengthType);
+        if (length != N || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type valType = static_cast<Type>(*ptr++);
+        if constexpr (isNumber && !std::is_same<T, bool>::value) {
+            if (N == 0) {
+                return;
+            }
+            auto valSize = primitiveTypeSize(removeEndianness(valType));
+            if (valSize == 0) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            checkDecodeAllocation(N, sizeof(T), valSize, ptr, endPtr);
+            // same as an NDArray's elements, copied, swapped, or cast
+            readNDArrayElements<T>(ptr, endPtr, valType, N, target.data());
+        } else {
+            DecodeDepthGuard depthGuard;
+            for (auto& element : target) {
+                fromROBNInto(element, ptr, endPtr, valType);
+            }
+        }
+    }
+
+    template<typename T, std::size_t... Is>
+    inline void readTupleElements(T& target, Byte*& ptr, const Byte* const endPtr, std::index_sequence<Is...>) {
+        ROGUELIB_STACKTRACE
+        auto readElement = [&](auto& element) {
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type elementType = static_cast<Type>(*ptr++);
+            fromROBNInto(element, ptr, endPtr, elementType);
+        };
+        ROGUELIB_UNUSED(readElement);
+        (readElement(std::get<Is>(target)), ...);
+    }
+
+    template<typename... Ts>
+    inline void fromROBNInto(std::tuple<Ts...>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (type == Type::Tuple) {
+            readTupleHeader(ptr, endPtr, sizeof...(Ts));
+        } else if (sizeof...(Ts) != 2 || type != Type::Pair) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        DecodeDepthGuard depthGuard;
+        readTupleElements(target, ptr, endPtr, std::index_sequence_for<Ts...>());
+    }
+
+    template<typename T>
+    inline void fromROBNInto(std::optional<T>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (type != Type::Optional) {
+            // just the value, its always there
+            if (!target) {
+                target.emplace();
+            }
+            fromROBNInto(*target, ptr, endPtr, type);
+            return;
+        }
+        if (ptr >= endPtr || std::to_integer<std::uint8_t>(*ptr) > 1) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        if (*ptr++ == Byte{0}) {
+            target.reset();
+            return;
+        }
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        DecodeDepthGuard depthGuard;
+        Type valueType = static_cast<Type>(*ptr++);
+        if (!target) {
+            target.emplace();
+        }
+        fromROBNInto(*target, ptr, endPtr, valueType);
+    }
+
+    // into the current value if its already the right alternative
+    template<std::size_t I, typename V>
+    inline void readVariantAlternative(V& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        if (target.index() != I) {
+            target.template emplace<I>();
+        }
+        fromROBNInto(std::get<I>(target), ptr, endPtr, type);
+    }
+
+    template<typename V, std::size_t... Is>
+    inline void readVariantROBN(V& target, std::uint64_t index, Byte*& ptr, const Byte* const endPtr, Type type,
+                                std::index_sequence<Is...>) {
+        // one reader per alternative, the index picks one out
+        typedef void (* Reader)(V&, Byte*&, const Byte*, Type);
+        static constexpr Reader readers[] = {&readVariantAlternative<Is, V>...};
+        readers[index](target, ptr, endPtr, type);
+    }
+
+    template<typename... Ts>
+    inline void fromROBNInto(std::variant<Ts...>& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        if (type != Type::Variant || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        DecodeDepthGuard depthGuard;
+        Type indexType = static_cast<Type>(*ptr++);
+        auto index = fromROBN<std::uint64_t>(ptr, endPtr, indexType);
+        if (index >= sizeof...(Ts) || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type valueType = static_cast<Type>(*ptr++);
+        readVariantROBN(target, index, ptr, endPtr, valueType, std::index_sequence_for<Ts...>());
+    }
+
+    template<typename K, typename V, typename H, typename E, typename A>
+    inline void fromROBNInto(std::unordered_map<K, V, H, E, A>& target, Byte*& ptr, const Byte* const endPtr,
+                             Type type) {
+        ROGUELIB_STACKTRACE
+        if (type != Type::Map || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+
+        DecodeDepthGuard depthGuard;
+        Type lengthType = static_cast<Type>(*ptr++);
+        auto length = fromROBN<std::uint64_t>(ptr, endPtr, lengthType);
+        checkDecodeAllocation(length, sizeof(typename std::unordered_map<K, V, H, E, A>::value_type), 3, ptr, endPtr);
+
+        // same as std::map, the old nodes get refilled
+        std::unordered_map<K, V, H, E, A> spare;
+        spare.swap(target);
+        target.reserve(length);
+
+        for (std::uint64_t i = 0; i < length; ++i) {
+            if (ptr >= endPtr || *(ptr++) != Byte{Type::Pair}) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            if (spare.empty()) {
+                std::pair<K, V> pair{};
+                fromROBNInto(pair, ptr, endPtr, Type::Pair);
+                target.emplace(std::move(pair));
+                continue;
+            }
+
+            auto node = spare.extract(spare.begin());
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type keyType = static_cast<Type>(*ptr++);
+            fromROBNInto(node.key(), ptr, endPtr, keyType);
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type valueType = static_cast<Type>(*ptr++);
+            fromROBNInto(node.mapped(), ptr, endPtr, valueType);
+            target.insert(std::move(node));
+        }
+    }
+
+    /**
+     * a Vector, or a SparseVector if its numbers, onElement(T&&) gets each element in order
+     */
+    template<typename T, typename Function>
+    inline void readCollectionROBN(Byte*& ptr, const Byte* const endPtr, Type type, Function&& onElement) {
+        ROGUELIB_STACKTRACE
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            if (type == Type::SparseVector) {
+                auto header = readSparseHeader(ptr, endPtr);
+                checkDecodeAllocation(header.length, sizeof(T), 0, ptr, endPtr);
+                std::vector<T> dense(header.length);
+                scatterSparseROBN(header, dense.data());
+                for (auto& value : dense) {
+                    onElement(std::move(value));
+                }
+                return;
+            }
+        }
+        if (type != Type::Vector || ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type lengthType = static_cast<Type>(*ptr++);
+        auto length = fromROBN<std::uint64_t>(ptr, endPtr, lengthType);
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type valType = static_cast<Type>(*ptr++);
+        DecodeDepthGuard depthGuard;
+        // every element is at least a byte
+        checkDecodeAllocation(length, sizeof(T), 1, ptr, endPtr);
+        for (std::uint64_t i = 0; i < length; ++i) {
+            onElement(RogueLib::ROBN::fromROBN<T>(ptr, endPtr, valType));
+        }
+    }
+
+    template<typename C, typename std::enable_if_t<is_std_collection<C>::value, int>>
+    inline void fromROBNInto(C& target, Byte*& ptr, const Byte* const endPtr, Type type) {
+        ROGUELIB_STACKTRACE
+        typedef typename C::value_type T;
+        // clear keeps what the container can keep, a deque's blocks, an unordered_set's buckets
+        target.clear();
+        readCollectionROBN<T>(ptr, endPtr, type, [&](T&& value) {
+            target.insert(target.end(), std::move(value));
+        });
+    }
+
+    template<typename C, typename std::enable_if_t<is_std_composite<C>::value, int>>
+    inline C fromROBN(Byte*& ptr, const Byte* const endPtr, Type type) {
+        C value{};
+        fromROBNInto(value, ptr, endPtr, type);
+        return value;
+    }
+
+    /**
+     * encoders push their bytes into a writer, one write call per chunk
+     * anything with a write(const void* data, std::size_t size) works as a writer, this one appends to a ROBN
+     */
+    class ROBNWriter {
+        ROBN& bytes;
+    public:
+        explicit ROBNWriter(ROBN& bytes) : bytes(bytes) {
+        }
+
+        void write(const void* data, std::size_t size) {
+            auto* bytePtr = (const Byte*) data;
+            bytes.insert(bytes.end(), bytePtr, bytePtr + size);
+        }
+    };
+
+    /**
+     * for bulk payloads (primitive vectors, strings)
+     * writers with a writeReference(const void* data, std::size_t size) get to keep a pointer to the data instead of
+     * copying it, so the value has to outlive whatever the writer produces
+     */
+    template<typename Writer>
+    inline void writeReferenceROBN(Writer& writer, const void* data, std::size_t size) {
+        if constexpr (has_write_reference<Writer>::value) {
+            writer.writeReference(data, size);
+        } else {
+            writer.write(data, size);
+        }
+    }
+
+    /**
+     * drops the type header, the first byte written, and passes the rest on
+     * for writing a Serializable without its header, which is what every vector element after the first is
+     */
+    template<typename Writer>
+    struct HeaderlessWriter {
+        Writer& writer;
+        bool skipped = false;
+
+        template<typename Function>
+        void skipHeader(const void*& data, std::size_t& size, Function&& pass) {
+            if (!skipped && size != 0) {
+                skipped = true;
+                data = (const Byte*) data + 1;
+                size--;
+            }
+            if (size != 0) {
+                pass(data, size);
+            }
+        }
+
+        void write(const void* data, std::size_t size) {
+            skipHeader(data, size, [&](const void* rest, std::size_t restSize) {
+                writer.write(rest, restSize);
+            });
+        }
+
+        void writeReference(const void* data, std::size_t size) {
+            skipHeader(data, size, [&](const void* rest, std::size_t restSize) {
+                writeReferenceROBN(writer, rest, restSize);
+            });
+        }
+    };
+
+    /**
+     * count primitives, densely packed, one write when they are the same in memory as on the wire
+     * long doubles that arent binary128 are converted through a buffer on the stack
+     */
+    template<typename T, typename Writer>
+    inline void writePrimitivesROBN(Writer& writer, const T* data, std::size_t count) {
+        if constexpr (isWireIdentical<T>()) {
+            writeReferenceROBN(writer, data, count * sizeof(T));
+        } else {
+            unsigned __int128 buffer[64];
+            while (count != 0) {
+                auto chunk = std::min<std::size_t>(count, 64);
+                for (std::size_t i = 0; i < chunk; ++i) {
+                    buffer[i] = LongDoubleDetail::toBinary128(data[i]);
+                }
+                writer.write(buffer, chunk * sizeof(buffer[0]));
+                data += chunk;
+                count -= chunk;
+            }
+        }
+    }
+
+    // the length element that vectors and maps start with, always a native uInt64
+    template<typename Writer>
+    inline void writeLengthROBN(Writer& writer, std::uint64_t length) {
+        Byte header[9];
+        header[0] = Byte(Type::uInt64) | Byte(Endianness::NATIVE);
+        std::memcpy(header + 1, &length, 8);
+        writer.write(header, 9);
+    }
+
+    // smallest unsigned type that can hold every index of a vector this long
+    constexpr Type sparseIndexType(std::uint64_t length) {
+        return length <= 0x100u ? Type::uInt8 :
+               length <= 0x10000u ? Type::uInt16 :
+               length <= 0x100000000u ? Type::uInt32 : Type::uInt64;
+    }
+
+    /**
+     * writes count indices, nextIndex() gives each of them in order
+     * they are narrowed to the index type in a stack buffer, and written a chunk at a time
+     */
+    template<typename Writer, typename IndexFunction>
+    inline void writeSparseIndices(Writer& writer, std::uint64_t length, std::uint64_t count,
+                                   IndexFunction&& nextIndex) {
+        auto indexType = sparseIndexType(length);
+        auto typeByte = Byte(indexType) | Byte(Endianness::NATIVE);
+        writer.write(&typeByte, 1);
+        auto writeAs = [&](auto typeTag) {
+            typedef decltype(typeTag) I;
+            I buffer[256];
+            std::size_t used = 0;
+            for (std::uint64_t i = 0; i < count; ++i) {
+                buffer[used++] = I(nextIndex());
+                if (used == 256) {
+                    writer.write(buffer, sizeof(buffer));
+                    used = 0;
+                }
+            }
+            writer.write(buffer, used * sizeof(I));
+        };
+        switch (indexType) {
+            default:
+            case Type::uInt8:
+                writeAs(std::uint8_t{});
+                return;
+            case Type::uInt16:
+                writeAs(std::uint16_t{});
+                return;
+            case Type::uInt32:
+                writeAs(std::uint32_t{});
+                return;
+            case Type::uInt64:
+                writeAs(std::uint64_t{});
+                return;
+        }
+    }
+
+    /**
+     * writes data as a full SparseVector element, if that comes out under half the size of a dense one
+     * returns false, having written nothing, if it doesnt
+     */
+    template<typename T, typename Writer>
+    inline bool writeSparseROBN(Writer& writer, const T* data, std::uint64_t size) {
+        ROGUELIB_STACKTRACE
+        auto indexSize = primitiveTypeSize(sparseIndexType(size));
+        auto limit = size * sizeof(T) / (2 * (indexSize + sizeof(T)));
+        auto count = countNonZero(data, size, limit);
+        if (count > limit) {
+            return false;
+        }
+        Byte type{Type::SparseVector};
+        writer.write(&type, 1);
+        writeLengthROBN(writer, size);
+        writeLengthROBN(writer, count);
+
+        std::uint64_t next = 0;
+        writeSparseIndices(writer, size, count, [&]() {
+            while (!isNonZero(data[next])) {
+                next++;
+            }
+            return next++;
+        });
+
+        auto valType = Byte(primitiveTypeID<T>()) | Byte(Endianness::NATIVE);
+        writer.write(&valType, 1);
+        T buffer[256];
+        std::size_t used = 0;
+        for (std::uint64_t i = 0; i < size; ++i) {
+            if (isNonZero(data[i])) {
+                buffer[used++] = data[i];
+                if (used == 256) {
+                    writer.write(buffer, sizeof(buffer));
+                    used = 0;
+                }
+            }
+        }
+        writer.write(buffer, used * sizeof(T));
+        return true;
+    }
+
+    // i cant do *function* partial specialization
+    // but i can classes.......
+
+    /*
+     * each BinaryConversion has two writer functions
+     *  writeROBN, the full element, type header included
+     *  writeROBNData, only the data after the type header, which is what vectors need for every element but the first
+     */
+    template<typename T>
+    class BinaryConversion {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const T& val) {
+            ROGUELIB_STACKTRACE
+            if constexpr (std::is_base_of<Serializable, T>::value) {
+                // it knows how to do it itself
+                // writeROBN isnt const, but it doesnt change anything either
+                if constexpr (std::is_same<Writer, ROBNAnyWriter>::value) {
+                    const_cast<T&>(val).writeROBN(writer);
+                } else {
+                    ROBNAnyWriter anyWriter(writer);
+                    const_cast<T&>(val).writeROBN(anyWriter);
+                }
+            } else if constexpr (std::is_enum<T>::value) {
+                typedef typename std::underlying_type<T>::type UnderlyingType;
+                BinaryConversion<UnderlyingType>::writeROBN(writer, static_cast<UnderlyingType>(val));
+            } else if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+                // one write call, its as fast as it gets for a single value
+                Byte bytes[sizeof(T) + 1];
+                bytes[0] = Byte(primitiveTypeID<T>()) | Byte(Endianness::NATIVE);
+                if constexpr (isWireIdentical<T>()) {
+                    std::memcpy(bytes + 1, &val, sizeof(T));
+                    writer.write(bytes, sizeof(T) + 1);
+                } else {
+                    writer.write(bytes, 1);
+                    writePrimitivesROBN(writer, &val, 1);
+                }
+            } else if constexpr (std::is_same<std::string, T>::value) {
+                Byte type{Type::String};
+                writer.write(&type, 1);
+                writeROBNData(writer, val);
+            } else {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible type");
+            }
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const T& val) {
+            ROGUELIB_STACKTRACE
+            if constexpr (std::is_base_of<Serializable, T>::value) {
+                HeaderlessWriter<Writer> headerless{writer};
+                ROBNAnyWriter anyWriter(headerless);
+                const_cast<T&>(val).writeROBN(anyWriter);
+            } else if constexpr (std::is_enum<T>::value) {
+                typedef typename std::underlying_type<T>::type UnderlyingType;
+                BinaryConversion<UnderlyingType>::writeROBNData(writer, static_cast<UnderlyingType>(val));
+            } else if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+                // copied, a single value isnt worth referencing, and this can be a temporary (enums)
+                if constexpr (isWireIdentical<T>()) {
+                    writer.write(&val, sizeof(T));
+                } else {
+                    writePrimitivesROBN(writer, &val, 1);
+                }
+            } else if constexpr (std::is_same<std::string, T>::value) {
+                // c_str includes the null termination
+                writeReferenceROBN(writer, val.c_str(), val.size() + 1);
+            } else {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible type");
+            }
+        }
+
+        static ROBN toROBN(T val) {
+            ROGUELIB_STACKTRACE
+            if constexpr (std::is_base_of<Serializable, T>::value) {
+                return val.toROBN();
+            } else if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+                return primitiveToROBN(val);
+            } else {
+                ROBN bytes;
+                ROBNWriter writer(bytes);
+                writeROBN(writer, val);
+                return bytes;
+            }
+        }
+
+        static T fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr > endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<T>(ptr, endPtr, type);
+        }
+    };
+
+    // special case for boolean because it can be stored as packed values, so .data() doesnt work
+    template<typename A>
+    class BinaryConversion<std::vector<bool, A>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::vector<bool, A>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Vector};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::vector<bool, A>& val) {
+            ROGUELIB_STACKTRACE
+            // vectors of bools are really weird, because they *can* be compacted
+            // because i dont use it much, i just encode each bool as a byte
+            writeLengthROBN(writer, val.size());
+            // endianness doesnt matter if its empty, and there is no element type
+            Byte valType = val.empty() ? Byte{Type::Undefined} : Byte{primitiveTypeID<bool>()};
+            writer.write(&valType, 1);
+
+            // no, there isn't a better way to access a vector of bools
+            // so they go through a buffer on the stack, a chunk at a time
+            Byte buffer[256];
+            std::size_t buffered = 0;
+            for (std::size_t i = 0; i < val.size(); ++i) {
+                buffer[buffered++] = Byte(val[i]);
+                if (buffered == sizeof(buffer)) {
+                    writer.write(buffer, buffered);
+                    buffered = 0;
+                }
+            }
+            if (buffered) {
+                writer.write(buffer, buffered);
+            }
+        }
+
+        static ROBN toROBN(std::vector<bool, A> val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            // the size is defined already
+            bytes.reserve(11 + val.size());
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static std::vector<bool, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if ((ptr + 1) > endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+
+            return RogueLib::ROBN::fromROBN<std::vector<bool>>(ptr, endPtr, type);
+        }
+    };
+
+    /**
+     * a container's first element, its type header is the header for every element after it, and those are
+     * written without one, always dense, so this never picks SparseVector
+     * only a standalone element can be sparse
+     */
+    template<typename T, typename Writer>
+    inline void writeFirstElementROBN(Writer& writer, const T& val) {
+        if constexpr (is_std_vector<T>::value || is_std_array<T>::value) {
+            if constexpr (!std::is_same<typename T::value_type, bool>::value) {
+                Byte type{Type::Vector};
+                writer.write(&type, 1);
+                BinaryConversion<T>::writeROBNData(writer, val);
+                return;
+            }
+        }
+        BinaryConversion<T>::writeROBN(writer, val);
+    }
+
+    template<typename T, typename A>
+    class BinaryConversion<std::vector<T, A>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::vector<T, A>& val) {
+            ROGUELIB_STACKTRACE
+            if constexpr (isWireIdentical<T>()) {
+                // only a standalone element can be sparse, see writeFirstElementROBN
+                if (ROGUELIB_ROBN_SPARSE_MINIMUM_SIZE != 0 && val.size() >= ROGUELIB_ROBN_SPARSE_MINIMUM_SIZE &&
+                    writeSparseROBN(writer, val.data(), val.size())) {
+                    return;
+                }
+            }
+            Byte type{Type::Vector};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::vector<T, A>& val) {
+            ROGUELIB_STACKTRACE
+            writeLengthROBN(writer, val.size());
+            if (val.empty()) {
+                // endianness doesnt matter because its zero, and there is no element type
+                Byte valType{Type::Undefined};
+                writer.write(&valType, 1);
+                return;
+            }
+
+            if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+                Byte valType = Byte(primitiveTypeID<T>()) | Byte(Endianness::NATIVE);
+                writer.write(&valType, 1);
+                // ok, header is done, now copy in the values
+                writePrimitivesROBN(writer, val.data(), val.size());
+            } else {
+                // the first element's type header is the vector's element type header
+                // every element after it has its type header stripped
+                writeFirstElementROBN(writer, val[0]);
+                for (std::size_t i = 1; i < val.size(); ++i) {
+                    BinaryConversion<T>::writeROBNData(writer, val[i]);
+                }
+            }
+        }
+
+        static ROBN toROBN(std::vector<T, A>& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+
+            // ok, so, lets see if the size is fixed so i can do pre-allocation
+            if (isFixedBinarySize < T > ()) {
+                bytes.reserve(11 + typeBinarySize<T>() * val.size());
+            }
+
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static std::vector<T, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if ((ptr + 1) > endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+
+            return RogueLib::ROBN::fromROBN<std::vector<T, A>>(ptr, endPtr, type);
+        }
+    };
+
+    template<typename T, typename A>
+    class BinaryConversion<std::pair<T, A>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::pair<T, A>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Pair};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::pair<T, A>& val) {
+            ROGUELIB_STACKTRACE
+            BinaryConversion<std::remove_const_t<T>>::writeROBN(writer, val.first);
+            BinaryConversion<A>::writeROBN(writer, val.second);
+        }
+
+        static ROBN toROBN(std::pair<T, A> val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static std::pair<T, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<std::pair<T, A>>(ptr, endPtr, type);
+        }
+    };
+
+
+    template<typename T, typename A>
+    class BinaryConversion<std::map<T, A>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::map<T, A>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Map};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::map<T, A>& val) {
+            ROGUELIB_STACKTRACE
+            writeLengthROBN(writer, val.size());
+            for (const auto& elementPair : val) {
+                BinaryConversion<std::pair<const T, A>>::writeROBN(writer, elementPair);
+            }
+        }
+
+        static ROBN toROBN(std::map<T, A> val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static std::map<T, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<std::map<T, A>>(ptr, endPtr, type);
+        }
+    };
+
+    template<typename T>
+    class BinaryConversion<NDArray<T>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const NDArray<T>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::NDArray};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
 
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const NDArray<T>& val) {
+            ROGUELIB_STACKTRACE
+            BinaryConversion<std::vector<std::uint64_t>>::writeROBN(writer, val.shape());
+            // unlike a vector, the element type is known even when its empty
+            Byte valType = Byte(primitiveTypeID<T>()) | Byte(Endianness::NATIVE);
+            writer.write(&valType, 1);
+            writePrimitivesROBN(writer, val.data(), val.size());
+        }
+
+        static ROBN toROBN(const NDArray<T>& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            bytes.reserve(12 + val.rank() * 8 + val.size() * sizeof(T));
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
 
-                std::vector<ROBN> subROBN;
-                subROBN.reserve(length);
+        static NDArray<T> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<NDArray<T>>(ptr, endPtr, type);
+        }
+    };
 
-                std::uint64_t byteLength = 0;
+    template<typename T>
+    class BinaryConversion<SparseVector<T>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const SparseVector<T>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::SparseVector};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
 
-                for (auto& element: val) {
-                    auto vec = BinaryConversion<T>::toROBN(element);
-                    byteLength += vec.size();
-                    subROBN.emplace_back(vec);
-                }
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const SparseVector<T>& val) {
+            ROGUELIB_STACKTRACE
+            writeLengthROBN(writer, val.size());
+            writeLengthROBN(writer, val.nonZeroCount());
+            std::size_t next = 0;
+            writeSparseIndices(writer, val.size(), val.nonZeroCount(), [&]() {
+                return val.indices()[next++];
+            });
+            Byte valType = Byte(primitiveTypeID<T>()) | Byte(Endianness::NATIVE);
+            writer.write(&valType, 1);
+            writePrimitivesROBN(writer, val.values().data(), val.values().size());
+        }
+
+        static ROBN toROBN(const SparseVector<T>& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static SparseVector<T> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<SparseVector<T>>(ptr, endPtr, type);
+        }
+    };
+
+    // the smallest unsigned type that fits, almost always a single byte, for Polymorphic tags and Variant indices
+    template<typename Writer>
+    inline void writeTagROBN(Writer& writer, std::uint32_t tag) {
+        if (tag <= 0xFF) {
+            Byte bytes[2] = {Byte(Type::uInt8), Byte(tag)};
+            writer.write(bytes, 2);
+        } else {
+            Byte bytes[3];
+            bytes[0] = Byte(Type::uInt16) | Byte(Endianness::NATIVE);
+            auto narrowTag = std::uint16_t(tag);
+            std::memcpy(bytes + 1, &narrowTag, 2);
+            writer.write(bytes, 3);
+        }
+    }
+
+    /**
+     * pointers to registered Serializables, whatever subclass they actually point to
+     * so a vector of std::shared_ptr<Serializable> can hold a mix of types
+     */
+    template<typename T>
+    class BinaryConversion<std::shared_ptr<T>> {
+        static_assert(std::is_base_of<Serializable, T>::value, "only Serializables can be Polymorphic");
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::shared_ptr<T>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Polymorphic};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::shared_ptr<T>& val) {
+            ROGUELIB_STACKTRACE
+            if (!val) {
+                writeTagROBN(writer, 0);
+                return;
+            }
+            auto& object = *val;
+            writeTagROBN(writer, SerializableRegistry::global().tagOf(typeid(object)));
+            // toROBN isnt const, but it doesnt change anything either
+            auto bytes = const_cast<std::remove_const_t<T>&>(object).toROBN();
+            writer.write(bytes.data(), bytes.size());
+        }
+
+        static ROBN toROBN(const std::shared_ptr<T>& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
 
-                bytes.reserve(bytes.size() + byteLength);
+        static std::shared_ptr<T> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<std::shared_ptr<T>>(ptr, endPtr, type);
+        }
+    };
+
+    /**
+     * the limbs go out as they are in memory, one write, native endianness
+     */
+    template<>
+    class BinaryConversion<BigInt> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const BigInt& val) {
+            ROGUELIB_STACKTRACE
+            Byte type = Byte(Type::BigInt) | Byte(Endianness::NATIVE);
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const BigInt& val) {
+            ROGUELIB_STACKTRACE
+            writeLengthROBN(writer, val.limbs().size());
+            Byte sign = Byte(val.isNegative());
+            writer.write(&sign, 1);
+            writeReferenceROBN(writer, val.limbs().data(), val.limbs().size() * 8);
+        }
+
+        static ROBN toROBN(const BigInt& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            bytes.reserve(11 + val.limbs().size() * 8);
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static BigInt fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<BigInt>(ptr, endPtr, type);
+        }
+    };
+
+    template<>
+    class BinaryConversion<BigFloat> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const BigFloat& val) {
+            ROGUELIB_STACKTRACE
+            Byte type = Byte(Type::BigFloat) | Byte(Endianness::NATIVE);
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const BigFloat& val) {
+            ROGUELIB_STACKTRACE
+            BinaryConversion<std::int64_t>::writeROBN(writer, val.exponent);
+            BinaryConversion<BigInt>::writeROBNData(writer, val.mantissa);
+        }
+
+        static ROBN toROBN(const BigFloat& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            bytes.reserve(20 + val.mantissa.limbs().size() * 8);
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static BigFloat fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<BigFloat>(ptr, endPtr, type);
+        }
+    };
+
+    /**
+     * the data of a Vector element, from any container of T that isnt a std::vector
+     * numbers are copied a block at a time, straight from a std::array, through the stack from anything else
+     */
+    template<typename T, typename Container, typename Writer>
+    inline void writeCollectionROBN(Writer& writer, const Container& val) {
+        ROGUELIB_STACKTRACE
+        writeLengthROBN(writer, val.size());
+        if (val.size() == 0) {
+            // endianness doesnt matter because its zero, and there is no element type
+            Byte valType{Type::Undefined};
+            writer.write(&valType, 1);
+            return;
+        }
 
-                bool first = true;
-                for (const auto& vec : subROBN) {
-                    bytes.insert(bytes.end(), vec.begin() + (first ? 0 : 1), vec.end());
+        if constexpr (std::is_integral<T>::value || std::is_floating_point<T>::value) {
+            Byte valType = Byte(primitiveTypeID<T>()) | Byte(Endianness::NATIVE);
+            writer.write(&valType, 1);
+            if constexpr (is_std_array<Container>::value) {
+                writePrimitivesROBN(writer, val.data(), val.size());
+            } else {
+                T buffer[256];
+                std::size_t buffered = 0;
+                auto flush = [&]() {
+                    // the buffer gets reused, so it cant be handed over as a reference
+                    if constexpr (isWireIdentical<T>()) {
+                        writer.write(buffer, buffered * sizeof(T));
+                    } else {
+                        writePrimitivesROBN(writer, buffer, buffered);
+                    }
+                    buffered = 0;
+                };
+                for (const auto& element : val) {
+                    buffer[buffered++] = element;
+                    if (buffered == 256) {
+                        flush();
+                    }
+                }
+                if (buffered) {
+                    flush();
+                }
+            }
+        } else {
+            // the first element's type header is the vector's element type header
+            bool first = true;
+            for (const auto& element : val) {
+                if (first) {
+                    writeFirstElementROBN(writer, element);
                     first = false;
+                } else {
+                    BinaryConversion<T>::writeROBNData(writer, element);
                 }
-                return bytes;
             }
         }
+    }
 
-        static std::vector<T, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+    /**
+     * the same bytes as a std::vector with the same elements, long arrays of numbers can be sparse too
+     * fixed size, so the whole thing is reserved up front
+     */
+    template<typename T, std::size_t N>
+    class BinaryConversion<std::array<T, N>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::array<T, N>& val) {
             ROGUELIB_STACKTRACE
-            if ((ptr + 1) > endPtr) {
+            if constexpr (canBeSparse<T, N>()) {
+                if (writeSparseROBN(writer, val.data(), N)) {
+                    return;
+                }
+            }
+            Byte type{Type::Vector};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::array<T, N>& val) {
+            ROGUELIB_STACKTRACE
+            writeCollectionROBN<T>(writer, val);
+        }
+
+        static ROBN toROBN(const std::array<T, N>& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            if (isFixedBinarySize<std::array<T, N>>()) {
+                bytes.reserve(1 + typeBinarySize<std::array<T, N>>());
+            }
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static std::array<T, N> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
                 throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
             }
             Type type = static_cast<Type>(*ptr++);
-
-            return RogueLib::ROBN::fromROBN<std::vector<T, A>>(ptr, endPtr, type);
+            return RogueLib::ROBN::fromROBN<std::array<T, N>>(ptr, endPtr, type);
         }
     };
 
-    template<typename T, typename A>
-    class BinaryConversion<std::pair<T, A>> {
+    /**
+     * tuples of nothing but numbers are a fixed size, so they are built on the stack and written in one go
+     */
+    template<typename... Ts>
+    class BinaryConversion<std::tuple<Ts...>> {
     public:
-        static ROBN toROBN(std::pair<T, A> val) {
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::tuple<Ts...>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Tuple};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::tuple<Ts...>& val) {
             ROGUELIB_STACKTRACE
-            auto firstBytes = BinaryConversion<T>::toROBN(val.first);
-            auto secondBytes = BinaryConversion<A>::toROBN(val.second);
+            if constexpr ((isWireIdentical<Ts>() && ...)) {
+                Byte bytes[TupleBinarySize<std::tuple<Ts...>>::size()];
+                bytes[0] = Byte(Type::uInt64) | Byte(Endianness::NATIVE);
+                std::uint64_t count = sizeof...(Ts);
+                std::memcpy(bytes + 1, &count, 8);
+                auto* out = bytes + 9;
+                std::apply([&](const auto& ... elements) {
+                    auto writeElement = [&](const auto& element) {
+                        typedef std::decay_t<decltype(element)> E;
+                        *out++ = Byte(primitiveTypeID<E>()) | Byte(Endianness::NATIVE);
+                        std::memcpy(out, &element, sizeof(E));
+                        out += sizeof(E);
+                    };
+                    ROGUELIB_UNUSED(writeElement);
+                    (writeElement(elements), ...);
+                }, val);
+                writer.write(bytes, sizeof(bytes));
+            } else {
+                writeLengthROBN(writer, sizeof...(Ts));
+                std::apply([&](const auto& ... elements) {
+                    (BinaryConversion<std::decay_t<decltype(elements)>>::writeROBN(writer, elements), ...);
+                }, val);
+            }
+        }
 
+        static ROBN toROBN(const std::tuple<Ts...>& val) {
+            ROGUELIB_STACKTRACE
             ROBN bytes;
-            bytes.resize(firstBytes.size() + secondBytes.size() + 1);
-            auto data = bytes.data();
-            data[0] = Byte{Type::Pair};
-            data++;
-            std::memcpy(data, firstBytes.data(), firstBytes.size());
-            data += firstBytes.size();
-            std::memcpy(data, secondBytes.data(), secondBytes.size());
+            if (isFixedBinarySize<std::tuple<Ts...>>()) {
+                bytes.reserve(1 + typeBinarySize<std::tuple<Ts...>>());
+            }
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
             return bytes;
         }
 
-        static std::pair<T, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+        static std::tuple<Ts...> fromROBN(Byte*& ptr, const Byte* const endPtr) {
             ROGUELIB_STACKTRACE
             if (ptr >= endPtr) {
                 throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
             }
             Type type = static_cast<Type>(*ptr++);
-            return RogueLib::ROBN::fromROBN<std::pair<T, A>>(ptr, endPtr, type);
+            return RogueLib::ROBN::fromROBN<std::tuple<Ts...>>(ptr, endPtr, type);
         }
     };
 
+    template<typename T>
+    class BinaryConversion<std::optional<T>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::optional<T>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Optional};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
 
-    template<typename T, typename A>
-    class BinaryConversion<std::map<T, A>> {
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::optional<T>& val) {
+            ROGUELIB_STACKTRACE
+            Byte hasValue = Byte(val.has_value());
+            writer.write(&hasValue, 1);
+            if (val) {
+                BinaryConversion<T>::writeROBN(writer, *val);
+            }
+        }
+
+        static ROBN toROBN(const std::optional<T>& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static std::optional<T> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<std::optional<T>>(ptr, endPtr, type);
+        }
+    };
+
+    template<typename... Ts>
+    class BinaryConversion<std::variant<Ts...>> {
+        static_assert(sizeof...(Ts) <= 0x10000, "Variant indices are at most 16 bits");
     public:
-        static ROBN toROBN(std::map<T, A> val) {
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::variant<Ts...>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Variant};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::variant<Ts...>& val) {
+            ROGUELIB_STACKTRACE
+            if (val.valueless_by_exception()) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible type");
+            }
+            writeTagROBN(writer, std::uint32_t(val.index()));
+            std::visit([&](const auto& value) {
+                BinaryConversion<std::decay_t<decltype(value)>>::writeROBN(writer, value);
+            }, val);
+        }
+
+        static ROBN toROBN(const std::variant<Ts...>& val) {
             ROGUELIB_STACKTRACE
             ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
 
-            bytes.emplace_back(Byte{Type::Map});
+        static std::variant<Ts...> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<std::variant<Ts...>>(ptr, endPtr, type);
+        }
+    };
 
-            auto lengthBytes = BinaryConversion<std::uint64_t>::toROBN(val.size());
-            bytes.insert(bytes.end(), lengthBytes.begin(), lengthBytes.end());
+    /**
+     * same as a std::map, in whatever order its iterated in, canonicalizing it sorts it
+     */
+    template<typename K, typename V, typename H, typename E, typename A>
+    class BinaryConversion<std::unordered_map<K, V, H, E, A>> {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const std::unordered_map<K, V, H, E, A>& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Map};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
 
-            for (auto elementPair : val) {
-                auto pairBytes = BinaryConversion<std::pair<T, A>>::toROBN(elementPair);
-                bytes.insert(bytes.end(), pairBytes.begin(), pairBytes.end());
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const std::unordered_map<K, V, H, E, A>& val) {
+            ROGUELIB_STACKTRACE
+            writeLengthROBN(writer, val.size());
+            for (const auto& elementPair : val) {
+                BinaryConversion<std::pair<const K, V>>::writeROBN(writer, elementPair);
             }
+        }
 
+        static ROBN toROBN(const std::unordered_map<K, V, H, E, A>& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
             return bytes;
         }
 
-        static std::map<T, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
+        static std::unordered_map<K, V, H, E, A> fromROBN(Byte*& ptr, const Byte* const endPtr) {
             ROGUELIB_STACKTRACE
             if (ptr >= endPtr) {
                 throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
             }
             Type type = static_cast<Type>(*ptr++);
-            return RogueLib::ROBN::fromROBN<std::map<T, A>>(ptr, endPtr, type);
+            return RogueLib::ROBN::fromROBN<std::unordered_map<K, V, H, E, A>>(ptr, endPtr, type);
+        }
+    };
+
+    // std::deque, std::set and std::unordered_set, Vectors on the wire
+    template<typename C>
+    class CollectionConversion {
+    public:
+        template<typename Writer>
+        static void writeROBN(Writer& writer, const C& val) {
+            ROGUELIB_STACKTRACE
+            Byte type{Type::Vector};
+            writer.write(&type, 1);
+            writeROBNData(writer, val);
+        }
+
+        template<typename Writer>
+        static void writeROBNData(Writer& writer, const C& val) {
+            ROGUELIB_STACKTRACE
+            writeCollectionROBN<typename C::value_type>(writer, val);
+        }
+
+        static ROBN toROBN(const C& val) {
+            ROGUELIB_STACKTRACE
+            ROBN bytes;
+            ROBNWriter writer(bytes);
+            writeROBN(writer, val);
+            return bytes;
+        }
+
+        static C fromROBN(Byte*& ptr, const Byte* const endPtr) {
+            ROGUELIB_STACKTRACE
+            if (ptr >= endPtr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+            }
+            Type type = static_cast<Type>(*ptr++);
+            return RogueLib::ROBN::fromROBN<C>(ptr, endPtr, type);
         }
     };
 
+    template<typename T, typename A>
+    class BinaryConversion<std::deque<T, A>> : public CollectionConversion<std::deque<T, A>> {
+    };
+
+    template<typename T, typename C, typename A>
+    class BinaryConversion<std::set<T, C, A>> : public CollectionConversion<std::set<T, C, A>> {
+    };
+
+    template<typename T, typename H, typename E, typename A>
+    class BinaryConversion<std::unordered_set<T, H, E, A>> : public CollectionConversion<std::unordered_set<T, H, E, A>> {
+    };
+
+    /**
+     * encodes val into any writer, full element, type header included
+     */
+    template<typename T, typename Writer>
+    void writeROBN(Writer& writer, const T& val) {
+        ROGUELIB_STACKTRACE
+        BinaryConversion<T>::writeROBN(writer, val);
+    }
+
+    /**
+     * encodes val onto the end of bytes, without any intermediate ROBN
+     */
+    template<typename T>
+    void appendROBN(ROBN& bytes, const T& val) {
+        ROGUELIB_STACKTRACE
+        ROBNWriter writer(bytes);
+        BinaryConversion<T>::writeROBN(writer, val);
+    }
+
     template<typename T, typename std::enable_if_t<!(std::is_base_of<Serializable, T>::value ||
                                                      std::is_enum<T>::value), int> = 0>
     ROBN toROBN(T val) {
@@ -1135,4 +3664,22 @@ namespace RogueLib::ROBN {
         auto* end = (Byte*) (bytes.data() + bytes.size());
         return BinaryConversion<T>::fromROBN(start, end);
     }
+
+    template<typename T>
+    void fromROBNInto(T& target, Byte*& ptr, const Byte* const endPtr) {
+        ROGUELIB_STACKTRACE
+        if (ptr >= endPtr) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Incompatible binary");
+        }
+        Type type = static_cast<Type>(*ptr++);
+        fromROBNInto(target, ptr, endPtr, type);
+    }
+
+    template<typename T>
+    void fromROBNInto(T& target, const ROBN& bytes) {
+        ROGUELIB_STACKTRACE
+        auto* start = (Byte*) bytes.data();
+        auto* end = (Byte*) (bytes.data() + bytes.size());
+        fromROBNInto(target, start, end);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include <RogueLib/Exceptions/Exceptions.hpp>
+
+namespace RogueLib::ROBN {
+    class Serializable;
+
+    /**
+     * allocator that keeps freed single objects in a per thread free list, and hands them back out
+     * made for allocate_shared, so a stream of decoded objects stops hitting the heap once its warmed up
+     * its stateless, any two of them are interchangeable
+     */
+    template<typename T>
+    class PoolAllocator {
+        struct FreeList {
+            struct Node {
+                Node* next;
+            };
+            // so a burst of frees doesnt keep memory around forever
+            static constexpr std::size_t maxCached = 1024;
+
+            Node* head = nullptr;
+            std::size_t size = 0;
+
+            ~FreeList() {
+                while (head) {
+                    auto* next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+                // anything freed on this thread after this point goes straight back to the heap
+                size = SIZE_MAX;
+            }
+        };
+
+        static constexpr bool poolable = sizeof(T) >= sizeof(void*) && alignof(T) <= alignof(std::max_align_t);
+
+        static FreeList& freeList() {
+            thread_local FreeList list;
+            return list;
+        }
+
+    public:
+        typedef T value_type;
+
+        PoolAllocator() noexcept = default;
+
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {
+        }
+
+        T* allocate(std::size_t n) {
+            if constexpr (poolable) {
+                auto& list = freeList();
+                if (n == 1 && list.head) {
+                    auto* node = list.head;
+                    list.head = node->next;
+                    list.size--;
+                    return reinterpret_cast<T*>(node);
+                }
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept {
+            if constexpr (poolable) {
+                auto& list = freeList();
+                if (n == 1 && list.size < FreeList::maxCached) {
+                    auto* node = reinterpret_cast<typename FreeList::Node*>(ptr);
+                    node->next = list.head;
+                    list.head = node;
+                    list.size++;
+                    return;
+                }
+            }
+            ::operator delete(ptr);
+        }
+
+        template<typename U>
+        bool operator==(const PoolAllocator<U>&) const noexcept {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const PoolAllocator<U>&) const noexcept {
+            return false;
+        }
+    };
+
+    /**
+     * maps Serializable subclasses to small integer tags, so a pointer to the base class can be encoded as a
+     * Polymorphic element and decoded back to the right subclass
+     * decoding is an index into a flat table of factories, no lookup by name
+     *
+     * tag 0 is a null pointer, so tags start at 1
+     * both ends need the same tags, register everything at startup, before anything is encoded or decoded
+     * registering isnt thread safe, looking things up is
+     */
+    class SerializableRegistry {
+    public:
+        typedef std::shared_ptr<Serializable> (* Factory)();
+
+        // keeps the table small, and the tag a byte or two on the wire
+        static constexpr std::uint32_t maxTag = 0xFFFF;
+
+    private:
+        std::vector<Factory> factories;
+        std::unordered_map<std::type_index, std::uint32_t> tags;
+
+    public:
+
+        static SerializableRegistry& global() {
+            static SerializableRegistry registry;
+            return registry;
+        }
+
+        /**
+         * registering the same type with the same tag again just replaces its factory
+         */
+        void add(std::uint32_t tag, std::type_index type, Factory factory) {
+            ROGUELIB_STACKTRACE
+            if (tag == 0 || tag > maxTag || factory == nullptr) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Invalid type tag");
+            }
+            auto existing = tags.find(type);
+            if (existing != tags.end() && existing->second != tag) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Type already registered");
+            }
+            if (tag < factories.size() && factories[tag] != nullptr && existing == tags.end()) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Type tag already registered");
+            }
+            if (tag >= factories.size()) {
+                factories.resize(tag + 1);
+            }
+            factories[tag] = factory;
+            tags[type] = tag;
+        }
+
+        /**
+         * 0 if type isnt registered
+         */
+        [[nodiscard]] std::uint32_t findTag(std::type_index type) const {
+            auto iter = tags.find(type);
+            return iter == tags.end() ? 0 : iter->second;
+        }
+
+        [[nodiscard]] std::uint32_t tagOf(std::type_index type) const {
+            ROGUELIB_STACKTRACE
+            auto tag = findTag(type);
+            if (tag == 0) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Unregistered Serializable type");
+            }
+            return tag;
+        }
+
+        [[nodiscard]] bool contains(std::uint32_t tag) const {
+            return tag < factories.size() && factories[tag] != nullptr;
+        }
+
+        /**
+         * a new default constructed object of the type registered for tag
+         */
+        [[nodiscard]] std::shared_ptr<Serializable> create(std::uint32_t tag) const {
+            ROGUELIB_STACKTRACE
+            if (!contains(tag)) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Unknown type tag");
+            }
+            return factories[tag]();
+        }
+    };
+
+    /**
+     * registers T with the global registry, objects are allocated with a PoolAllocator
+     */
+    template<typename T>
+    void registerSerializable(std::uint32_t tag) {
+        SerializableRegistry::global().add(tag, typeid(T), []() -> std::shared_ptr<Serializable> {
+            return std::allocate_shared<T>(PoolAllocator<T>());
+        });
+    }
+
+    /**
+     * same, but objects come from factory, for types that cant be default constructed or have their own pool
+     */
+    template<typename T>
+    void registerSerializable(std::uint32_t tag, SerializableRegistry::Factory factory) {
+        SerializableRegistry::global().add(tag, typeid(T), factory);
+    }
+}
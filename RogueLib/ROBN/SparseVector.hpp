@@ -0,0 +1,201 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma  once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include <RogueLib/Exceptions/Exceptions.hpp>
+
+namespace RogueLib::ROBN {
+    namespace SparseDetail {
+        template<std::size_t Size>
+        struct Bits;
+
+        template<>
+        struct Bits<1> {
+            typedef std::uint8_t type;
+        };
+
+        template<>
+        struct Bits<2> {
+            typedef std::uint16_t type;
+        };
+
+        template<>
+        struct Bits<4> {
+            typedef std::uint32_t type;
+        };
+
+        template<>
+        struct Bits<8> {
+            typedef std::uint64_t type;
+        };
+
+        template<>
+        struct Bits<16> {
+            typedef unsigned __int128 type;
+        };
+    }
+
+    /**
+     * zero is all bits zero, so -0.0 is kept, and the check is a plain integer compare that vectorizes
+     */
+    template<typename T>
+    inline bool isNonZero(const T& val) {
+        typename SparseDetail::Bits<sizeof(T)>::type bits;
+        std::memcpy(&bits, &val, sizeof(T));
+        return bits != 0;
+    }
+
+    /**
+     * counts the non zero elements, but gives up once there are more than limit of them
+     * dense data bails out after the first block, instead of scanning all of it
+     */
+    template<typename T>
+    inline std::size_t countNonZero(const T* data, std::size_t size, std::size_t limit = SIZE_MAX) {
+        constexpr std::size_t blockSize = 1024;
+        std::size_t count = 0;
+        for (std::size_t blockStart = 0; blockStart < size && count <= limit; blockStart += blockSize) {
+            auto blockEnd = std::min(size, blockStart + blockSize);
+            // no early exit in here, so the compiler can vectorize it
+            std::size_t blockCount = 0;
+            for (std::size_t i = blockStart; i < blockEnd; ++i) {
+                blockCount += isNonZero(data[i]);
+            }
+            count += blockCount;
+        }
+        return count;
+    }
+
+    /**
+     * a vector thats mostly zeros, as the indices and values of the non zero elements
+     * indices are kept in increasing order
+     */
+    template<typename T>
+    class SparseVector {
+        static_assert((std::is_integral<T>::value || std::is_floating_point<T>::value) &&
+                      !std::is_same<T, bool>::value, "SparseVector elements must be a primitive, and not bool");
+
+        std::uint64_t length = 0;
+        std::vector<std::uint64_t> indexList;
+        std::vector<T> valueList;
+
+    public:
+        typedef T value_type;
+
+        SparseVector() = default;
+
+        explicit SparseVector(std::uint64_t length) : length(length) {
+        }
+
+        static SparseVector fromDense(const std::vector<T>& dense) {
+            SparseVector sparse(dense.size());
+            auto count = countNonZero(dense.data(), dense.size());
+            sparse.indexList.reserve(count);
+            sparse.valueList.reserve(count);
+            for (std::size_t i = 0; i < dense.size(); ++i) {
+                if (isNonZero(dense[i])) {
+                    sparse.indexList.emplace_back(i);
+                    sparse.valueList.emplace_back(dense[i]);
+                }
+            }
+            return sparse;
+        }
+
+        /**
+         * writes the non zero elements into dense, which must already be zeroed and size() long
+         */
+        void scatter(T* dense) const {
+            for (std::size_t i = 0; i < indexList.size(); ++i) {
+                dense[indexList[i]] = valueList[i];
+            }
+        }
+
+        [[nodiscard]] std::vector<T> toDense() const {
+            std::vector<T> dense(length);
+            scatter(dense.data());
+            return dense;
+        }
+
+        /**
+         * adds a non zero element, after all the ones already in it
+         */
+        void pushBack(std::uint64_t index, T value) {
+            ROGUELIB_STACKTRACE
+            if (index >= length || (!indexList.empty() && index <= indexList.back())) {
+                throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Sparse index out of order");
+            }
+            indexList.emplace_back(index);
+            valueList.emplace_back(value);
+        }
+
+        void clear(std::uint64_t newLength = 0) {
+            length = newLength;
+            indexList.clear();
+            valueList.clear();
+        }
+
+        /**
+         * the dense length
+         */
+        [[nodiscard]] std::uint64_t size() const {
+            return length;
+        }
+
+        [[nodiscard]] std::size_t nonZeroCount() const {
+            return indexList.size();
+        }
+
+        [[nodiscard]] const std::vector<std::uint64_t>& indices() const {
+            return indexList;
+        }
+
+        [[nodiscard]] const std::vector<T>& values() const {
+            return valueList;
+        }
+
+        bool operator==(const SparseVector& other) const {
+            return length == other.length && indexList == other.indexList && valueList == other.valueList;
+        }
+
+        bool operator!=(const SparseVector& other) const {
+            return !(*this == other);
+        }
+
+        // decoders fill these in directly, to reuse the allocations
+        std::vector<std::uint64_t>& indexStorage() {
+            return indexList;
+        }
+
+        std::vector<T>& valueStorage() {
+            return valueList;
+        }
+
+        void setSize(std::uint64_t newLength) {
+            length = newLength;
+        }
+    };
+}
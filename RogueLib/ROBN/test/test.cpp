@@ -2,6 +2,14 @@
 #define USING_ROGUELIB_GENERICBINARY
 
 #include <RogueLib/ROBN/AutoSerializable.hpp>
+#include <RogueLib/ROBN/ROBNBatch.hpp>
+#include <RogueLib/ROBN/ROBNSegments.hpp>
+#include <RogueLib/ROBN/ROBNObject.hpp>
+#include <RogueLib/ROBN/ROBNDocument.hpp>
+#include <RogueLib/ROBN/ROBNChecksum.hpp>
+#include <RogueLib/ROBN/ROBNCanonical.hpp>
+#include <RogueLib/ROBN/ROBNCompression.hpp>
+#include <RogueLib/ROBN/ROBNJSON.hpp>
 
 #include <iostream>
 #include <chrono>
@@ -10,6 +18,8 @@
 
 #include <boost/test/unit_test.hpp>
 #include <random>
+#include <unordered_set>
+#include <thread>
 
 using namespace RogueLib::ROBN;
 
@@ -348,4 +358,1166 @@ BOOST_AUTO_TEST_CASE(int128Decode) {
     for (__int128 i = 1; i > 0; i += distribution(generator)) {
         runCheck(i);
     }
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(primitiveExactTypeDecode) {
+    // back to back elements of different types, each decode has to move ptr past exactly its own bytes
+    ROBN stream;
+    for (std::int32_t i = 0; i < 100; ++i) {
+        appendROBN(stream, i * 3 - 150);
+        appendROBN(stream, i * 0.5);
+        appendROBN(stream, i % 3 == 0);
+    }
+    auto* ptr = stream.data();
+    const Byte* endPtr = stream.data() + stream.size();
+    for (std::int32_t i = 0; i < 100; ++i) {
+        BOOST_CHECK(fromROBN<std::int32_t>(ptr, endPtr, static_cast<Type>(*ptr++)) == i * 3 - 150);
+        BOOST_CHECK(fromROBN<double>(ptr, endPtr, static_cast<Type>(*ptr++)) == i * 0.5);
+        BOOST_CHECK(fromROBN<bool>(ptr, endPtr, static_cast<Type>(*ptr++)) == (i % 3 == 0));
+    }
+    BOOST_CHECK(ptr == endPtr);
+
+    // any non zero byte is true, same as C++
+    BOOST_CHECK(fromROBN<bool>(ROBN{Byte(Type::Bool), Byte{2}}));
+
+    // exact type, but not enough bytes left, so it goes the long way and throws there
+    auto truncated = toROBN(std::uint64_t(1234));
+    truncated.pop_back();
+    BOOST_CHECK_THROW(fromROBN<std::uint64_t>(truncated), RogueLib::Exceptions::InvalidArgument);
+
+    // the other endianness isnt exact, it gets swapped by the conversion switch
+    auto swapped = toROBN(3.25);
+    swapped[0] ^= Byte(Endianness::BIG);
+    std::reverse(swapped.begin() + 1, swapped.end());
+    BOOST_CHECK(fromROBN<double>(swapped) == 3.25);
+    auto swappedFloat = toROBN(-0.75f);
+    swappedFloat[0] ^= Byte(Endianness::BIG);
+    std::reverse(swappedFloat.begin() + 1, swappedFloat.end());
+    BOOST_CHECK(fromROBN<float>(swappedFloat) == -0.75f);
+
+    // neither are different types
+    BOOST_CHECK(fromROBN<std::int64_t>(toROBN(std::int8_t(-5))) == -5);
+    BOOST_CHECK(fromROBN<std::int32_t>(toROBN(std::uint16_t(60000))) == 60000);
+    BOOST_CHECK(fromROBN<double>(toROBN(1.5f)) == 1.5);
+    BOOST_CHECK(fromROBN<float>(toROBN(std::int32_t(7))) == 7.0f);
+    BOOST_CHECK(fromROBN<std::uint8_t>(toROBN(true)) == 1);
+    BOOST_CHECK_THROW(fromROBN<std::int32_t>(toROBN(std::string("7"))), RogueLib::Exceptions::InvalidArgument);
+}
+
+BOOST_AUTO_TEST_CASE(vectorDecodeInto) {
+    std::vector<float> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.emplace_back(float(i) * 0.5f);
+    }
+    auto bytes = toROBN(values);
+
+    std::vector<float> target;
+    target.reserve(2000);
+    auto* dataPtr = target.data();
+    fromROBNInto(target, bytes);
+    BOOST_CHECK(target == values);
+    BOOST_CHECK(target.data() == dataPtr);
+
+    // decoding again into a vector thats already the right size doesnt touch the allocation either
+    fromROBNInto(target, bytes);
+    BOOST_CHECK(target == values);
+    BOOST_CHECK(target.data() == dataPtr);
+
+    // a different element type on the wire gets cast, widened or not
+    std::vector<double> widened;
+    fromROBNInto(widened, bytes);
+    BOOST_CHECK(widened.size() == values.size());
+    BOOST_CHECK(widened[999] == 499.5);
+    std::vector<std::int16_t> shorts{-3, 0, 300};
+    std::vector<std::int64_t> longs(10, 7);
+    fromROBNInto(longs, toROBN(shorts));
+    BOOST_CHECK((longs == std::vector<std::int64_t>{-3, 0, 300}));
+    BOOST_CHECK((fromROBN<std::vector<std::int64_t>>(toROBN(shorts)) == std::vector<std::int64_t>{-3, 0, 300}));
+    std::vector<bool> flags{true, false, true};
+    std::vector<std::uint8_t> flagBytes;
+    fromROBNInto(flagBytes, toROBN(flags));
+    BOOST_CHECK((flagBytes == std::vector<std::uint8_t>{1, 0, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(stringVectorDecodeInto) {
+    std::vector<std::string> strings{"a string long enough to not fit in the small string buffer",
+                                     "another string long enough to not fit in the small string buffer"};
+    auto bytes = toROBN(strings);
+    BOOST_CHECK(fromROBN<std::vector<std::string>>(bytes) == strings);
+
+    std::vector<std::string> target;
+    fromROBNInto(target, bytes);
+    BOOST_CHECK(target == strings);
+    auto* firstPtr = target[0].data();
+    auto* secondPtr = target[1].data();
+
+    fromROBNInto(target, bytes);
+    BOOST_CHECK(target == strings);
+    BOOST_CHECK(target[0].data() == firstPtr);
+    BOOST_CHECK(target[1].data() == secondPtr);
+}
+
+BOOST_AUTO_TEST_CASE(mapDecodeInto) {
+    std::map<std::int32_t, std::vector<std::int64_t>> map;
+    for (std::int32_t i = 0; i < 16; ++i) {
+        map[i] = std::vector<std::int64_t>(std::size_t(i + 1), i);
+    }
+    auto bytes = toROBN(map);
+
+    std::map<std::int32_t, std::vector<std::int64_t>> target;
+    fromROBNInto(target, bytes);
+    BOOST_CHECK(target == map);
+
+    std::vector<const std::vector<std::int64_t>*> nodePtrs;
+    for (const auto& item : target) {
+        nodePtrs.emplace_back(&item.second);
+    }
+
+    map.erase(15);
+    map[3][0] = 42;
+    bytes = toROBN(map);
+    fromROBNInto(target, bytes);
+    BOOST_CHECK(target == map);
+    // nodes are reused in order, so everything that was left should still be where it was
+    std::size_t i = 0;
+    for (const auto& item : target) {
+        BOOST_CHECK(&item.second == nodePtrs[i++]);
+    }
+}
+
+class DecodeIntoTestObject : public AutoSerializable {
+public:
+    std::int32_t ROGUELIB_ROBN_SERIALIZABLE(id);
+    std::string ROGUELIB_ROBN_SERIALIZABLE(name);
+    std::vector<double> ROGUELIB_ROBN_SERIALIZABLE(values);
+};
+
+class DecodeIntoTestObjectSubset : public AutoSerializable {
+public:
+    std::string ROGUELIB_ROBN_SERIALIZABLE(name);
+};
+
+BOOST_AUTO_TEST_CASE(autoSerializableDecodeInto) {
+    DecodeIntoTestObject source;
+    source.id = 17;
+    source.name = "a name long enough to not fit in the small string buffer";
+    source.values = {1.0, 2.0, 3.0};
+    auto bytes = source.toROBN();
+
+    DecodeIntoTestObject target;
+    target.values.reserve(16);
+    auto* valuesPtr = target.values.data();
+    auto* start = bytes.data() + 1;
+    target.fromROBN(start, bytes.data() + bytes.size(), static_cast<Type>(bytes[0]));
+    BOOST_CHECK(start == bytes.data() + bytes.size());
+    BOOST_CHECK(target.id == source.id);
+    BOOST_CHECK(target.name == source.name);
+    BOOST_CHECK(target.values == source.values);
+    BOOST_CHECK(target.values.data() == valuesPtr);
+
+    // extra fields are stepped over
+    DecodeIntoTestObjectSubset subset;
+    start = bytes.data() + 1;
+    subset.fromROBN(start, bytes.data() + bytes.size(), static_cast<Type>(bytes[0]));
+    BOOST_CHECK(start == bytes.data() + bytes.size());
+    BOOST_CHECK(subset.name == source.name);
+}
+
+BOOST_AUTO_TEST_CASE(writerMatchesToROBN) {
+    std::vector<std::string> strings{"one", "two", "three"};
+    std::map<std::string, std::vector<double>> map{{"a", {1.0, 2.0}}, {"b", {}}};
+    std::vector<bool> bools{true, false, true};
+
+    ROBN bytes;
+    appendROBN(bytes, strings);
+    BOOST_CHECK(bytes == toROBN(strings));
+
+    bytes.clear();
+    appendROBN(bytes, map);
+    BOOST_CHECK(bytes == toROBN(map));
+    BOOST_CHECK((fromROBN<std::map<std::string, std::vector<double>>>(bytes) == map));
+
+    bytes.clear();
+    appendROBN(bytes, bools);
+    BOOST_CHECK(fromROBN<std::vector<bool>>(bytes) == bools);
+}
+
+BOOST_AUTO_TEST_CASE(batchRoundTrip) {
+    ROBNBatch batch;
+    std::string longString(300, 'x');
+    std::vector<std::uint8_t> hugeVector(70000, 7);
+
+    batch.append(std::int32_t(42));
+    batch.append(longString);
+    batch.append(hugeVector);
+    batch.appendEncoded(toROBN(std::string("encoded")));
+    BOOST_CHECK(batch.size() == 4);
+    // 1 byte of framing for the int, 2 for the string, 3 for the vector
+    BOOST_CHECK(batch.byteSize() == 1 + 5 + 2 + 302 + 3 + 11 + 70000 + 1 + 9);
+
+    auto iter = batch.begin();
+    BOOST_CHECK((*iter).as<std::int32_t>() == 42);
+    ++iter;
+    BOOST_CHECK((*iter).as<std::string>() == longString);
+    ++iter;
+    std::vector<std::uint8_t> decoded;
+    (*iter).into(decoded);
+    BOOST_CHECK(decoded == hugeVector);
+    ++iter;
+    BOOST_CHECK((*iter).type() == Type::String);
+    BOOST_CHECK((*iter).as<std::string>() == "encoded");
+    ++iter;
+    BOOST_CHECK(iter == batch.end());
+
+    // the buffer is the whole format, so it can be handed back and forth as is
+    ROBNBatch adopted(batch.bytes());
+    BOOST_CHECK(adopted.size() == batch.size());
+    adopted.appendBatch(batch);
+    BOOST_CHECK(adopted.size() == 8);
+    std::size_t count = 0;
+    for (const auto& message : adopted) {
+        BOOST_CHECK(message.size() > 0);
+        count++;
+    }
+    BOOST_CHECK(count == 8);
+
+    auto released = adopted.release();
+    BOOST_CHECK(adopted.empty());
+    BOOST_CHECK(released.size() == batch.byteSize() * 2);
+}
+
+BOOST_AUTO_TEST_CASE(batchRejectsBrokenFraming) {
+    ROBNBatch batch;
+    batch.append(std::string("message"));
+    auto bytes = batch.bytes();
+    bytes.pop_back();
+    BOOST_CHECK_THROW(ROBNBatch{bytes}, RogueLib::Exceptions::InvalidArgument);
+
+    ROBN unterminated(11, Byte{0xFF});
+    BOOST_CHECK_THROW(ROBNBatch{unterminated}, RogueLib::Exceptions::InvalidArgument);
+
+    // ten bytes, but the last one carries bits past 64, without them its a valid length of 5
+    ROBN overflowing(9, Byte{0x80});
+    overflowing[0] = Byte{0x85};
+    overflowing.emplace_back(Byte{0x02});
+    auto message = toROBN(std::uint32_t(1));
+    overflowing.insert(overflowing.end(), message.begin(), message.end());
+    BOOST_CHECK_THROW(ROBNBatch{overflowing}, RogueLib::Exceptions::InvalidArgument);
+}
+
+BOOST_AUTO_TEST_CASE(segmentedEncode) {
+    std::map<std::string, std::vector<float>> map;
+    map["large"] = std::vector<float>(100000, 1.5f);
+    map["small"] = {1.0f, 2.0f};
+
+    auto segments = toROBNSegments(map);
+    BOOST_CHECK(segments.flatten() == toROBN(map));
+    BOOST_CHECK(segments.size() == toROBN(map).size());
+    // headers, the large payload, then everything after it
+    BOOST_CHECK(segments.segmentCount() == 3);
+    BOOST_CHECK(segments.ownedSize() < 100);
+
+    auto vecs = segments.iovecs();
+    BOOST_CHECK(vecs.size() == 3);
+    BOOST_CHECK(vecs[1].iov_base == map["large"].data());
+    BOOST_CHECK(vecs[1].iov_len == map["large"].size() * sizeof(float));
+
+    std::size_t total = 0;
+    for (const auto& vec : vecs) {
+        total += vec.iov_len;
+    }
+    BOOST_CHECK(total == segments.size());
+}
+
+class SegmentTestObject : public AutoSerializable {
+public:
+    std::int32_t ROGUELIB_ROBN_SERIALIZABLE(id);
+    std::vector<float> ROGUELIB_ROBN_SERIALIZABLE(weights);
+};
+
+enum class SegmentTestEnum : std::uint64_t {
+    FIRST = 1,
+    SECOND = 0x0102030405060708,
+};
+
+BOOST_AUTO_TEST_CASE(segmentedSerializable) {
+    // a struct's large members are referenced the same as they would be on their own
+    SegmentTestObject object;
+    object.id = 3;
+    object.weights.assign(1000000, 0.5f);
+    auto segments = toROBNSegments(object);
+    BOOST_CHECK(segments.flatten() == object.toROBN());
+    BOOST_CHECK(segments.ownedSize() < 100);
+    auto vecs = segments.iovecs();
+    BOOST_CHECK(std::count_if(vecs.begin(), vecs.end(), [&](const iovec& vec) {
+        return vec.iov_base == object.weights.data();
+    }) == 1);
+
+    // and without their type header, as every element of a collection after the first
+    std::array<SegmentTestObject, 2> objects;
+    for (auto& element : objects) {
+        element.id = 4;
+        element.weights.assign(10000, 1.5f);
+    }
+    auto arraySegments = toROBNSegments(objects);
+    BOOST_CHECK(arraySegments.flatten() == toROBN(objects));
+    BOOST_CHECK(arraySegments.ownedSize() < 200);
+    std::array<SegmentTestObject, 2> decoded;
+    fromROBNInto(decoded, arraySegments.flatten());
+    BOOST_CHECK(decoded[1].weights == objects[1].weights);
+
+    // enum elements are converted to a temporary, which has to be copied, not referenced
+    std::array<SegmentTestEnum, 3> enums{SegmentTestEnum::FIRST, SegmentTestEnum::SECOND, SegmentTestEnum::SECOND};
+    auto enumSegments = toROBNSegments(enums, 1);
+    BOOST_CHECK(enumSegments.flatten() == toROBN(enums));
+}
+
+BOOST_AUTO_TEST_CASE(objectKeys) {
+    ROBNObject small;
+    small = std::int64_t(42);
+    BOOST_CHECK(small.as<std::int64_t>() == 42);
+
+    // bigger than the inline storage
+    ROBNObject large;
+    large = std::string(100, 'a');
+    BOOST_CHECK(large.as<std::string>() == std::string(100, 'a'));
+
+    ROBNObject copy = large;
+    BOOST_CHECK(copy == large);
+    BOOST_CHECK(copy.hash() == large.hash());
+    ROBNObject moved = std::move(copy);
+    BOOST_CHECK(moved == large);
+
+    // smaller first, then bytewise
+    ROBNObject other;
+    other = std::int64_t(43);
+    BOOST_CHECK(small < other);
+    BOOST_CHECK(small < large);
+    BOOST_CHECK(small != other);
+    BOOST_CHECK(small.hash() != other.hash());
+
+    std::unordered_set<ROBNObject> set;
+    for (std::int64_t i = 0; i < 1000; ++i) {
+        ROBNObject key;
+        key = i;
+        set.insert(key);
+    }
+    set.insert(small);
+    BOOST_CHECK(set.size() == 1000);
+    BOOST_CHECK(set.count(large) == 0);
+
+    std::map<ROBNObject, std::string> map;
+    map[small] = "small";
+    map[large] = "large";
+    auto decoded = fromROBN<std::map<ROBNObject, std::string>>(toROBN(map));
+    BOOST_CHECK(decoded == map);
+}
+
+BOOST_AUTO_TEST_CASE(documentEditing) {
+    std::map<std::string, std::vector<std::int32_t>> map;
+    map["a"] = {1, 2, 3};
+    map["b"] = {4, 5};
+    map["c"] = {};
+
+    ROBNDocument document(toROBN(map));
+    BOOST_CHECK(document->type() == Type::Map);
+    BOOST_CHECK(document->size() == 3);
+    BOOST_CHECK(document->at("b").as<std::vector<std::int32_t>>() == map["b"]);
+    BOOST_CHECK(document->at("a")[2].as<std::int32_t>() == 3);
+    BOOST_CHECK(document->find("d") == nullptr);
+    BOOST_CHECK_THROW(document->at("d"), RogueLib::Exceptions::InvalidArgument);
+
+    // nothing changed, so its the same bytes
+    BOOST_CHECK(document.encode() == toROBN(map));
+
+    document->at("a")[1].set(std::int32_t(20));
+    document->at("c").pushBack(std::int32_t(7));
+    document->erase("b");
+    document->insert("d", std::vector<std::int32_t>{8, 9});
+    BOOST_CHECK_THROW(document->at("a").pushBack(std::string("nope")), RogueLib::Exceptions::InvalidArgument);
+
+    map["a"][1] = 20;
+    map["c"].push_back(7);
+    map.erase("b");
+    map["d"] = {8, 9};
+    BOOST_CHECK((document->as<std::map<std::string, std::vector<std::int32_t>>>() == map));
+    BOOST_CHECK(fromROBN<decltype(map)>(document.encode()) == map);
+
+    // a child can change type, as long as its not in a vector
+    document->at("d").set(std::string("string now"));
+    ROBNDocument reparsed(document.encode());
+    BOOST_CHECK(reparsed->at("d").as<std::string>() == "string now");
+    BOOST_CHECK(reparsed->at("d").type() == Type::String);
+
+    ROBN broken = toROBN(map);
+    broken.pop_back();
+    BOOST_CHECK_THROW(ROBNDocument{broken}, RogueLib::Exceptions::InvalidArgument);
+}
+
+BOOST_AUTO_TEST_CASE(documentStableChildren) {
+    ROBNDocument vectorDocument(toROBN(std::vector<std::int32_t>{1, 2, 3}));
+    auto& first = vectorDocument.root()[0];
+    auto& last = vectorDocument.root()[2];
+    // enough to grow the child array more than once
+    for (std::int32_t i = 4; i < 20; ++i) {
+        vectorDocument->pushBack(i);
+    }
+    first.set(std::int32_t(99));
+    last.set(std::int32_t(30));
+    vectorDocument->eraseIndex(1);
+    last.set(std::int32_t(31));
+    std::vector<std::int32_t> expected{99, 31};
+    for (std::int32_t i = 4; i < 20; ++i) {
+        expected.push_back(i);
+    }
+    BOOST_CHECK(vectorDocument->as<std::vector<std::int32_t>>() == expected);
+
+    std::int32_t sum = 0;
+    for (auto& element : vectorDocument.root()) {
+        sum += element.as<std::int32_t>();
+    }
+    BOOST_CHECK(sum == 99 + 31 + 184);
+
+    std::map<std::string, std::int32_t> map{{"a", 1}, {"b", 2}};
+    ROBNDocument mapDocument(toROBN(map));
+    auto& a = mapDocument->at("a");
+    auto& b = mapDocument->at("b");
+    mapDocument->insert("c", std::int32_t(3));
+    mapDocument->insert("d", std::int32_t(4));
+    mapDocument->erase("a");
+    b.set(std::int32_t(20));
+    // a is out of the map, setting it doesnt bring it back
+    a.set(std::int32_t(10));
+    std::map<std::string, std::int32_t> expectedMap{{"b", 20}, {"c", 3}, {"d", 4}};
+    BOOST_CHECK((mapDocument->as<std::map<std::string, std::int32_t>>() == expectedMap));
+}
+
+BOOST_AUTO_TEST_CASE(checksummedFrames) {
+    // the standard CRC32C check value
+    BOOST_CHECK(crc32c("123456789", 9) == 0xE3069283u);
+    // continuing a checksum gives the same answer as doing it all at once
+    BOOST_CHECK(crc32c("56789", 5, crc32c("1234", 4)) == 0xE3069283u);
+
+    std::map<std::string, std::vector<double>> map;
+    map["x"] = std::vector<double>(1000, 2.5);
+    map["y"] = {1.0};
+
+    auto framed = toChecksummedROBN(map);
+    BOOST_CHECK(static_cast<Type>(framed[0]) == Type::Checksummed);
+    BOOST_CHECK(fromChecksummedROBN<decltype(map)>(framed) == map);
+
+    decltype(map) into;
+    fromChecksummedROBNInto(into, framed);
+    BOOST_CHECK(into == map);
+
+    // the checksum covers the whole payload
+    auto corrupted = framed;
+    corrupted[framed.size() / 2] ^= Byte{0x10};
+    BOOST_CHECK_THROW(fromChecksummedROBN<decltype(map)>(corrupted), RogueLib::Exceptions::InvalidArgument);
+
+    // frames can be skipped like any other element
+    auto* ptr = framed.data() + 1;
+    skipROBN(ptr, framed.data() + framed.size(), Type::Checksummed);
+    BOOST_CHECK(ptr == framed.data() + framed.size());
+}
+
+class DeltaTestObject : public AutoSerializable {
+public:
+    std::int32_t ROGUELIB_ROBN_SERIALIZABLE(tick);
+    std::vector<double> ROGUELIB_ROBN_SERIALIZABLE(positions);
+    // no ==, so it gets compared by its encoding
+    DecodeIntoTestObjectSubset ROGUELIB_ROBN_SERIALIZABLE(nested);
+};
+
+typedef std::map<std::string, std::int32_t> DeltaFields;
+
+BOOST_AUTO_TEST_CASE(autoSerializableDelta) {
+    DeltaTestObject source;
+    source.tick = 1;
+    source.positions = std::vector<double>(100, 1.0);
+    source.nested.name = "nested";
+
+    DeltaTestObject target;
+    // nothing snapshotted yet, so the first delta is everything
+    target.applyDelta(source.toROBNDelta());
+    BOOST_CHECK(target.tick == 1);
+    BOOST_CHECK(target.positions == source.positions);
+    BOOST_CHECK(target.nested.name == "nested");
+
+    BOOST_CHECK(fromROBN<DeltaFields>(source.toROBNDelta()).empty());
+
+    source.tick = 2;
+    auto delta = source.toROBNDelta();
+    auto deltaFields = fromROBN<DeltaFields>(delta);
+    BOOST_CHECK(deltaFields.size() == 1);
+    BOOST_CHECK(deltaFields["tick"] == 2);
+    BOOST_CHECK(delta.size() < source.toROBN().size() / 10);
+    target.applyDelta(delta);
+    BOOST_CHECK(target.tick == 2);
+    BOOST_CHECK(target.positions == source.positions);
+
+    source.nested.name = "changed";
+    source.markDirty("tick");
+    target.applyDelta(source.toROBNDelta());
+    BOOST_CHECK(target.nested.name == "changed");
+    BOOST_CHECK(fromROBN<DeltaFields>(source.toROBNDelta()).empty());
+
+    // applied fields are snapshotted on the receiving side too
+    BOOST_CHECK(fromROBN<DeltaFields>(target.toROBNDelta()).empty());
+    BOOST_CHECK_THROW(source.markDirty("missing"), RogueLib::Exceptions::InvalidArgument);
+}
+
+BOOST_AUTO_TEST_CASE(ndArrayEncode) {
+    std::vector<std::vector<double>> rows(100, std::vector<double>(16));
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        for (std::size_t j = 0; j < rows[i].size(); ++j) {
+            rows[i][j] = double(i * 16 + j);
+        }
+    }
+    auto array = NDArray<double>::fromNested(rows);
+    BOOST_CHECK(array.rank() == 2);
+    BOOST_CHECK(array(3, 5) == 3 * 16 + 5);
+    BOOST_CHECK(array.view().slice(3)(5) == 3 * 16 + 5);
+    BOOST_CHECK(array.toNested() == rows);
+
+    auto bytes = toROBN(array);
+    // one header for the whole thing, not one per row
+    BOOST_CHECK(bytes.size() < toROBN(rows).size());
+    BOOST_CHECK(bytes.size() == 1 + 11 + 2 * 8 + 1 + 100 * 16 * sizeof(double));
+    BOOST_CHECK(fromROBN<NDArray<double>>(bytes) == array);
+
+    // into an existing array, and into storage something else owns
+    NDArray<double> into({1, 1});
+    fromROBNInto(into, bytes);
+    BOOST_CHECK(into == array);
+    std::vector<double> storage(2000);
+    std::vector<std::uint64_t> shape;
+    auto* ptr = bytes.data();
+    BOOST_CHECK(decodeNDArray(ptr, bytes.data() + bytes.size(), storage.data(), storage.size(), shape) == 1600);
+    BOOST_CHECK((shape == std::vector<std::uint64_t>{100, 16}));
+    BOOST_CHECK(storage[1599] == 1599);
+    ptr = bytes.data();
+    BOOST_CHECK_THROW(decodeNDArray(ptr, bytes.data() + bytes.size(), storage.data(), 100, shape),
+                      RogueLib::Exceptions::InvalidArgument);
+
+    // elements get cast if the type is different
+    auto floats = fromROBN<NDArray<float>>(bytes);
+    BOOST_CHECK(floats(99, 15) == 1599.0f);
+
+    ptr = bytes.data() + 1;
+    skipROBN(ptr, bytes.data() + bytes.size(), Type::NDArray);
+    BOOST_CHECK(ptr == bytes.data() + bytes.size());
+
+    ROBN truncated(bytes.begin(), bytes.end() - 1);
+    BOOST_CHECK_THROW(fromROBN<NDArray<double>>(truncated), RogueLib::Exceptions::InvalidArgument);
+}
+
+BOOST_AUTO_TEST_CASE(ndArrayEmptyAndScalar) {
+    // default is one dimension with nothing in it, an empty shape is a single scalar
+    NDArray<float> empty;
+    BOOST_CHECK(empty.rank() == 1);
+    BOOST_CHECK(empty.size() == 0);
+    NDArray<float> scalar(std::vector<std::uint64_t>{});
+    BOOST_CHECK(scalar.rank() == 0);
+    BOOST_CHECK(scalar.size() == 1);
+    scalar.data()[0] = 2.5f;
+    NDArray<float> noRows(std::vector<std::uint64_t>{0, 4});
+    BOOST_CHECK(noRows.size() == 0);
+    empty.reshape({});
+    BOOST_CHECK(empty.size() == 1);
+    empty = NDArray<float>();
+
+    for (const auto& array : {empty, scalar, noRows}) {
+        BOOST_CHECK(fromROBN<NDArray<float>>(toROBN(array)) == array);
+        NDArray<float> into(std::vector<std::uint64_t>{3, 3});
+        fromROBNInto(into, toROBN(array));
+        BOOST_CHECK(into == array);
+    }
+
+    // none of them eat into the element after them
+    std::vector<NDArray<float>> arrays{empty, scalar, noRows, empty};
+    arrays[0] = NDArray<float>::fromNested({{1.0f, 2.0f}});
+    auto decoded = fromROBN<std::vector<NDArray<float>>>(toROBN(arrays));
+    BOOST_CHECK(decoded == arrays);
+    std::vector<NDArray<float>> decodedInto;
+    fromROBNInto(decodedInto, toROBN(arrays));
+    BOOST_CHECK(decodedInto == arrays);
+}
+
+BOOST_AUTO_TEST_CASE(ndArrayNested) {
+    auto array = NDArray<float>::fromNested({{1.0f, 2.0f}, {3.0f, 4.0f}});
+    std::pair<NDArray<float>, float> pair{array, 5.0f};
+    auto decodedPair = fromROBN<std::pair<NDArray<float>, float>>(toROBN(pair));
+    BOOST_CHECK(decodedPair == pair);
+    std::map<std::string, NDArray<float>> map{{"weights", array}, {"empty", NDArray<float>()}};
+    auto decodedMap = fromROBN<std::map<std::string, NDArray<float>>>(toROBN(map));
+    BOOST_CHECK(decodedMap == map);
+}
+
+BOOST_AUTO_TEST_CASE(sparseVectorEncode) {
+    std::vector<float> gradient(10000);
+    gradient[3] = 1.5f;
+    gradient[4000] = -2.0f;
+    gradient[9999] = -0.0f;
+
+    // picked automatically, long enough and mostly zeros
+    auto bytes = toROBN(gradient);
+    BOOST_CHECK(static_cast<Type>(bytes[0]) == Type::SparseVector);
+    BOOST_CHECK(bytes.size() < 100);
+    auto decoded = fromROBN<std::vector<float>>(bytes);
+    BOOST_CHECK(decoded == gradient);
+    // zero is all bits zero, so the sign of -0.0 survives
+    BOOST_CHECK(std::signbit(decoded[9999]));
+
+    std::vector<float> into(5, 7.0f);
+    fromROBNInto(into, bytes);
+    BOOST_CHECK(into == gradient);
+
+    // and cast like any other vector
+    BOOST_CHECK(fromROBN<std::vector<double>>(bytes)[4000] == -2.0);
+
+    auto sparse = fromROBN<SparseVector<float>>(bytes);
+    BOOST_CHECK(sparse.size() == gradient.size());
+    BOOST_CHECK(sparse.nonZeroCount() == 3);
+    BOOST_CHECK(sparse.indices()[1] == 4000);
+    BOOST_CHECK(sparse.toDense() == gradient);
+    BOOST_CHECK(toROBN(sparse) == bytes);
+    BOOST_CHECK(sparse == SparseVector<float>::fromDense(gradient));
+
+    // dense data stays a vector, and can still be decoded as sparse
+    std::vector<float> dense(1000, 1.0f);
+    dense[10] = 0;
+    auto denseBytes = toROBN(dense);
+    BOOST_CHECK(static_cast<Type>(denseBytes[0]) == Type::Vector);
+    BOOST_CHECK(fromROBN<SparseVector<float>>(denseBytes).nonZeroCount() == 999);
+
+    // inside a container, the first element sets the type of all of them, so none of them can be sparse
+    std::vector<std::vector<double>> rows(3, std::vector<double>(1000));
+    rows[0][7] = 1.0;
+    rows[2][999] = 2.0;
+    auto rowBytes = toROBN(rows);
+    BOOST_CHECK(fromROBN<std::vector<std::vector<double>>>(rowBytes) == rows);
+    std::vector<std::vector<double>> rowsInto;
+    fromROBNInto(rowsInto, rowBytes);
+    BOOST_CHECK(rowsInto == rows);
+    std::deque<std::vector<double>> rowDeque(rows.begin(), rows.end());
+    BOOST_CHECK(fromROBN<std::deque<std::vector<double>>>(toROBN(rowDeque)) == rowDeque);
+    std::array<std::array<float, 1000>, 2> grid{};
+    grid[0][1] = 3.0f;
+    BOOST_CHECK(fromROBN<decltype(grid)>(toROBN(grid)) == grid);
+    std::vector<std::array<float, 1000>> gridVector(grid.begin(), grid.end());
+    auto gridVectorDecoded = fromROBN<decltype(gridVector)>(toROBN(gridVector));
+    BOOST_CHECK(gridVectorDecoded == gridVector);
+
+    auto* ptr = bytes.data() + 1;
+    skipROBN(ptr, bytes.data() + bytes.size(), Type::SparseVector);
+    BOOST_CHECK(ptr == bytes.data() + bytes.size());
+
+    // an index past the end is rejected, not written out of bounds
+    auto broken = bytes;
+    // length element, count element, index type header, then the first uInt16 index
+    std::uint16_t badIndex = 60000;
+    std::memcpy(broken.data() + 1 + 9 + 9 + 1, &badIndex, 2);
+    BOOST_CHECK_THROW(fromROBN<std::vector<float>>(broken), RogueLib::Exceptions::InvalidArgument);
+}
+
+BOOST_AUTO_TEST_CASE(decodeLimits) {
+    // a vector that claims 2^60 doubles in a 20 byte blob, rejected before anything is allocated
+    auto huge = toROBN(std::vector<double>{1.0});
+    std::uint64_t hugeLength = 1ull << 60u;
+    std::memcpy(huge.data() + 2, &hugeLength, 8);
+    BOOST_CHECK_THROW(fromROBN<std::vector<double>>(huge), RogueLib::Exceptions::InvalidArgument);
+    std::vector<double> hugeInto;
+    BOOST_CHECK_THROW(fromROBNInto(hugeInto, huge), RogueLib::Exceptions::InvalidArgument);
+
+    // a string without its terminator
+    auto unterminated = toROBN(std::string("abc"));
+    unterminated.pop_back();
+    BOOST_CHECK_THROW(fromROBN<std::string>(unterminated), RogueLib::Exceptions::InvalidArgument);
+
+    std::vector<std::vector<std::vector<int>>> nested{{{1, 2}, {3}}};
+    auto nestedBytes = toROBN(nested);
+    std::string longString(100, 'a');
+    auto stringBytes = toROBN(longString);
+    auto sparseBytes = toROBN(SparseVector<float>::fromDense(std::vector<float>(100000)));
+    {
+        DecodeLimits limits;
+        // the innermost vector<int> cant nest any further, so it doesnt count
+        limits.maxDepth = 1;
+        limits.maxStringLength = 64;
+        limits.maxTotalBytes = 1024;
+        DecodeLimitScope scope(limits);
+        BOOST_CHECK_THROW(fromROBN<decltype(nested)>(nestedBytes), RogueLib::Exceptions::InvalidArgument);
+        BOOST_CHECK_THROW(fromROBN<std::string>(stringBytes), RogueLib::Exceptions::InvalidArgument);
+        // a few bytes on the wire, 400KB once decoded
+        BOOST_CHECK_THROW(fromROBN<std::vector<float>>(sparseBytes), RogueLib::Exceptions::InvalidArgument);
+        auto used = scope.bytesUsed();
+        BOOST_CHECK(fromROBN<std::vector<int>>(toROBN(std::vector<int>{1, 2, 3})).size() == 3);
+        BOOST_CHECK(scope.bytesUsed() == used + 3 * sizeof(int));
+    }
+    // and the limits are gone again
+    BOOST_CHECK(fromROBN<decltype(nested)>(nestedBytes) == nested);
+    BOOST_CHECK(fromROBN<std::string>(stringBytes) == longString);
+}
+
+BOOST_AUTO_TEST_CASE(canonicalForm) {
+    // a big endian uInt32, and a vector with a uInt8 length, both come out the way a little endian host writes them
+    ROBN bigEndian{Byte(Type::uInt32) | Byte(Endianness::BIG), Byte{0}, Byte{0}, Byte{1}, Byte{2}};
+    BOOST_CHECK(canonicalizeROBN(bigEndian) == toROBN(std::uint32_t(0x0102)));
+    ROBN shortLength{Byte{Type::Vector}, Byte{Type::uInt8}, Byte{2}, Byte{Type::uInt16}, Byte{1}, Byte{0}, Byte{2},
+                     Byte{0}};
+    BOOST_CHECK(canonicalizeROBN(shortLength) == toROBN(std::vector<std::uint16_t>{1, 2}));
+    BOOST_CHECK(contentHashROBN(bigEndian) == contentHash(std::uint32_t(0x0102)));
+
+    // same entries, different order on the wire
+    std::map<std::int32_t, std::string> ascending{{-1, "a"}, {2, "b"}, {300, "c"}};
+    ROBN descending;
+    ROBNWriter writer(descending);
+    Byte mapType{Type::Map};
+    writer.write(&mapType, 1);
+    writeLengthROBN(writer, ascending.size());
+    for (auto iter = ascending.rbegin(); iter != ascending.rend(); ++iter) {
+        writeROBN(writer, std::pair<std::int32_t, std::string>(*iter));
+    }
+    BOOST_CHECK(fromROBN<decltype(ascending)>(descending) == ascending);
+    BOOST_CHECK(toROBN(ascending) != descending);
+    BOOST_CHECK(canonicalizeROBN(descending) == toCanonicalROBN(ascending));
+    BOOST_CHECK(contentHashROBN(descending) == contentHash(ascending));
+    // -1 is 0xFFFFFFFF, so its last in byte order, but still decodes to the same map
+    BOOST_CHECK(fromROBN<decltype(ascending)>(canonicalizeROBN(descending)) == ascending);
+
+    // a repeated key has no canonical form, even when the two copies are encoded differently
+    ROBN duplicated;
+    ROBNWriter duplicateWriter(duplicated);
+    duplicateWriter.write(&mapType, 1);
+    writeLengthROBN(duplicateWriter, 2);
+    writeROBN(duplicateWriter, std::pair<std::int32_t, std::string>(2, "a"));
+    writeROBN(duplicateWriter, std::pair<std::int32_t, std::string>(2, "b"));
+    BOOST_CHECK_THROW(canonicalizeROBN(duplicated), RogueLib::Exceptions::InvalidArgument);
+    ROBN swappedDuplicate;
+    ROBNWriter swappedWriter(swappedDuplicate);
+    swappedWriter.write(&mapType, 1);
+    writeLengthROBN(swappedWriter, 2);
+    writeROBN(swappedWriter, std::pair<std::uint32_t, std::string>(0x0102, "a"));
+    Byte pairType{Type::Pair};
+    swappedWriter.write(&pairType, 1);
+    swappedWriter.write(bigEndian.data(), bigEndian.size());
+    writeROBN(swappedWriter, std::string("b"));
+    BOOST_CHECK_THROW(canonicalizeROBN(swappedDuplicate), RogueLib::Exceptions::InvalidArgument);
+
+    // sparse and dense are the same value, whichever one was sent
+    std::vector<float> dense(1000);
+    dense[10] = 1.0f;
+    auto sparse = SparseVector<float>::fromDense(dense);
+    std::vector<float> small(10);
+    small[3] = 2.0f;
+    BOOST_CHECK(toCanonicalROBN(sparse) == toCanonicalROBN(dense));
+    BOOST_CHECK(toCanonicalROBN(SparseVector<float>::fromDense(small)) == toCanonicalROBN(small));
+    BOOST_CHECK(fromROBN<std::vector<float>>(toCanonicalROBN(SparseVector<float>::fromDense(small))) == small);
+
+    // the hash is of exactly the canonical bytes, however theyre split up
+    ContentHash hash;
+    auto canonical = toCanonicalROBN(ascending, hash);
+    ROBNHasher hasher;
+    hasher.write(canonical.data(), 5);
+    hasher.write(canonical.data() + 5, canonical.size() - 5);
+    BOOST_CHECK(hasher.digest() == hash);
+    BOOST_CHECK(hash == contentHash(ascending));
+    ascending[2] = "c";
+    BOOST_CHECK(contentHash(ascending) != hash);
+
+    std::vector<double> longVector(10000, 1.5);
+    ROBNHasher pieces;
+    auto longBytes = toROBN(longVector);
+    for (std::size_t i = 0; i < longBytes.size(); i += 100) {
+        pieces.write(longBytes.data() + i, std::min<std::size_t>(100, longBytes.size() - i));
+    }
+    BOOST_CHECK(pieces.digest() == contentHash(longVector));
+
+    // the encoder already writes NDArrays canonically on a little endian host, empty shapes included
+    NDArray<double> scalar(std::vector<std::uint64_t>{});
+    scalar.data()[0] = 4.0;
+    NDArray<double> grid(std::vector<std::uint64_t>{2, 3});
+    for (const auto& array : {NDArray<double>(), scalar, grid}) {
+        BOOST_CHECK(toCanonicalROBN(array) == toROBN(array));
+        BOOST_CHECK(canonicalizeROBN(toROBN(array)) == toROBN(array));
+        BOOST_CHECK(fromROBN<NDArray<double>>(toCanonicalROBN(array)) == array);
+    }
+}
+
+class PingEvent : public AutoSerializable {
+public:
+    std::uint64_t ROGUELIB_ROBN_SERIALIZABLE(sequence);
+};
+
+class ChatEvent : public AutoSerializable {
+public:
+    std::string ROGUELIB_ROBN_SERIALIZABLE(user);
+    std::string ROGUELIB_ROBN_SERIALIZABLE(text);
+};
+
+class UnregisteredEvent : public AutoSerializable {
+public:
+    std::int32_t ROGUELIB_ROBN_SERIALIZABLE(value);
+};
+
+typedef std::vector<std::shared_ptr<Serializable>> EventList;
+
+BOOST_AUTO_TEST_CASE(polymorphicSerializables) {
+    registerSerializable<PingEvent>(1);
+    registerSerializable<ChatEvent>(300);
+    // same type and tag again is fine, a different tag for it isnt
+    registerSerializable<PingEvent>(1);
+    BOOST_CHECK_THROW(registerSerializable<PingEvent>(2), RogueLib::Exceptions::InvalidArgument);
+    BOOST_CHECK_THROW(registerSerializable<UnregisteredEvent>(1), RogueLib::Exceptions::InvalidArgument);
+
+    auto ping = std::make_shared<PingEvent>();
+    ping->sequence = 42;
+    auto chat = std::make_shared<ChatEvent>();
+    chat->user = "someone";
+    chat->text = "hello";
+    EventList events{ping, chat, nullptr};
+
+    auto bytes = toROBN(events);
+    auto decoded = fromROBN<EventList>(bytes);
+    BOOST_REQUIRE(decoded.size() == 3);
+    auto decodedPing = std::dynamic_pointer_cast<PingEvent>(decoded[0]);
+    auto decodedChat = std::dynamic_pointer_cast<ChatEvent>(decoded[1]);
+    BOOST_REQUIRE(decodedPing && decodedChat);
+    BOOST_CHECK(decodedPing->sequence == 42);
+    BOOST_CHECK(decodedChat->user == "someone" && decodedChat->text == "hello");
+    BOOST_CHECK(decoded[2] == nullptr);
+
+    // a single pointer, typed as the subclass
+    auto single = fromROBN<std::shared_ptr<ChatEvent>>(toROBN(std::shared_ptr<Serializable>(chat)));
+    BOOST_CHECK(single->text == "hello");
+    BOOST_CHECK_THROW(fromROBN<std::shared_ptr<PingEvent>>(toROBN(std::shared_ptr<Serializable>(chat))),
+                      RogueLib::Exceptions::InvalidArgument);
+
+    BOOST_CHECK(contentHashROBN(bytes) == contentHash(events));
+
+    // decoding into the same types reuses the objects, as long as nothing else has them
+    decodedPing.reset();
+    auto* firstObject = decoded[0].get();
+    ping->sequence = 43;
+    fromROBNInto(decoded, bytes);
+    BOOST_CHECK(decoded[0].get() == firstObject);
+    BOOST_CHECK(std::dynamic_pointer_cast<PingEvent>(decoded[0])->sequence == 42);
+
+    BOOST_CHECK_THROW(toROBN(EventList{std::make_shared<UnregisteredEvent>()}),
+                      RogueLib::Exceptions::InvalidArgument);
+    // an unknown tag
+    auto unknown = toROBN(std::shared_ptr<Serializable>(ping));
+    unknown[2] = Byte{77};
+    BOOST_CHECK_THROW(fromROBN<std::shared_ptr<Serializable>>(unknown), RogueLib::Exceptions::InvalidArgument);
+
+    auto* ptr = bytes.data() + 1;
+    skipROBN(ptr, bytes.data() + bytes.size(), Type::Vector);
+    BOOST_CHECK(ptr == bytes.data() + bytes.size());
+}
+
+BOOST_AUTO_TEST_CASE(extendedTypes) {
+    // Int128 vectors, native is one copy, the other endianness gets swapped
+    std::vector<__int128> wide{0, -1, (__int128) 1 << 100, -((__int128) 3 << 90)};
+    auto wideBytes = toROBN(wide);
+    BOOST_CHECK(fromROBN<decltype(wide)>(wideBytes) == wide);
+    auto flipped = wideBytes;
+    // vector type, length element, element type, then 16 bytes each
+    flipped[10] ^= Byte(Endianness::BIG);
+    for (std::size_t i = 0; i < wide.size(); ++i) {
+        std::reverse(flipped.begin() + 11 + i * 16, flipped.begin() + 27 + i * 16);
+    }
+    BOOST_CHECK(fromROBN<decltype(wide)>(flipped) == wide);
+    BOOST_CHECK(canonicalizeROBN(flipped) == toCanonicalROBN(wide));
+
+    // long double is binary128 on the wire, whatever it is here
+    std::vector<long double> precise{0.0L, 1.0L / 3, -1e4000L, std::numeric_limits<long double>::denorm_min(),
+                                     std::numeric_limits<long double>::max(),
+                                     std::numeric_limits<long double>::infinity()};
+    BOOST_CHECK(fromROBN<decltype(precise)>(toROBN(precise)) == precise);
+    BOOST_CHECK(fromROBN<long double>(toROBN(1.0L / 3)) == 1.0L / 3);
+    BOOST_CHECK(toROBN(1.0L).size() == 17);
+    auto one = toCanonicalROBN(1.0L);
+    BOOST_CHECK(one[16] == Byte{0x3F} && one[15] == Byte{0xFF} && one[14] == Byte{0});
+    BOOST_CHECK(std::isnan(fromROBN<long double>(toROBN(std::numeric_limits<long double>::quiet_NaN()))));
+    BOOST_CHECK(fromROBN<double>(toROBN(1.5L)) == 1.5);
+    BOOST_CHECK(fromROBN<long double>(toROBN(1.5)) == 1.5L);
+    std::vector<long double> reused;
+    fromROBNInto(reused, toROBN(precise));
+    BOOST_CHECK(reused == precise);
+
+    auto big = BigInt::fromString("-123456789012345678901234567890123456789012345678901234567890");
+    BOOST_CHECK(big.toString() == "-123456789012345678901234567890123456789012345678901234567890");
+    BOOST_CHECK(BigInt::fromString("10000000000000000000000000000000000000").toString() ==
+                "10000000000000000000000000000000000000");
+    BOOST_CHECK(BigInt().toString() == "0");
+    BOOST_CHECK_THROW(BigInt::fromString("12a"), RogueLib::Exceptions::InvalidArgument);
+    BOOST_CHECK(fromROBN<BigInt>(toROBN(big)) == big);
+    BOOST_CHECK(BigInt(INT64_MIN).as<std::int64_t>() == INT64_MIN);
+    auto int128Max = (__int128) (((unsigned __int128) 1 << 127u) - 1);
+    auto int128Min = -int128Max - 1;
+    BOOST_CHECK(BigInt(int128Min).asInt128() == int128Min);
+    BOOST_CHECK(BigInt(int128Max).asInt128() == int128Max);
+    // a failed conversion doesnt hand back anything
+    std::int64_t narrowed = 0;
+    BOOST_CHECK_THROW(narrowed = big.as<std::int64_t>(), RogueLib::Exceptions::InvalidArgument);
+    BOOST_CHECK(narrowed == 0);
+    std::uint8_t negative = 0;
+    BOOST_CHECK_THROW(negative = BigInt(-1).as<std::uint8_t>(), RogueLib::Exceptions::InvalidArgument);
+    BOOST_CHECK(negative == 0);
+    BOOST_CHECK(big < BigInt(-1) && BigInt(-1) < BigInt(0) && BigInt(1) < BigInt(UINT64_MAX));
+    // integers decode as BigInts too
+    BOOST_CHECK(fromROBN<BigInt>(toROBN(std::int32_t(-5))) == BigInt(-5));
+
+    // a big endian BigInt with a zero limb on top, written by hand
+    ROBN foreign{Byte(Type::BigInt) | Byte(Endianness::BIG), Byte{Type::uInt8}, Byte{2}, Byte{0},
+                 Byte{0}, Byte{0}, Byte{0}, Byte{0}, Byte{0}, Byte{0}, Byte{1}, Byte{2},
+                 Byte{0}, Byte{0}, Byte{0}, Byte{0}, Byte{0}, Byte{0}, Byte{0}, Byte{0}};
+    BOOST_CHECK(fromROBN<BigInt>(foreign) == BigInt(0x0102));
+    BOOST_CHECK(canonicalizeROBN(foreign) == toCanonicalROBN(BigInt(0x0102)));
+    foreign[3] = Byte{2};
+    BOOST_CHECK_THROW(fromROBN<BigInt>(foreign), RogueLib::Exceptions::InvalidArgument);
+
+    // same value, split differently between the mantissa and exponent
+    BigFloat half{BigInt(1), -1};
+    BigFloat alsoHalf{BigInt(4), -3};
+    BOOST_CHECK(half == alsoHalf);
+    BOOST_CHECK(fromROBN<BigFloat>(toROBN(alsoHalf)).exponent == -3);
+    BOOST_CHECK(toCanonicalROBN(half) == toCanonicalROBN(alsoHalf));
+    BOOST_CHECK(contentHash(half) != contentHash(BigFloat{BigInt(1), 1}));
+
+    // normalizing would push the exponent past int64, that throws and leaves the value alone
+    BigFloat edge{BigInt(4), std::numeric_limits<std::int64_t>::max() - 1};
+    BOOST_CHECK_THROW(edge.normalize(), RogueLib::Exceptions::InvalidArgument);
+    BOOST_CHECK(edge.exponent == std::numeric_limits<std::int64_t>::max() - 1);
+    BOOST_CHECK(edge.mantissa == BigInt(4));
+
+    std::vector<BigFloat> floats{half, {big, 1000}, {}};
+    auto floatBytes = toROBN(floats);
+    std::vector<BigFloat> decodedFloats{{BigInt::fromString("99999999999999999999999999999999999999999"), 0}};
+    fromROBNInto(decodedFloats, floatBytes);
+    BOOST_CHECK(decodedFloats == floats);
+    auto* ptr = floatBytes.data() + 1;
+    skipROBN(ptr, floatBytes.data() + floatBytes.size(), Type::Vector);
+    BOOST_CHECK(ptr == floatBytes.data() + floatBytes.size());
+}
+
+BOOST_AUTO_TEST_CASE(stdContainers) {
+    // arrays are vectors on the wire, and fixed size ones know it ahead of time
+    std::array<float, 4> quad{1.0f, 2.0f, 3.0f, 4.0f};
+    auto quadBytes = toROBN(quad);
+    BOOST_CHECK(quadBytes == toROBN(std::vector<float>(quad.begin(), quad.end())));
+    BOOST_CHECK(quadBytes.size() == 1 + typeBinarySize<decltype(quad)>());
+    BOOST_CHECK(fromROBN<decltype(quad)>(quadBytes) == quad);
+    BOOST_CHECK_THROW((fromROBN<std::array<float, 3>>(quadBytes)), RogueLib::Exceptions::InvalidArgument);
+    // a different element type is cast
+    BOOST_CHECK((fromROBN<std::array<double, 4>>(quadBytes)[3] == 4.0));
+    std::array<float, 1000> sparseArray{};
+    sparseArray[7] = 1.0f;
+    BOOST_CHECK(toROBN(sparseArray)[0] == Byte{Type::SparseVector});
+    BOOST_CHECK(fromROBN<decltype(sparseArray)>(toROBN(sparseArray)) == sparseArray);
+    std::array<std::string, 2> names{"a", "b"};
+    BOOST_CHECK(fromROBN<decltype(names)>(toROBN(names)) == names);
+
+    // tuples of numbers are fixed size too
+    std::tuple<std::int32_t, double, std::uint8_t> numbers{-1, 2.5, 3};
+    auto numberBytes = toROBN(numbers);
+    BOOST_CHECK(numberBytes.size() == 1 + typeBinarySize<decltype(numbers)>());
+    BOOST_CHECK(fromROBN<decltype(numbers)>(numberBytes) == numbers);
+    std::tuple<std::string, std::vector<int>, bool> mixed{"text", {1, 2}, true};
+    BOOST_CHECK(!isFixedBinarySize<decltype(mixed)>());
+    BOOST_CHECK(fromROBN<decltype(mixed)>(toROBN(mixed)) == mixed);
+    BOOST_CHECK_THROW((fromROBN<std::tuple<int, int>>(numberBytes)), RogueLib::Exceptions::InvalidArgument);
+    // two element tuples and pairs are interchangeable
+    auto pair = fromROBN<std::pair<int, std::string>>(toROBN(std::tuple<int, std::string>{5, "five"}));
+    BOOST_CHECK(pair.first == 5 && pair.second == "five");
+    BOOST_CHECK((fromROBN<std::tuple<int, std::string>>(toROBN(pair)) == std::tuple<int, std::string>{5, "five"}));
+
+    std::vector<std::optional<std::string>> maybe{"x", std::nullopt, "z"};
+    BOOST_CHECK(fromROBN<decltype(maybe)>(toROBN(maybe)) == maybe);
+    // a plain value is an optional that has one
+    BOOST_CHECK(fromROBN<std::optional<std::uint32_t>>(toROBN(std::uint32_t(7))) == 7u);
+
+    typedef std::variant<std::int32_t, std::string, std::vector<double>> Value;
+    std::vector<Value> values{1, std::string("two"), std::vector<double>{3.0}};
+    auto valueBytes = toROBN(values);
+    BOOST_CHECK(fromROBN<decltype(values)>(valueBytes) == values);
+    std::vector<Value> reusedValues{std::string("old"), std::string("old")};
+    fromROBNInto(reusedValues, valueBytes);
+    BOOST_CHECK(reusedValues == values);
+
+    std::unordered_map<std::string, std::int32_t> counts{{"a", 1}, {"b", 2}, {"c", 3}};
+    BOOST_CHECK(fromROBN<decltype(counts)>(toROBN(counts)) == counts);
+    std::map<std::string, std::int32_t> sorted(counts.begin(), counts.end());
+    BOOST_CHECK(fromROBN<decltype(sorted)>(toROBN(counts)) == sorted);
+    BOOST_CHECK(contentHash(counts) == contentHash(sorted));
+    std::unordered_map<std::string, std::int32_t> reusedCounts{{"z", 26}};
+    fromROBNInto(reusedCounts, toROBN(counts));
+    BOOST_CHECK(reusedCounts == counts);
+
+    std::deque<std::uint16_t> queue(600, 3);
+    BOOST_CHECK(fromROBN<decltype(queue)>(toROBN(queue)) == queue);
+    BOOST_CHECK(toROBN(queue) == toROBN(std::vector<std::uint16_t>(queue.begin(), queue.end())));
+    std::set<std::string> unique{"x", "y"};
+    BOOST_CHECK(fromROBN<decltype(unique)>(toROBN(unique)) == unique);
+    std::unordered_set<std::int64_t> hashed{1, 5, 9};
+    BOOST_CHECK(fromROBN<decltype(hashed)>(toROBN(hashed)) == hashed);
+    // any of them can be read as a vector
+    BOOST_CHECK(fromROBN<std::vector<std::string>>(toROBN(unique)) == std::vector<std::string>({"x", "y"}));
+
+    auto everything = toROBN(std::make_tuple(quad, numbers, maybe, values, counts, unique));
+    auto* ptr = everything.data() + 1;
+    skipROBN(ptr, everything.data() + everything.size(), Type::Tuple);
+    BOOST_CHECK(ptr == everything.data() + everything.size());
+    BOOST_CHECK(contentHashROBN(everything) != ContentHash{});
+}
+
+BOOST_AUTO_TEST_CASE(compression) {
+    // repetitive enough to compress, but not trivially
+    std::vector<std::uint32_t> counters(200000);
+    for (std::size_t i = 0; i < counters.size(); ++i) {
+        counters[i] = std::uint32_t(i / 7 % 1000);
+    }
+    auto plain = toROBN(counters);
+    auto compressed = toCompressedROBN(counters);
+    BOOST_CHECK(compressed[0] == Byte{Type::Compressed});
+    BOOST_CHECK(compressed.size() * 3 < plain.size());
+    BOOST_CHECK(fromCompressedROBN<decltype(counters)>(compressed) == counters);
+    auto* ptr = compressed.data();
+    BOOST_CHECK(decompressROBN(ptr, compressed.data() + compressed.size()) == plain);
+    BOOST_CHECK(ptr == compressed.data() + compressed.size());
+
+    // random bytes dont compress, they get stored as they are
+    std::vector<std::uint8_t> noise(100000);
+    std::uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (auto& byte : noise) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        byte = std::uint8_t(state >> 56u);
+    }
+    auto noiseBytes = toCompressedROBN(noise);
+    BOOST_CHECK(noiseBytes.size() < toROBN(noise).size() + 64);
+    BOOST_CHECK(fromCompressedROBN<decltype(noise)>(noiseBytes) == noise);
+    BOOST_CHECK(fromCompressedROBN<decltype(noise)>(toCompressedROBN(noise, Compression::NONE)) == noise);
+
+    // every length around the edges of the format, with short overlapping matches mixed in
+    for (std::size_t size = 0; size < 300; ++size) {
+        std::vector<Byte> source(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            source[i] = Byte(i % 23 < 11 ? std::uint8_t(i % 3) : std::uint8_t(noise[i]));
+        }
+        std::vector<Byte> block(compressBoundLZ(size));
+        block.resize(compressLZ(source.data(), size, block.data()));
+        std::vector<Byte> decompressed(size);
+        decompressLZ(block.data(), block.size(), decompressed.data(), size);
+        BOOST_CHECK(decompressed == source);
+    }
+
+    // small blocks, decompressed in parallel, through anything with an enqueue
+    struct ThreadQueue {
+        std::vector<std::thread> threads;
+
+        void enqueue(std::function<void()> function) {
+            threads.emplace_back(std::move(function));
+        }
+
+        ~ThreadQueue() {
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+    } queue;
+    std::vector<std::string> names;
+    for (int i = 0; i < 5000; ++i) {
+        names.emplace_back("name number " + std::to_string(i));
+    }
+    auto nameBytes = toCompressedROBN(names, Compression::LZ, 1024);
+    BOOST_CHECK(fromCompressedROBN<decltype(names)>(nameBytes, queue) == names);
+    std::vector<std::string> reusedNames{"old"};
+    fromCompressedROBNInto(reusedNames, nameBytes, queue);
+    BOOST_CHECK(reusedNames == names);
+
+    // streaming, straight from the encoder into the compressor
+    ROBN streamed;
+    ROBNWriter streamWriter(streamed);
+    writeCompressedROBN(streamWriter, names, Compression::LZ, 1024);
+    BOOST_CHECK(streamed == nameBytes);
+
+    // its skippable, and compression isnt part of the value
+    auto framed = toROBN(std::make_pair(std::string("before"), std::string("after")));
+    ROBN withCompressed;
+    withCompressed.insert(withCompressed.end(), nameBytes.begin(), nameBytes.end());
+    withCompressed.insert(withCompressed.end(), framed.begin(), framed.end());
+    ptr = withCompressed.data() + 1;
+    skipROBN(ptr, withCompressed.data() + withCompressed.size(), Type::Compressed);
+    auto after = BinaryConversion<std::pair<std::string, std::string>>::fromROBN(ptr, withCompressed.data() +
+                                                                                       withCompressed.size());
+    BOOST_CHECK(after.first == "before" && after.second == "after");
+    BOOST_CHECK(contentHashROBN(nameBytes) == contentHash(names));
+
+    // anything malformed throws, it doesnt read or write out of bounds
+    auto truncated = ROBN(nameBytes.begin(), nameBytes.begin() + std::ptrdiff_t(nameBytes.size() / 2));
+    BOOST_CHECK_THROW(fromCompressedROBN<decltype(names)>(truncated), RogueLib::Exceptions::InvalidArgument);
+    std::vector<Byte> badOffset{Byte(0x14), Byte('a'), Byte(0x05), Byte(0x00), Byte(0x00)};
+    std::vector<Byte> output(8);
+    BOOST_CHECK_THROW(decompressLZ(badOffset.data(), badOffset.size(), output.data(), output.size()),
+                      RogueLib::Exceptions::InvalidArgument);
+    {
+        DecodeLimits limits;
+        limits.maxTotalBytes = 1000;
+        DecodeLimitScope scope(limits);
+        BOOST_CHECK_THROW(fromCompressedROBN<decltype(counters)>(compressed), RogueLib::Exceptions::InvalidArgument);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(json) {
+    std::map<std::string, std::vector<std::int32_t>> simple{{"a", {1, -2}}, {"b\n\"", {}}};
+    BOOST_CHECK(toJSON(toROBN(simple)) == R"({"a":[1,-2],"b\n\"":[]})");
+    BOOST_CHECK(toJSON(toROBN(std::make_tuple(1.5, 2.0f, true, std::optional<int>(), std::string("x")))) ==
+                R"([1.5,2.0,true,null,"x"])");
+    BOOST_CHECK(toJSON(toROBN(std::numeric_limits<std::int64_t>::min())) == "-9223372036854775808");
+    BOOST_CHECK(toJSON(toROBN((unsigned __int128) -1)) == "340282366920938463463374607431768211455");
+    BOOST_CHECK(toJSON(toROBN(0.1)) == "0.1");
+    BOOST_CHECK(toJSON(toROBN(std::nan(""))) == "null");
+    // keys that arent strings are still strings
+    BOOST_CHECK(toJSON(toROBN(std::map<int, bool>{{3, false}})) == R"({"3":false})");
+    std::vector<float> sparse(300);
+    sparse[2] = 1.0f;
+    BOOST_CHECK(toJSON(toROBN(sparse)).substr(0, 16) == "[0.0,0.0,1.0,0.0");
+    NDArray<std::uint8_t> grid({2, 2});
+    grid.data()[3] = 9;
+    BOOST_CHECK(toJSON(toROBN(grid)) == R"({"shape":[2,2],"data":[0,0,0,9]})");
+    BOOST_CHECK(toJSON(toChecksummedROBN(std::string("checked"))) == R"("checked")");
+    BOOST_CHECK(toJSON(toCompressedROBN(std::vector<std::uint8_t>(3, 7))) == "[7,7,7]");
+    // consecutive elements, one per line
+    auto two = toROBN(std::string("one"));
+    auto second = toROBN(std::int8_t(2));
+    two.insert(two.end(), second.begin(), second.end());
+    BOOST_CHECK(toJSON(two) == "\"one\"\n2");
+
+    // and back, arrays of one type are Vectors, so typed decoding works
+    auto parsed = fromJSON(R"( {"a": [1, -2], "b\n\"": []} )");
+    BOOST_CHECK((fromROBN<std::map<std::string, std::vector<std::int64_t>>>(parsed) ==
+                 std::map<std::string, std::vector<std::int64_t>>{{"a", {1, -2}}, {"b\n\"", {}}}));
+    BOOST_CHECK(fromROBN<std::vector<std::vector<double>>>(fromJSON("[[1.5],[2e3,-0.25]]")) ==
+                std::vector<std::vector<double>>({{1.5}, {2000, -0.25}}));
+    auto mixed = fromJSON(R"([1, "two", null, 18446744073709551615, -99999999999999999999999])");
+    BOOST_CHECK(mixed[0] == Byte{Type::Tuple});
+    auto values = fromROBN<std::tuple<std::int64_t, std::string, std::optional<int>, std::uint64_t, BigInt>>(mixed);
+    BOOST_CHECK(std::get<1>(values) == "two");
+    BOOST_CHECK(std::get<3>(values) == UINT64_MAX);
+    BOOST_CHECK(std::get<4>(values).toString() == "-99999999999999999999999");
+    BOOST_CHECK(fromROBN<std::string>(fromJSON(R"("\u00e9\ud83d\ude00\/")")) == "\xc3\xa9\xf0\x9f\x98\x80/");
+
+    // JSON that came from ROBN comes out the same after a round trip through ROBN
+    std::string text = R"({"name":"n","list":[1,2,3],"nested":[[true,false],[]],"f":-0.5,"pair":["a",1]})";
+    BOOST_CHECK(toJSON(fromJSON(text)) == text);
+    std::string appended = "prefix";
+    transcodeToJSON(fromJSON(text).data(), fromJSON(text).size(), appended);
+    BOOST_CHECK(appended == "prefix" + text);
+
+    for (auto bad : {"[1,", "{\"a\" 1}", "01", "\"\\u0000\"", "\"tab\there\"", "[1 2]", "tru", "-", "1.", "\"\\ud800\""}) {
+        ROBN untouched{Byte{1}};
+        BOOST_CHECK_THROW(transcodeFromJSON(bad, untouched), RogueLib::Exceptions::InvalidArgument);
+        BOOST_CHECK(untouched.size() == 1);
+    }
+}
@@ -22,68 +22,201 @@
 
 #include "RogueLib/Threading/Event.hpp"
 
+#include <RogueLib/Threading/ObjectPool.hpp>
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
 #include <mutex>
 #include <condition_variable>
-#include <atomic>
-#include <vector>
+#endif
 
 namespace RogueLib::Threading {
+    namespace {
+        struct CallbackNode {
+            boost::function<void()> callback;
+            CallbackNode* next = nullptr;
+            CallbackNode* nextFree = nullptr;
+        };
+
+        // what the callback stack is swapped to when its triggered, nothing can be pushed after it
+        CallbackNode* const triggeredMarker = reinterpret_cast<CallbackNode*>(std::uintptr_t(1));
+    }
+
+    /**
+     * the callback stack's head is the whole state, its pushed to with a CAS, and trigger swaps the marker in
+     * done is only set after the callbacks have run, so a wait returns after them, like it did when this was a mutex
+     * blocking is a futex on done, and trigger only makes the syscall if something is waiting
+     *
+     * a callback registered after the marker is in still runs after every callback before it
+     * from another thread it waits for done first, same as blocking on the mutex did
+     * from inside one of this event's callbacks it goes on the end of the list trigger is running
+     */
     class Event::IMPL {
-        std::vector<boost::function<void()>> callbacks;
-        std::mutex callbackMutex;
+        std::atomic<CallbackNode*> callbacks = {nullptr};
+        // last node of the list trigger is running, only touched by the triggering thread
+        CallbackNode* runningTail = nullptr;
+        // the event this thread is running the callbacks of, if any
+        static thread_local IMPL* triggeringEvent;
+        std::atomic_uint32_t done = {0};
+        std::atomic_uint32_t waiters = {0};
+#ifndef __linux__
+        std::mutex waitMutex;
         std::condition_variable waitCV;
-        std::atomic_bool wasTriggered = {false};
-    
+#endif
+
+        void block();
+
+        void wakeAll();
+
+        void runLate(CallbackNode* node);
+
     public:
+        std::atomic_uint32_t references = {0};
+        IMPL* nextFree = nullptr;
+
         void wait();
         
         void trigger();
         
         void registerCallback(boost::function<void()> callback);
-        
-        ~IMPL();
-        
+
+        // for going back into the pool
+        void reset();
     };
+
+    thread_local Event::IMPL* Event::IMPL::triggeringEvent = nullptr;
+
+    void intrusive_ptr_add_ref(Event::IMPL* impl) {
+        impl->references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void intrusive_ptr_release(Event::IMPL* impl) {
+        if (impl->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        // nobody can wait on it anymore, but callbacks still get called
+        impl->trigger();
+        impl->reset();
+        ObjectPool<Event::IMPL>::put(impl);
+    }
+
+#ifdef __linux__
+    void Event::IMPL::block() {
+        // returns right away if done isnt 0 anymore, so a trigger between the check and here isnt lost
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&done), FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+    }
+
+    void Event::IMPL::wakeAll() {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&done), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+#else
+    void Event::IMPL::block() {
+        std::unique_lock<std::mutex> lk(waitMutex);
+        if (done.load() == 0) {
+            waitCV.wait(lk);
+        }
+    }
+
+    void Event::IMPL::wakeAll() {
+        // taking the lock means nothing is between its check of done and waiting
+        std::unique_lock<std::mutex> lk(waitMutex);
+        lk.unlock();
+        waitCV.notify_all();
+    }
+#endif
     
     void Event::IMPL::wait() {
-        std::unique_lock<std::mutex> lk(callbackMutex);
-        if (wasTriggered) {
+        if (done.load(std::memory_order_acquire) != 0) {
             return;
         }
-        waitCV.wait(lk);
+        waiters.fetch_add(1);
+        while (done.load() == 0) {
+            block();
+        }
+        waiters.fetch_sub(1);
     }
     
     void Event::IMPL::trigger() {
-        std::unique_lock<std::mutex> lk(callbackMutex);
-        if (wasTriggered) {
+        auto* head = callbacks.exchange(triggeredMarker, std::memory_order_acq_rel);
+        if (head == triggeredMarker) {
             return;
         }
-        wasTriggered = true;
-        for (auto& callback : callbacks) {
-            callback();
-            callback.clear();
+        // its a stack, flip it so they are called in the order they were registered
+        CallbackNode* ordered = nullptr;
+        runningTail = head;
+        while (head != nullptr) {
+            auto* next = head->next;
+            head->next = ordered;
+            ordered = head;
+            head = next;
+        }
+        auto* outerEvent = triggeringEvent;
+        triggeringEvent = this;
+        while (ordered != nullptr) {
+            ordered->callback();
+            // read after the call, the callback may have put more on the end
+            auto* next = ordered->next;
+            ordered->callback.clear();
+            ordered->next = nullptr;
+            ObjectPool<CallbackNode>::put(ordered);
+            ordered = next;
+        }
+        triggeringEvent = outerEvent;
+        runningTail = nullptr;
+        done.store(1);
+        if (waiters.load() != 0) {
+            wakeAll();
         }
-        lk.unlock();
-        waitCV.notify_all();
     }
     
+    void Event::IMPL::runLate(CallbackNode* node) {
+        if (triggeringEvent == this) {
+            // registered by one of the callbacks being run, it goes after the rest of them
+            runningTail->next = node;
+            runningTail = node;
+            return;
+        }
+        // trigger may still be running the earlier ones
+        wait();
+        node->callback();
+        node->callback.clear();
+        ObjectPool<CallbackNode>::put(node);
+    }
+
     void Event::IMPL::registerCallback(boost::function<void()> callback) {
-        std::unique_lock<std::mutex> lk(callbackMutex);
-        if (wasTriggered) {
+        auto* head = callbacks.load(std::memory_order_acquire);
+        if (head == triggeredMarker && done.load(std::memory_order_acquire) != 0) {
             callback();
             return;
         }
-        callbacks.push_back(callback);
+        auto* node = ObjectPool<CallbackNode>::get();
+        node->callback = std::move(callback);
+        do {
+            if (head == triggeredMarker) {
+                // lost the race to trigger
+                runLate(node);
+                return;
+            }
+            node->next = head;
+        } while (!callbacks.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_acquire));
     }
     
-    Event::IMPL::~IMPL() {
-        trigger();
+    void Event::IMPL::reset() {
+        callbacks.store(nullptr, std::memory_order_relaxed);
+        done.store(0, std::memory_order_relaxed);
     }
 }
 
 namespace RogueLib::Threading {
     Event::Event() {
-        impl = std::make_shared<IMPL>();
+        impl = ObjectPool<IMPL>::get();
     }
     
     void Event::wait() {
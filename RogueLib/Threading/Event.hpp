@@ -24,11 +24,17 @@
 
 #include <memory>
 #include <boost/function.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
 
 namespace RogueLib::Threading{
     class Event{
         class IMPL;
-        std::shared_ptr<IMPL> impl;
+        // pooled, see ObjectPool
+        boost::intrusive_ptr<IMPL> impl;
+
+        friend void intrusive_ptr_add_ref(IMPL* impl);
+
+        friend void intrusive_ptr_release(IMPL* impl);
     public:
         Event();
         
@@ -0,0 +1,570 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <RogueLib/Threading/WorkQueue.hpp>
+#include <RogueLib/Exceptions/Exceptions.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RogueLib::Threading {
+    template<typename T>
+    class Future;
+
+    template<typename T>
+    class Promise;
+
+    namespace FutureDetail {
+        // what a Future<void> holds
+        struct Unit {
+        };
+
+        template<typename T>
+        using Stored = std::conditional_t<std::is_void<T>::value, Unit, T>;
+
+        template<typename T, typename F, bool = std::is_void<T>::value>
+        struct ContinuationResult {
+            typedef std::invoke_result_t<F&, const T&> type;
+        };
+
+        template<typename T, typename F>
+        struct ContinuationResult<T, F, true> {
+            typedef std::invoke_result_t<F&> type;
+        };
+
+        template<typename T>
+        using AllResult = std::conditional_t<std::is_void<T>::value, void, std::vector<Stored<T>>>;
+
+        /**
+         * something waiting on a State, kept in whatever is waiting, so registering it doesnt allocate
+         */
+        struct Callback {
+            Callback* next = nullptr;
+
+            virtual void fire() = 0;
+
+        protected:
+            ~Callback() = default;
+        };
+
+        // what the callback stack is swapped to when a State finishes, nothing can be pushed after it
+        inline Callback* const finishedMarker = reinterpret_cast<Callback*>(std::uintptr_t(1));
+
+        // for Future::event, deletes itself once its fired
+        struct EventCallback final : Callback {
+            Event event;
+
+            void fire() override {
+                event.trigger();
+                delete this;
+            }
+        };
+
+        /**
+         * the value, the exception, and the callbacks waiting on them
+         * the callback stack's head is also the ready flag, its pushed to with a CAS, and finishing swaps the marker in
+         * continuations and combinators derive from it, so whatever they hold is in the same allocation
+         */
+        template<typename T>
+        class State {
+            std::atomic_uint32_t references = {0};
+            std::atomic_bool claimed = {false};
+            std::atomic<Callback*> callbacks = {nullptr};
+
+            void finish() {
+                auto* head = callbacks.exchange(finishedMarker, std::memory_order_acq_rel);
+                // its a stack, flip it so they are called in the order they were registered
+                Callback* ordered = nullptr;
+                while (head != nullptr) {
+                    auto* next = head->next;
+                    head->next = ordered;
+                    ordered = head;
+                    head = next;
+                }
+                while (ordered != nullptr) {
+                    // firing it can free it
+                    auto* next = ordered->next;
+                    ordered->fire();
+                    ordered = next;
+                }
+            }
+
+        public:
+            std::optional<Stored<T>> value;
+            std::exception_ptr exception;
+
+            virtual ~State() = default;
+
+            // only the first to claim it gets to set it
+            bool claim() {
+                return !claimed.exchange(true, std::memory_order_acq_rel);
+            }
+
+            void setValue(Stored<T> newValue) {
+                value.emplace(std::move(newValue));
+                finish();
+            }
+
+            void setException(std::exception_ptr newException) {
+                exception = std::move(newException);
+                finish();
+            }
+
+            bool isFinished() const {
+                return callbacks.load(std::memory_order_acquire) == finishedMarker;
+            }
+
+            /**
+             * fired once its finished, or right here if it already is
+             * callback has to stay where it is until then
+             */
+            void addCallback(Callback* callback) {
+                auto* head = callbacks.load(std::memory_order_acquire);
+                do {
+                    if (head == finishedMarker) {
+                        callback->fire();
+                        return;
+                    }
+                    callback->next = head;
+                } while (!callbacks.compare_exchange_weak(head, callback, std::memory_order_acq_rel,
+                                                          std::memory_order_acquire));
+            }
+
+            void wait() {
+                if (isFinished()) {
+                    return;
+                }
+                // only something that actually blocks pays for a mutex, and its on the stack
+                struct Blocking final : Callback {
+                    std::mutex mutex;
+                    std::condition_variable cv;
+                    bool done = false;
+
+                    void fire() override {
+                        std::unique_lock<std::mutex> lk(mutex);
+                        done = true;
+                        cv.notify_all();
+                    }
+                } blocking;
+                addCallback(&blocking);
+                std::unique_lock<std::mutex> lk(blocking.mutex);
+                blocking.cv.wait(lk, [&] { return blocking.done; });
+            }
+
+            Event event() {
+                auto* callback = new EventCallback();
+                auto event = callback->event;
+                addCallback(callback);
+                return event;
+            }
+
+            friend void intrusive_ptr_add_ref(State* state) {
+                state->references.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            friend void intrusive_ptr_release(State* state) {
+                if (state->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    delete state;
+                }
+            }
+        };
+
+        /**
+         * F is kept in here, and it waits on source as its own Callback, so neither allocates
+         * holds one extra reference from when its registered until its run, and source only until its run
+         */
+        template<typename R, typename T, typename F>
+        class Continuation : public State<R>, Callback {
+            boost::intrusive_ptr<State<T>> source;
+            F function;
+            std::optional<WorkQueue> queue;
+
+            void run() {
+                if (source->exception) {
+                    this->setException(source->exception);
+                    return;
+                }
+                std::optional<Stored<R>> result;
+                try {
+                    if constexpr (std::is_void<R>::value) {
+                        if constexpr (std::is_void<T>::value) {
+                            function();
+                        } else {
+                            function(std::as_const(*source->value));
+                        }
+                        result.emplace();
+                    } else {
+                        if constexpr (std::is_void<T>::value) {
+                            result.emplace(function());
+                        } else {
+                            result.emplace(function(std::as_const(*source->value)));
+                        }
+                    }
+                } catch (...) {
+                    this->setException(std::current_exception());
+                    return;
+                }
+                this->setValue(std::move(*result));
+            }
+
+            struct Run {
+                Continuation* continuation;
+
+                void operator()() const {
+                    continuation->run();
+                    // a chain of them would otherwise keep every value before it alive
+                    continuation->source.reset();
+                    intrusive_ptr_release(continuation);
+                }
+            };
+
+            void fire() override {
+                if (queue) {
+                    queue->enqueue(Run{this});
+                } else {
+                    Run{this}();
+                }
+            }
+
+        public:
+            Continuation(boost::intrusive_ptr<State<T>> source, F function, std::optional<WorkQueue> queue)
+                    : source(std::move(source)), function(std::move(function)), queue(std::move(queue)) {
+            }
+
+            void start() {
+                intrusive_ptr_add_ref(this);
+                source->addCallback(this);
+            }
+        };
+
+        // holds one extra reference until every source has fired
+        template<typename T>
+        class WhenAll : public State<AllResult<T>> {
+            struct Source final : Callback {
+                WhenAll* state;
+                boost::intrusive_ptr<State<T>> source;
+
+                Source(WhenAll* state, boost::intrusive_ptr<State<T>> source) : state(state), source(std::move(source)) {
+                }
+
+                void fire() override {
+                    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        state->finishAll();
+                        intrusive_ptr_release(state);
+                    }
+                }
+            };
+
+            // never resized after the constructor, the callbacks point into it
+            std::vector<Source> sources;
+            std::atomic_size_t remaining;
+
+            void finishAll() {
+                for (auto& source : sources) {
+                    if (source.source->exception) {
+                        this->setException(source.source->exception);
+                        return;
+                    }
+                }
+                if constexpr (std::is_void<T>::value) {
+                    this->setValue({});
+                } else {
+                    std::vector<T> values;
+                    values.reserve(sources.size());
+                    for (auto& source : sources) {
+                        values.emplace_back(*source.source->value);
+                    }
+                    this->setValue(std::move(values));
+                }
+            }
+
+        public:
+            explicit WhenAll(std::vector<boost::intrusive_ptr<State<T>>> states) : remaining(states.size()) {
+                sources.reserve(states.size());
+                for (auto& state : states) {
+                    sources.emplace_back(this, std::move(state));
+                }
+            }
+
+            void start() {
+                if (sources.empty()) {
+                    finishAll();
+                    return;
+                }
+                intrusive_ptr_add_ref(this);
+                for (auto& source : sources) {
+                    source.source->addCallback(&source);
+                }
+            }
+        };
+
+        // holds one extra reference until every source has fired, the first one to fire sets it
+        template<typename T>
+        class WhenAny : public State<std::size_t> {
+            struct Source final : Callback {
+                WhenAny* state;
+                boost::intrusive_ptr<State<T>> source;
+                std::size_t index;
+
+                Source(WhenAny* state, boost::intrusive_ptr<State<T>> source, std::size_t index)
+                        : state(state), source(std::move(source)), index(index) {
+                }
+
+                void fire() override {
+                    if (state->claim()) {
+                        state->setValue(index);
+                    }
+                    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        intrusive_ptr_release(state);
+                    }
+                }
+            };
+
+            // never resized after the constructor, the callbacks point into it
+            std::vector<Source> sources;
+            std::atomic_size_t remaining;
+
+        public:
+            explicit WhenAny(std::vector<boost::intrusive_ptr<State<T>>> states) : remaining(states.size()) {
+                sources.reserve(states.size());
+                for (std::size_t i = 0; i < states.size(); ++i) {
+                    sources.emplace_back(this, std::move(states[i]), i);
+                }
+            }
+
+            void start() {
+                intrusive_ptr_add_ref(this);
+                for (auto& source : sources) {
+                    source.source->addCallback(&source);
+                }
+            }
+        };
+    }
+
+    /**
+     * a value (or exception) that will be there later, copies all refer to the same one
+     * everything but valid needs a Future that came from somewhere, a default constructed one is empty
+     */
+    template<typename T>
+    class Future {
+        boost::intrusive_ptr<FutureDetail::State<T>> state;
+
+        template<typename>
+        friend class Future;
+
+        template<typename U>
+        friend Future<FutureDetail::AllResult<U>> whenAll(const std::vector<Future<U>>& futures);
+
+        template<typename U>
+        friend Future<std::size_t> whenAny(const std::vector<Future<U>>& futures);
+
+        template<typename R, typename F>
+        Future<R> continueWith(F function, std::optional<WorkQueue> queue) const {
+            auto* continuation = new FutureDetail::Continuation<R, T, F>(state, std::move(function), std::move(queue));
+            Future<R> result(continuation);
+            continuation->start();
+            return result;
+        }
+
+    public:
+        Future() = default;
+
+        explicit Future(boost::intrusive_ptr<FutureDetail::State<T>> state) : state(std::move(state)) {
+        }
+
+        bool valid() const {
+            return bool(state);
+        }
+
+        bool ready() const {
+            return state->isFinished();
+        }
+
+        void wait() const {
+            state->wait();
+        }
+
+        /**
+         * waits, then rethrows the exception, if it has one
+         */
+        decltype(auto) get() const {
+            wait();
+            if (state->exception) {
+                std::rethrow_exception(state->exception);
+            }
+            if constexpr (!std::is_void<T>::value) {
+                return static_cast<const T&>(*state->value);
+            }
+        }
+
+        /**
+         * triggered once it has a value or exception, for WorkQueue dependencies
+         * every call makes a new Event, so keep the one you got if you need it more than once
+         */
+        Event event() const {
+            return state->event();
+        }
+
+        /**
+         * function gets the value (nothing, for void), and runs on whatever thread sets it, or right here if it
+         * already is, an exception skips function and is passed straight on
+         */
+        template<typename F>
+        auto then(F function) const {
+            typedef typename FutureDetail::ContinuationResult<T, F>::type R;
+            return continueWith<R>(std::move(function), std::nullopt);
+        }
+
+        /**
+         * same as then(function), but function is enqueued on queue instead of run inline
+         */
+        template<typename F>
+        auto then(WorkQueue queue, F function) const {
+            typedef typename FutureDetail::ContinuationResult<T, F>::type R;
+            return continueWith<R>(std::move(function), std::move(queue));
+        }
+    };
+
+    /**
+     * the setting side, move only, destroying one that was never set sets an InvalidAsyncState on its Future
+     */
+    template<typename T>
+    class Promise {
+        boost::intrusive_ptr<FutureDetail::State<T>> state;
+
+        void claim() {
+            if (!state->claim()) {
+                ROGUELIB_STACKTRACE
+                throw Exceptions::InvalidAsyncState(ROGUELIB_EXCEPTION_INFO, "Promise already set");
+            }
+        }
+
+        void abandon() {
+            if (state && state->claim()) {
+                ROGUELIB_STACKTRACE
+                state->setException(std::make_exception_ptr(
+                        Exceptions::InvalidAsyncState(ROGUELIB_EXCEPTION_INFO, "Promise destroyed without being set")));
+            }
+        }
+
+    public:
+        Promise() : state(new FutureDetail::State<T>()) {
+        }
+
+        Promise(const Promise&) = delete;
+
+        Promise& operator=(const Promise&) = delete;
+
+        Promise(Promise&& other) noexcept = default;
+
+        Promise& operator=(Promise&& other) noexcept {
+            if (this != &other) {
+                abandon();
+                state = std::move(other.state);
+            }
+            return *this;
+        }
+
+        ~Promise() {
+            abandon();
+        }
+
+        Future<T> future() const {
+            return Future<T>(state);
+        }
+
+        template<typename U = T, typename std::enable_if_t<!std::is_void<U>::value, int> = 0>
+        void setValue(U value) {
+            claim();
+            state->setValue(std::move(value));
+        }
+
+        template<typename U = T, typename std::enable_if_t<std::is_void<U>::value, int> = 0>
+        void setValue() {
+            claim();
+            state->setValue({});
+        }
+
+        void setException(std::exception_ptr exception) {
+            claim();
+            state->setException(std::move(exception));
+        }
+    };
+
+    template<typename T>
+    Future<std::decay_t<T>> makeReadyFuture(T&& value) {
+        Promise<std::decay_t<T>> promise;
+        promise.setValue(std::forward<T>(value));
+        return promise.future();
+    }
+
+    inline Future<void> makeReadyFuture() {
+        Promise<void> promise;
+        promise.setValue();
+        return promise.future();
+    }
+
+    /**
+     * the values in the same order (nothing, for void), or the exception of the first one in the vector that has one
+     */
+    template<typename T>
+    Future<FutureDetail::AllResult<T>> whenAll(const std::vector<Future<T>>& futures) {
+        std::vector<boost::intrusive_ptr<FutureDetail::State<T>>> sources;
+        sources.reserve(futures.size());
+        for (auto& future : futures) {
+            sources.emplace_back(future.state);
+        }
+        auto* state = new FutureDetail::WhenAll<T>(std::move(sources));
+        Future<FutureDetail::AllResult<T>> result(state);
+        state->start();
+        return result;
+    }
+
+    /**
+     * the index of the first one to be ready, with a value or an exception, theres no any of nothing
+     */
+    template<typename T>
+    Future<std::size_t> whenAny(const std::vector<Future<T>>& futures) {
+        ROGUELIB_STACKTRACE
+        if (futures.empty()) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "whenAny of no futures");
+        }
+        std::vector<boost::intrusive_ptr<FutureDetail::State<T>>> sources;
+        sources.reserve(futures.size());
+        for (auto& future : futures) {
+            sources.emplace_back(future.state);
+        }
+        auto* state = new FutureDetail::WhenAny<T>(std::move(sources));
+        Future<std::size_t> result(state);
+        state->start();
+        return result;
+    }
+}
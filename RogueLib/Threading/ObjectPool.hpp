@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace RogueLib::Threading {
+    /**
+     * free lists for objects that get made and dropped constantly (Events, WorkQueue Items)
+     * T needs a `T* nextFree` member, the lists are threaded through the objects themselves
+     *
+     * each thread keeps its own list, and trades whole batches with a shared one, so a thread that only makes
+     * them still gets the ones a thread that only drops them gave back, and the lock is taken once per batch
+     * objects are constructed once and only ever reused after that, the pool never gives memory back
+     */
+    template<typename T>
+    class ObjectPool {
+        static constexpr std::size_t batchSize = 64;
+
+        struct Shared {
+            std::mutex mutex;
+            // head and length of each chain
+            std::vector<std::pair<T*, std::size_t>> batches;
+        };
+
+        // leaked, threads can still be giving objects back after static destructors run
+        static Shared& shared() {
+            static auto* pool = new Shared();
+            return *pool;
+        }
+
+        struct Local {
+            T* head = nullptr;
+            std::size_t count = 0;
+
+            ~Local() {
+                if (head == nullptr) {
+                    return;
+                }
+                auto& pool = shared();
+                std::unique_lock<std::mutex> lk(pool.mutex);
+                pool.batches.emplace_back(head, count);
+            }
+        };
+
+        static Local& local() {
+            static thread_local Local list;
+            return list;
+        }
+
+    public:
+        static T* get() {
+            auto& list = local();
+            if (list.head == nullptr) {
+                auto& pool = shared();
+                std::unique_lock<std::mutex> lk(pool.mutex);
+                if (pool.batches.empty()) {
+                    lk.unlock();
+                    return new T();
+                }
+                std::tie(list.head, list.count) = pool.batches.back();
+                pool.batches.pop_back();
+            }
+            auto* object = list.head;
+            list.head = object->nextFree;
+            list.count--;
+            return object;
+        }
+
+        /**
+         * object must already be reset to how get should hand it out
+         */
+        static void put(T* object) {
+            auto& list = local();
+            object->nextFree = list.head;
+            list.head = object;
+            if (++list.count < batchSize * 2) {
+                return;
+            }
+            // keeps one batch, so a thread going back and forth around the limit doesnt take the lock every time
+            auto* last = list.head;
+            for (std::size_t i = 1; i < batchSize; ++i) {
+                last = last->nextFree;
+            }
+            auto* batch = last->nextFree;
+            last->nextFree = nullptr;
+            auto& pool = shared();
+            std::unique_lock<std::mutex> lk(pool.mutex);
+            pool.batches.emplace_back(batch, list.count - batchSize);
+            list.count = batchSize;
+        }
+    };
+}
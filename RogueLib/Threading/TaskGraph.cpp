@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "RogueLib/Threading/TaskGraph.hpp"
+#include <RogueLib/Exceptions/Exceptions.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+
+namespace RogueLib::Threading {
+    class TaskGraph::IMPL {
+        struct NodeData {
+            boost::function<void()> function;
+            std::vector<Node> successors;
+            std::vector<Node> predecessors;
+        };
+        
+        // everything one run needs, kept and reused by later runs
+        struct Run {
+            IMPL* graph = nullptr;
+            // the graph doesnt go away under a run
+            std::shared_ptr<IMPL> keepAlive;
+            std::optional<WorkQueue> queue;
+            std::unique_ptr<std::atomic_uint32_t[]> remaining;
+            std::size_t remainingSize = 0;
+            std::atomic_size_t pending = {0};
+            Event done;
+            std::shared_ptr<Statistics> statistics;
+            std::chrono::steady_clock::time_point startTime;
+            // nanoseconds since startTime, only when statistics are wanted
+            std::vector<std::int64_t> nodeStart;
+            std::vector<std::int64_t> nodeEnd;
+        };
+        
+        // small and trivially copyable, so boost::function holds it without allocating
+        struct NodeTask {
+            Run* run;
+            Node node;
+            
+            void operator()() const {
+                run->graph->runNode(run, node);
+            }
+        };
+        
+        std::mutex mutex;
+        std::vector<NodeData> nodes;
+        // worked out again on the first run after the graph changes
+        bool prepared = false;
+        std::vector<Node> roots;
+        std::vector<std::uint32_t> predecessorCounts;
+        std::vector<Node> topologicalOrder;
+        std::vector<std::unique_ptr<Run>> runs;
+        std::vector<Run*> freeRuns;
+        
+        void prepare();
+        
+        void runNode(Run* run, Node node);
+        
+        void finishNode(Run* run, Node node);
+        
+        void finishRun(Run* run);
+        
+        void computeStatistics(Run& run);
+    
+    public:
+        std::weak_ptr<IMPL> selfPtr;
+        
+        Node addNode(boost::function<void()> function);
+        
+        void addEdge(Node before, Node after);
+        
+        Event execute(WorkQueue queue, std::shared_ptr<Statistics> statistics);
+    };
+    
+    TaskGraph::Node TaskGraph::IMPL::addNode(boost::function<void()> function) {
+        std::unique_lock<std::mutex> lk(mutex);
+        nodes.emplace_back();
+        nodes.back().function = std::move(function);
+        prepared = false;
+        return nodes.size() - 1;
+    }
+    
+    void TaskGraph::IMPL::addEdge(Node before, Node after) {
+        ROGUELIB_STACKTRACE
+        std::unique_lock<std::mutex> lk(mutex);
+        if (before >= nodes.size() || after >= nodes.size()) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "Unknown TaskGraph node");
+        }
+        nodes[before].successors.emplace_back(after);
+        nodes[after].predecessors.emplace_back(before);
+        prepared = false;
+    }
+    
+    void TaskGraph::IMPL::prepare() {
+        ROGUELIB_STACKTRACE
+        roots.clear();
+        topologicalOrder.clear();
+        predecessorCounts.resize(nodes.size());
+        // Kahn's, which also finds any cycle
+        std::vector<std::uint32_t> counts(nodes.size());
+        for (Node i = 0; i < nodes.size(); ++i) {
+            predecessorCounts[i] = counts[i] = std::uint32_t(nodes[i].predecessors.size());
+            if (counts[i] == 0) {
+                roots.emplace_back(i);
+                topologicalOrder.emplace_back(i);
+            }
+        }
+        for (std::size_t i = 0; i < topologicalOrder.size(); ++i) {
+            for (auto successor : nodes[topologicalOrder[i]].successors) {
+                if (--counts[successor] == 0) {
+                    topologicalOrder.emplace_back(successor);
+                }
+            }
+        }
+        if (topologicalOrder.size() != nodes.size()) {
+            throw Exceptions::InvalidArgument(ROGUELIB_EXCEPTION_INFO, "TaskGraph has a cycle");
+        }
+        prepared = true;
+    }
+    
+    Event TaskGraph::IMPL::execute(WorkQueue queue, std::shared_ptr<Statistics> statistics) {
+        ROGUELIB_STACKTRACE
+        std::unique_lock<std::mutex> lk(mutex);
+        if (!prepared) {
+            prepare();
+        }
+        if (nodes.empty()) {
+            Event done;
+            done.trigger();
+            if (statistics) {
+                *statistics = {};
+            }
+            return done;
+        }
+        Run* run;
+        if (freeRuns.empty()) {
+            runs.emplace_back(std::make_unique<Run>());
+            run = runs.back().get();
+            run->graph = this;
+        } else {
+            run = freeRuns.back();
+            freeRuns.pop_back();
+        }
+        if (run->remainingSize != nodes.size()) {
+            run->remaining.reset(new std::atomic_uint32_t[nodes.size()]);
+            run->remainingSize = nodes.size();
+        }
+        for (Node i = 0; i < nodes.size(); ++i) {
+            run->remaining[i].store(predecessorCounts[i], std::memory_order_relaxed);
+        }
+        run->pending.store(nodes.size(), std::memory_order_relaxed);
+        run->keepAlive = selfPtr.lock();
+        run->queue = queue;
+        run->done = Event();
+        run->statistics = std::move(statistics);
+        if (run->statistics) {
+            run->nodeStart.resize(nodes.size());
+            run->nodeEnd.resize(nodes.size());
+            run->startTime = std::chrono::steady_clock::now();
+        }
+        auto done = run->done;
+        lk.unlock();
+        
+        for (auto root : roots) {
+            queue.enqueue(NodeTask{run, root});
+        }
+        return done;
+    }
+    
+    void TaskGraph::IMPL::runNode(Run* run, Node node) {
+        if (run->statistics) {
+            run->nodeStart[node] = (std::chrono::steady_clock::now() - run->startTime).count();
+        }
+        try {
+            nodes[node].function();
+        } catch (...) {
+            // the rest of the graph still runs, like a failed enqueue'd item still triggers its event
+            finishNode(run, node);
+            throw;
+        }
+        finishNode(run, node);
+    }
+    
+    void TaskGraph::IMPL::finishNode(Run* run, Node node) {
+        if (run->statistics) {
+            run->nodeEnd[node] = (std::chrono::steady_clock::now() - run->startTime).count();
+        }
+        for (auto successor : nodes[node].successors) {
+            if (run->remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                run->queue->enqueue(NodeTask{run, successor});
+            }
+        }
+        if (run->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            finishRun(run);
+        }
+    }
+    
+    void TaskGraph::IMPL::finishRun(Run* run) {
+        if (run->statistics) {
+            computeStatistics(*run);
+            run->statistics.reset();
+        }
+        auto done = run->done;
+        run->queue.reset();
+        // this can be the last reference to the graph, so nothing of it can be touched after this
+        auto keepAlive = std::move(run->keepAlive);
+        {
+            std::unique_lock<std::mutex> lk(mutex);
+            freeRuns.emplace_back(run);
+        }
+        done.trigger();
+    }
+    
+    void TaskGraph::IMPL::computeStatistics(Run& run) {
+        auto& statistics = *run.statistics;
+        statistics.wallTime = std::chrono::steady_clock::now() - run.startTime;
+        std::int64_t totalWork = 0;
+        // longest path ending at each node, by measured durations, and where it came from
+        std::vector<std::int64_t> pathLength(nodes.size());
+        std::vector<Node> pathPrevious(nodes.size(), nodes.size());
+        Node longest = topologicalOrder.front();
+        for (auto node : topologicalOrder) {
+            auto duration = run.nodeEnd[node] - run.nodeStart[node];
+            totalWork += duration;
+            std::int64_t before = 0;
+            for (auto predecessor : nodes[node].predecessors) {
+                if (pathPrevious[node] == nodes.size() || pathLength[predecessor] > before) {
+                    before = pathLength[predecessor];
+                    pathPrevious[node] = predecessor;
+                }
+            }
+            pathLength[node] = before + duration;
+            if (pathLength[node] > pathLength[longest]) {
+                longest = node;
+            }
+        }
+        statistics.totalWork = std::chrono::nanoseconds(totalWork);
+        statistics.criticalPath = std::chrono::nanoseconds(pathLength[longest]);
+        statistics.criticalPathNodes.clear();
+        for (auto node = longest; node != nodes.size(); node = pathPrevious[node]) {
+            statistics.criticalPathNodes.emplace_back(node);
+        }
+        std::reverse(statistics.criticalPathNodes.begin(), statistics.criticalPathNodes.end());
+    }
+}
+
+namespace RogueLib::Threading {
+    TaskGraph::TaskGraph() {
+        impl = std::make_shared<IMPL>();
+        impl->selfPtr = impl;
+    }
+    
+    TaskGraph::Node TaskGraph::addNode(boost::function<void()> function) {
+        return impl->addNode(std::move(function));
+    }
+    
+    void TaskGraph::addEdge(Node before, Node after) {
+        impl->addEdge(before, after);
+    }
+    
+    Event TaskGraph::execute(WorkQueue queue, std::shared_ptr<Statistics> statistics) {
+        return impl->execute(std::move(queue), std::move(statistics));
+    }
+}
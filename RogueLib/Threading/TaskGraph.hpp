@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2020 RogueLogix
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <RogueLib/Threading/WorkQueue.hpp>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace RogueLib::Threading {
+    /**
+     * a fixed set of functions and the order between them, built once, run as many times as you want
+     * the dependency counts and per run state are worked out once and reused, whats left per run is a
+     * WorkQueue::enqueue for every node, each of which still takes an Item and an Event from their pools
+     *
+     * dont change the graph while a run is going, runs can overlap each other though
+     */
+    class TaskGraph {
+        class IMPL;
+        
+        std::shared_ptr<IMPL> impl;
+    public:
+        typedef std::size_t Node;
+        
+        /**
+         * measured for runs that ask for it, durations are per node, from start to end of its function
+         */
+        struct Statistics {
+            std::chrono::nanoseconds wallTime{0};
+            // sum of every nodes duration
+            std::chrono::nanoseconds totalWork{0};
+            // longest chain of dependent nodes, by their durations, the best any amount of threads could do
+            std::chrono::nanoseconds criticalPath{0};
+            // first to last
+            std::vector<Node> criticalPathNodes;
+        };
+        
+        TaskGraph();
+        
+        Node addNode(boost::function<void()> function);
+        
+        /**
+         * after doesnt start until before is done
+         */
+        void addEdge(Node before, Node after);
+        
+        /**
+         * enqueues the nodes on queue as their dependencies finish
+         * the returned event is triggered once every node is done, and statistics is filled in before it is
+         *
+         * throws if the graph has a cycle
+         */
+        Event execute(WorkQueue queue, std::shared_ptr<Statistics> statistics = {});
+    };
+}
@@ -26,21 +26,458 @@
 #include <list>
 #include <boost/bind.hpp>
 #include <RogueLib/Threading/DestructorCallback.hpp>
+#include <RogueLib/Threading/ObjectPool.hpp>
 #include <shared_mutex>
+#include <algorithm>
+#include <optional>
+#include <thread>
 
 
 namespace RogueLib::Threading {
+    namespace {
+        /**
+         * bounded MPMC ring (Vyukov's), each slot's sequence number says whose turn it is
+         * a producer or consumer claims a position with one CAS, after that the slot is its own, nobody waits on it
+         */
+        class ItemRing {
+            struct Slot {
+                std::atomic_size_t sequence;
+                alignas(WorkQueue::Item) unsigned char storage[sizeof(WorkQueue::Item)];
+            };
+
+            std::unique_ptr<Slot[]> slots;
+            std::size_t mask;
+            // on their own cache lines, so producers and consumers arent fighting over one
+            alignas(64) std::atomic_size_t enqueuePosition = {0};
+            alignas(64) std::atomic_size_t dequeuePosition = {0};
+
+        public:
+            explicit ItemRing(std::size_t capacity) {
+                std::size_t size = 2;
+                while (size < capacity) {
+                    size <<= 1u;
+                }
+                slots.reset(new Slot[size]);
+                mask = size - 1;
+                for (std::size_t i = 0; i < size; ++i) {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            ~ItemRing() {
+                while (tryPop()) {}
+            }
+
+            // item is only moved from if it was pushed
+            bool tryPush(WorkQueue::Item& item) {
+                Slot* slot;
+                auto position = enqueuePosition.load(std::memory_order_relaxed);
+                while (true) {
+                    slot = &slots[position & mask];
+                    auto sequence = slot->sequence.load(std::memory_order_acquire);
+                    auto difference = std::intptr_t(sequence) - std::intptr_t(position);
+                    if (difference == 0) {
+                        if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if (difference < 0) {
+                        // full
+                        return false;
+                    } else {
+                        position = enqueuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+                new(slot->storage) WorkQueue::Item(std::move(item));
+                slot->sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * claims as many free slots in a row as it can, up to count, with one CAS
+             * returns how many of items (from the front) were pushed, and moved from
+             */
+            std::size_t tryPushBulk(WorkQueue::Item* items, std::size_t count) {
+                std::size_t claimed;
+                auto position = enqueuePosition.load(std::memory_order_relaxed);
+                while (true) {
+                    claimed = 0;
+                    while (claimed < count && claimed <= mask &&
+                           slots[(position + claimed) & mask].sequence.load(std::memory_order_acquire) ==
+                           position + claimed) {
+                        claimed++;
+                    }
+                    if (claimed == 0) {
+                        auto current = enqueuePosition.load(std::memory_order_relaxed);
+                        if (current == position) {
+                            // full
+                            return 0;
+                        }
+                        position = current;
+                        continue;
+                    }
+                    if (enqueuePosition.compare_exchange_weak(position, position + claimed, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                for (std::size_t i = 0; i < claimed; ++i) {
+                    auto& slot = slots[(position + i) & mask];
+                    new(slot.storage) WorkQueue::Item(std::move(items[i]));
+                    slot.sequence.store(position + i + 1, std::memory_order_release);
+                }
+                return claimed;
+            }
+
+            std::optional<WorkQueue::Item> tryPop() {
+                Slot* slot;
+                auto position = dequeuePosition.load(std::memory_order_relaxed);
+                while (true) {
+                    slot = &slots[position & mask];
+                    auto sequence = slot->sequence.load(std::memory_order_acquire);
+                    auto difference = std::intptr_t(sequence) - std::intptr_t(position + 1);
+                    if (difference == 0) {
+                        if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    } else if (difference < 0) {
+                        // empty, or the producer of this slot isnt done with it yet
+                        return std::nullopt;
+                    } else {
+                        position = dequeuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+                auto* stored = std::launder(reinterpret_cast<WorkQueue::Item*>(slot->storage));
+                std::optional<WorkQueue::Item> item(std::move(*stored));
+                stored->~Item();
+                slot->sequence.store(position + mask + 1, std::memory_order_release);
+                return item;
+            }
+        };
+
+        /**
+         * Chase-Lev deque (the C11 version from Le et al), one per WORK_STEALING worker
+         * only the owner pushes and takes, at the bottom, LIFO, anyone can steal from the top, FIFO
+         * holds raw pointers because a steal reads the slot before it knows if the slot is its to take,
+         * it doesnt own them, whatever is left in it when its destroyed is the owners problem
+         */
+        template<typename T>
+        class PointerDeque {
+            struct Array {
+                std::int64_t mask;
+                std::unique_ptr<std::atomic<T*>[]> slots;
+
+                explicit Array(std::int64_t size) : mask(size - 1), slots(new std::atomic<T*>[size]) {
+                }
+
+                T* get(std::int64_t index) {
+                    return slots[index & mask].load(std::memory_order_relaxed);
+                }
+
+                void put(std::int64_t index, T* item) {
+                    slots[index & mask].store(item, std::memory_order_relaxed);
+                }
+            };
+
+            alignas(64) std::atomic_int64_t top = {0};
+            alignas(64) std::atomic_int64_t bottom = {0};
+            std::atomic<Array*> array;
+            // a thief can still be reading an old array, so they stay around until the deque is gone
+            std::vector<std::unique_ptr<Array>> arrays;
+
+        public:
+            PointerDeque() {
+                arrays.emplace_back(std::make_unique<Array>(256));
+                array = arrays.back().get();
+            }
+
+            void push(T* item) {
+                auto b = bottom.load(std::memory_order_relaxed);
+                auto t = top.load(std::memory_order_acquire);
+                auto* a = array.load(std::memory_order_relaxed);
+                if (b - t > a->mask) {
+                    auto grown = std::make_unique<Array>((a->mask + 1) * 2);
+                    for (auto i = t; i < b; ++i) {
+                        grown->put(i, a->get(i));
+                    }
+                    a = grown.get();
+                    arrays.emplace_back(std::move(grown));
+                    array.store(a, std::memory_order_release);
+                }
+                a->put(b, item);
+                std::atomic_thread_fence(std::memory_order_release);
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+
+            // owner only
+            T* take() {
+                auto b = bottom.load(std::memory_order_relaxed) - 1;
+                auto* a = array.load(std::memory_order_relaxed);
+                bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto t = top.load(std::memory_order_relaxed);
+                if (t > b) {
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                auto* item = a->get(b);
+                if (t == b) {
+                    // last one, racing the thieves for it
+                    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                        item = nullptr;
+                    }
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return item;
+            }
+
+            // anyone, nullptr if its empty or another thief got there first
+            T* steal() {
+                auto t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto b = bottom.load(std::memory_order_acquire);
+                if (t >= b) {
+                    return nullptr;
+                }
+                auto* item = array.load(std::memory_order_acquire)->get(t);
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    return nullptr;
+                }
+                return item;
+            }
+        };
+
+        // queue addresses get reused, ids dont
+        std::atomic_uint64_t nextQueueID = {1};
+
+        constexpr std::size_t maxWorkers = 256;
+
+        // set for threads started by addQueueProcessingThread, only those become WORK_STEALING workers
+        thread_local bool processingThread = false;
+
+        // shared by everything from one enqueueBulk
+        struct BulkGroup {
+            std::atomic_size_t remaining;
+            Event done;
+
+            explicit BulkGroup(std::size_t count) : remaining(count) {
+            }
+        };
+
+        /**
+         * the PRIORITY backend, guarded by the queues accessMutex
+         */
+        class PriorityLanes {
+            struct Entry {
+                std::chrono::steady_clock::time_point due;
+                std::uint64_t sequence;
+                WorkQueue::Item item;
+            };
+
+            // std heaps are max heaps, so this is "a goes after b"
+            static bool after(const Entry& a, const Entry& b) {
+                return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+            }
+
+            static constexpr std::size_t laneCount = 3;
+            static constexpr std::size_t starvationLimit = 16;
+
+            std::vector<Entry> lanes[laneCount];
+            std::size_t passedOver[laneCount] = {};
+            std::uint64_t nextSequence = 0;
+
+        public:
+            void push(WorkQueue::Item item, WorkQueue::Priority priority, std::chrono::steady_clock::time_point deadline) {
+                if (deadline == WorkQueue::noDeadline) {
+                    deadline = std::chrono::steady_clock::now();
+                }
+                auto& lane = lanes[std::size_t(priority)];
+                lane.push_back({deadline, nextSequence++, std::move(item)});
+                std::push_heap(lane.begin(), lane.end(), after);
+            }
+
+            // cant be empty
+            WorkQueue::Item pop() {
+                std::size_t chosen = laneCount;
+                for (std::size_t i = 0; i < laneCount; ++i) {
+                    if (lanes[i].empty()) {
+                        continue;
+                    }
+                    if (chosen == laneCount) {
+                        chosen = i;
+                    }
+                    if (passedOver[i] >= starvationLimit) {
+                        chosen = i;
+                        break;
+                    }
+                }
+                for (auto i = chosen + 1; i < laneCount; ++i) {
+                    if (!lanes[i].empty()) {
+                        passedOver[i]++;
+                    }
+                }
+                passedOver[chosen] = 0;
+                auto& lane = lanes[chosen];
+                std::pop_heap(lane.begin(), lane.end(), after);
+                WorkQueue::Item item = std::move(lane.back().item);
+                lane.pop_back();
+                return item;
+            }
+        };
+    }
+
+    class WorkQueue::Item::IMPL {
+        std::optional<Event> event;
+        boost::function<void()> function;
+        std::atomic_uint64_t untriggeredWaitEvents = {UINT64_MAX};
+        // only for items that have something to wait on
+        std::optional<Event> readyEvent;
+    public:
+        std::atomic_uint32_t references = {0};
+        IMPL* nextFree = nullptr;
+        // set by enqueueBulk
+        std::shared_ptr<BulkGroup> group;
+        // only the PRIORITY backend looks at these
+        WorkQueue::Priority priority = WorkQueue::Priority::NORMAL;
+        std::chrono::steady_clock::time_point deadline = WorkQueue::noDeadline;
+
+        void setVals(boost::function<void()> func, std::vector<Event> waitEvents);
+
+        void whenReady(std::function<void()> callback);
+
+        bool ready();
+
+        Event waitEvent();
+
+        void process();
+
+        // for going back into the pool, drops the function and the events
+        void reset();
+    };
+
+    void intrusive_ptr_add_ref(WorkQueue::Item::IMPL* impl) {
+        impl->references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void intrusive_ptr_release(WorkQueue::Item::IMPL* impl) {
+        if (impl->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        impl->reset();
+        ObjectPool<WorkQueue::Item::IMPL>::put(impl);
+    }
+
+    void WorkQueue::Item::IMPL::setVals(boost::function<void()> func, std::vector<Event> waitEvents) {
+        this->function = std::move(func);
+        event.emplace();
+        if (waitEvents.empty()) {
+            untriggeredWaitEvents = 0;
+            return;
+        }
+        readyEvent.emplace();
+        untriggeredWaitEvents = waitEvents.size();
+        for (auto& waitEvent : waitEvents) {
+            waitEvent.registerCallback(boost::bind<void>([](boost::intrusive_ptr<IMPL> item) {
+                if (item->untriggeredWaitEvents.fetch_sub(1) == 1) {
+                    item->readyEvent->trigger();
+                }
+            }, boost::intrusive_ptr<IMPL>(this)));
+        }
+    }
+
+    void WorkQueue::Item::IMPL::whenReady(std::function<void()> callback) {
+        if (!readyEvent) {
+            callback();
+            return;
+        }
+        readyEvent->registerCallback(std::move(callback));
+    }
+
+    bool WorkQueue::Item::IMPL::ready() {
+        return untriggeredWaitEvents == 0;
+    }
+
+    Event WorkQueue::Item::IMPL::waitEvent() {
+        return *event;
+    }
+
+    void WorkQueue::Item::IMPL::process() {
+        if (readyEvent) {
+            readyEvent->wait();
+        }
+        DestructorCallback callback{[=]() {
+            this->event->trigger();
+            if (group && --group->remaining == 0) {
+                group->done.trigger();
+            }
+        }};
+        function();
+    }
+
+    void WorkQueue::Item::IMPL::reset() {
+        function.clear();
+        // if this was the last reference, they trigger, like they always did when the item was destroyed
+        event.reset();
+        readyEvent.reset();
+        group.reset();
+        priority = WorkQueue::Priority::NORMAL;
+        deadline = WorkQueue::noDeadline;
+        untriggeredWaitEvents = UINT64_MAX;
+    }
+
     static thread_local bool waiting = false;
 
     class WorkQueue::IMPL {
+        typedef PointerDeque<Item::IMPL> ItemDeque;
+
+        struct WorkerState {
+            std::uint64_t queueID = 0;
+            ItemDeque* deque = nullptr;
+            std::uint32_t stealSeed = 0;
+        };
+        static thread_local WorkerState currentWorker;
+
         std::mutex accessMutex;
+        // for LOCK_FREE, this is only what didnt fit in the ring
         std::list<Item> queue;
+        // popped nodes, kept for the next push instead of freeing them
+        std::list<Item> spareNodes;
+        std::unique_ptr<ItemRing> ring;
+        // PRIORITY only, then its the only place items are
+        std::unique_ptr<PriorityLanes> lanes;
+        // so consumers dont take the lock to find out theres no overflow
+        std::atomic_size_t overflowSize = {0};
+        // WORK_STEALING only, the ring above is then for everything enqueued from outside the workers
+        std::unique_ptr<std::atomic<ItemDeque*>[]> workers;
+        std::atomic_size_t workerCount = {0};
+        std::uint64_t id = nextQueueID++;
         LightweightSemaphore dequeueSemaphore;
         std::atomic_bool destroyed = {false};
         std::atomic_int waitingThreads = {0};
+
+        void push(Item item);
+
+        // one synchronization and one signal for all of them
+        void pushBulk(std::vector<Item>& items);
+
+        // accessMutex must be held
+        void pushBack(Item item);
+
+        Item pop();
+
+        // accessMutex must be held, and queue cant be empty
+        Item popFront();
+
+        void registerWorker();
+
+        std::optional<Item> steal();
+
     public:
+        IMPL(Backend backend, std::size_t capacity);
+
         Event enqueue(Item item);
 
+        Event enqueueBulk(std::vector<boost::function<void()>> functions, std::vector<Event> waitEvents,
+                          Priority priority);
+
         Dequeue dequeue();
 
         Item dequeueItem(std::shared_ptr<IMPL>& ptr);
@@ -50,13 +487,217 @@ namespace RogueLib::Threading {
         ~IMPL();
     };
 
+    thread_local WorkQueue::IMPL::WorkerState WorkQueue::IMPL::currentWorker;
+
+    WorkQueue::IMPL::IMPL(Backend backend, std::size_t capacity) {
+        if (backend == Backend::LOCK_FREE || backend == Backend::WORK_STEALING) {
+            ring = std::make_unique<ItemRing>(capacity);
+        }
+        if (backend == Backend::PRIORITY) {
+            lanes = std::make_unique<PriorityLanes>();
+        }
+        if (backend == Backend::WORK_STEALING) {
+            workers.reset(new std::atomic<ItemDeque*>[maxWorkers]);
+            for (std::size_t i = 0; i < maxWorkers; ++i) {
+                workers[i] = nullptr;
+            }
+        }
+    }
+
+    void WorkQueue::IMPL::registerWorker() {
+        std::unique_lock<std::mutex> lk(accessMutex);
+        auto index = workerCount.load();
+        if (index == maxWorkers) {
+            // it still works, it just always goes through the ring
+            return;
+        }
+        auto* deque = new ItemDeque();
+        workers[index] = deque;
+        workerCount = index + 1;
+        currentWorker.queueID = id;
+        currentWorker.deque = deque;
+        currentWorker.stealSeed = std::uint32_t(index * 2654435761u + 1);
+    }
+
+    std::optional<WorkQueue::Item> WorkQueue::IMPL::steal() {
+        auto count = workerCount.load(std::memory_order_acquire);
+        if (count == 0) {
+            return std::nullopt;
+        }
+        // xorshift, so the thieves dont all go for the same victim first
+        auto seed = currentWorker.stealSeed;
+        seed ^= seed << 13u;
+        seed ^= seed >> 17u;
+        seed ^= seed << 5u;
+        currentWorker.stealSeed = seed;
+        for (std::size_t i = 0, start = seed % count; i < count; ++i) {
+            auto* victim = workers[(start + i) % count].load(std::memory_order_acquire);
+            if (victim == currentWorker.deque) {
+                continue;
+            }
+            if (auto* stolen = victim->steal()) {
+                return Item(boost::intrusive_ptr<Item::IMPL>(stolen, false));
+            }
+        }
+        return std::nullopt;
+    }
+
+    void WorkQueue::IMPL::push(Item item) {
+        if (lanes) {
+            std::unique_lock<std::mutex> lk(accessMutex);
+            auto priority = item.impl->priority;
+            auto deadline = item.impl->deadline;
+            lanes->push(std::move(item), priority, deadline);
+            dequeueSemaphore.signal();
+            return;
+        }
+        if (workers && currentWorker.queueID == id) {
+            // from one of our own workers, likely something its about to want, so it stays with it
+            currentWorker.deque->push(item.impl.detach());
+            dequeueSemaphore.signal();
+            return;
+        }
+        if (ring && ring->tryPush(item)) {
+            dequeueSemaphore.signal();
+            return;
+        }
+        std::unique_lock<std::mutex> lk(accessMutex);
+        pushBack(std::move(item));
+        dequeueSemaphore.signal();
+    }
+
+    void WorkQueue::IMPL::pushBulk(std::vector<Item>& items) {
+        std::size_t pushed = 0;
+        if (lanes) {
+            std::unique_lock<std::mutex> lk(accessMutex);
+            for (auto& item : items) {
+                auto priority = item.impl->priority;
+                auto deadline = item.impl->deadline;
+                lanes->push(std::move(item), priority, deadline);
+            }
+            pushed = items.size();
+        } else if (workers && currentWorker.queueID == id) {
+            for (auto& item : items) {
+                currentWorker.deque->push(item.impl.detach());
+            }
+            pushed = items.size();
+        } else if (ring) {
+            // more than one claim only if other producers got in the way, or it wraps
+            while (pushed < items.size()) {
+                auto claimed = ring->tryPushBulk(items.data() + pushed, items.size() - pushed);
+                if (claimed == 0) {
+                    break;
+                }
+                pushed += claimed;
+            }
+        }
+        if (pushed < items.size()) {
+            std::unique_lock<std::mutex> lk(accessMutex);
+            for (auto i = pushed; i < items.size(); ++i) {
+                pushBack(std::move(items[i]));
+            }
+        }
+        // wakes up to that many, fewer if fewer are waiting
+        dequeueSemaphore.signal(int(items.size()));
+    }
+
+    void WorkQueue::IMPL::pushBack(Item item) {
+        if (spareNodes.empty()) {
+            queue.push_back(std::move(item));
+        } else {
+            queue.splice(queue.end(), spareNodes, spareNodes.begin());
+            queue.back() = std::move(item);
+        }
+        overflowSize++;
+    }
+
+    WorkQueue::Item WorkQueue::IMPL::popFront() {
+        Item item = std::move(queue.front());
+        spareNodes.splice(spareNodes.begin(), queue, queue.begin());
+        overflowSize--;
+        return item;
+    }
+
+    // only after the semaphore says theres an item
+    WorkQueue::Item WorkQueue::IMPL::pop() {
+        if (lanes) {
+            std::unique_lock<std::mutex> lk(accessMutex);
+            return lanes->pop();
+        }
+        if (ring) {
+            // its there, but the producer of the slot in front of it could still be finishing up
+            bool isWorker = workers && currentWorker.queueID == id;
+            while (true) {
+                if (isWorker) {
+                    if (auto* local = currentWorker.deque->take()) {
+                        return Item(boost::intrusive_ptr<Item::IMPL>(local, false));
+                    }
+                }
+                if (auto item = ring->tryPop()) {
+                    return std::move(*item);
+                }
+                if (overflowSize != 0) {
+                    std::unique_lock<std::mutex> lk(accessMutex);
+                    if (!queue.empty()) {
+                        return popFront();
+                    }
+                }
+                if (workers) {
+                    if (auto item = steal()) {
+                        return std::move(*item);
+                    }
+                }
+                std::this_thread::yield();
+            }
+        }
+        std::unique_lock<std::mutex> lk(accessMutex);
+        return popFront();
+    }
+
     Event WorkQueue::IMPL::enqueue(Item item) {
+        auto event = item.event();
+        if (item.ready()) {
+            push(std::move(item));
+            return event;
+        }
         item.whenReady(boost::bind<void>([](std::shared_ptr<IMPL> queue, Item toEnqueue) {
-            std::unique_lock<std::mutex> lk(queue->accessMutex);
-            queue->queue.push_back(toEnqueue);
-            queue->dequeueSemaphore.signal();
+            queue->push(std::move(toEnqueue));
         }, selfPtr.lock(), item));
-        return item.event();
+        return event;
+    }
+
+    Event WorkQueue::IMPL::enqueueBulk(std::vector<boost::function<void()>> functions, std::vector<Event> waitEvents,
+                                       Priority priority) {
+        if (functions.empty()) {
+            Event done;
+            if (waitEvents.empty()) {
+                done.trigger();
+            } else {
+                Item gate({[]() {}}, std::move(waitEvents));
+                gate.whenReady([done]() mutable {
+                    done.trigger();
+                });
+            }
+            return done;
+        }
+        auto group = std::make_shared<BulkGroup>(functions.size());
+        std::vector<Item> items;
+        items.reserve(functions.size());
+        for (auto& function : functions) {
+            items.emplace_back(std::move(function));
+            items.back().impl->group = group;
+            items.back().impl->priority = priority;
+        }
+        if (waitEvents.empty()) {
+            pushBulk(items);
+            return group->done;
+        }
+        // one item tracks the wait events for all of them, its never queued itself
+        Item gate({[]() {}}, std::move(waitEvents));
+        gate.whenReady(boost::bind<void>([](std::shared_ptr<IMPL> queue, std::shared_ptr<std::vector<Item>> toEnqueue) {
+            queue->pushBulk(*toEnqueue);
+        }, selfPtr.lock(), std::make_shared<std::vector<Item>>(std::move(items))));
+        return group->done;
     }
 
     WorkQueue::Item WorkQueue::IMPL::dequeueItem(std::shared_ptr<IMPL>& ptr) {
@@ -72,16 +713,15 @@ namespace RogueLib::Threading {
         if (!waiting) { // cant access object address space, it may be deconstructed
             return {{[]() {}}};
         }
+        if (workers && processingThread && currentWorker.queueID != id) {
+            registerWorker();
+        }
         // ok, we are cleared to wait
         dequeueSemaphore.wait();
         if (destroyed) {
             return {{[]() {}}};
         }
-        std::unique_lock<std::mutex> lk(accessMutex);
-        Item item = queue.front();
-        queue.pop_front();
-        lk.unlock();
-        return item;
+        return pop();
     }
 
     WorkQueue::Dequeue WorkQueue::IMPL::dequeue() {
@@ -94,6 +734,13 @@ namespace RogueLib::Threading {
         // if this is being called from a dequeue release, there will be one left waiting.
         while (waitingThreads > (waiting ? 1 : 0)) {}
         waiting = false;
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            auto* deque = workers[i].load();
+            while (auto* item = deque->take()) {
+                intrusive_ptr_release(item);
+            }
+            delete deque;
+        }
     }
 }
 
@@ -135,75 +782,29 @@ namespace RogueLib::Threading {
 }
 
 namespace RogueLib::Threading {
-    class WorkQueue::Item::IMPL {
-        Event event;
-        boost::function<void()> function;
-        std::mutex eventReadyMutex;
-        std::atomic_uint64_t untriggeredWaitEvents = {UINT64_MAX};
-        Event readyEvent;
-    public:
-        std::weak_ptr<IMPL> selfPtr;
-
-        // selfptr is invalid in the constructor, and i need that
-        void setVals(boost::function<void()> func, std::vector<Event> waitEvents);
-
-        void whenReady(std::function<void()> callback);
-
-        bool ready();
-
-        Event waitEvent();
-
-        void process();
-    };
-
-    void WorkQueue::Item::IMPL::setVals(boost::function<void()> func, std::vector<Event> waitEvents) {
-        this->function = std::move(func);
-        if (waitEvents.empty()) {
-            readyEvent.trigger();
-            return;
-        }
-        untriggeredWaitEvents = waitEvents.size();
-        for (auto& waitEvent : waitEvents) {
-            waitEvent.registerCallback(boost::bind<void>([](std::shared_ptr<IMPL> item) {
-                std::unique_lock<std::mutex> lk(item->eventReadyMutex);
-                item->untriggeredWaitEvents--;
-                if (item->untriggeredWaitEvents == 0) {
-                    lk.unlock();
-                    item->readyEvent.trigger();
-                }
-            }, selfPtr.lock()));
-        }
+    WorkQueue::WorkQueue() : WorkQueue(Backend::MUTEX) {
     }
 
-    void WorkQueue::Item::IMPL::whenReady(std::function<void()> callback) {
-        readyEvent.registerCallback(std::move(callback));
-    }
-
-    bool WorkQueue::Item::IMPL::ready() {
-        return untriggeredWaitEvents == 0;
-    }
-
-    Event WorkQueue::Item::IMPL::waitEvent() {
-        return event;
+    WorkQueue::WorkQueue(Backend backend, std::size_t capacity) {
+        impl = std::make_shared<IMPL>(backend, capacity);
+        impl->selfPtr = impl;
     }
 
-    void WorkQueue::Item::IMPL::process() {
-        readyEvent.wait();
-        DestructorCallback callback{[=]() {
-            this->event.trigger();
-        }};
-        function();
+    Event WorkQueue::enqueue(boost::function<void()> function, std::vector<Event> waitEvents) {
+        return impl->enqueue({std::move(function), std::move(waitEvents)});
     }
-}
 
-namespace RogueLib::Threading {
-    WorkQueue::WorkQueue() {
-        impl = std::make_shared<IMPL>();
-        impl->selfPtr = impl;
+    Event WorkQueue::enqueue(boost::function<void()> function, std::vector<Event> waitEvents, Priority priority,
+                             std::chrono::steady_clock::time_point deadline) {
+        Item item(std::move(function), std::move(waitEvents));
+        item.impl->priority = priority;
+        item.impl->deadline = deadline;
+        return impl->enqueue(std::move(item));
     }
 
-    Event WorkQueue::enqueue(boost::function<void()> function, std::vector<Event> waitEvents) {
-        return impl->enqueue({std::move(function), std::move(waitEvents)});
+    Event WorkQueue::enqueueBulk(std::vector<boost::function<void()>> functions, std::vector<Event> waitEvents,
+                                 Priority priority) {
+        return impl->enqueueBulk(std::move(functions), std::move(waitEvents), priority);
     }
 
     WorkQueue::Dequeue WorkQueue::dequeue() {
@@ -227,11 +828,13 @@ namespace RogueLib::Threading {
     }
 
     WorkQueue::Item::Item(boost::function<void()> function, std::vector<Event> waitEvents) {
-        impl = std::make_shared<IMPL>();
-        impl->selfPtr = impl;
+        impl = ObjectPool<IMPL>::get();
         impl->setVals(std::move(function), std::move(waitEvents));
     }
 
+    WorkQueue::Item::Item(boost::intrusive_ptr<IMPL> impl) : impl(std::move(impl)) {
+    }
+
     void WorkQueue::Item::whenReady(std::function<void()> callback) {
         impl->whenReady(std::move(callback));
     }
@@ -272,6 +875,7 @@ namespace RogueLib::Threading {
     void addQueueProcessingThread(WorkQueue queue, std::function<void()> startup, std::function<void()> shutdown) {
         Thread thread(boost::bind<void>(
                 [](WorkQueue::Dequeue dequeue, std::function<void()> start, std::function<void()> end) {
+                    processingThread = true;
                     start();
                     while (dequeue) {
                         auto item = dequeue.dequeue();
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <RogueLib/Threading/Event.hpp>
+#include <chrono>
 #include <vector>
 
 #if __cplusplus >= 201703L // C++ 17
@@ -42,7 +43,16 @@ namespace RogueLib::Threading {
         class Item {
             class IMPL;
             
-            std::shared_ptr<IMPL> impl;
+            // pooled, see ObjectPool
+            boost::intrusive_ptr<IMPL> impl;
+
+            friend class WorkQueue;
+
+            friend void intrusive_ptr_add_ref(IMPL* impl);
+
+            friend void intrusive_ptr_release(IMPL* impl);
+
+            explicit Item(boost::intrusive_ptr<IMPL> impl);
         
         public:
             Item(boost::function<void()> function, std::vector<Event> waitEvents = {});
@@ -57,9 +67,58 @@ namespace RogueLib::Threading {
         };
         
         
+        /**
+         * where queued items wait to be dequeued
+         *
+         * MUTEX is a list behind a single lock, every enqueue allocates a node
+         * LOCK_FREE is a fixed size ring, producers and consumers claim slots with atomics and never block each other,
+         * if it fills up, anything more goes to a list behind a lock until the ring has room again
+         * WORK_STEALING gives every thread from addQueueProcessingThread its own deque, anything a worker enqueues
+         * (or makes ready, by triggering what it was waiting on) goes on that workers deque, its taken newest first,
+         * idle workers steal oldest first from the others, everything enqueued from outside goes through the ring
+         * PRIORITY is a lane per Priority, behind one lock, each one earliest deadline first, items without a deadline
+         * are due when they become ready, so they stay FIFO with each other
+         * the highest lane with something in it goes first, but a lane thats been passed over 16 times in a row goes
+         * next regardless, so LOW still gets through under a constant stream of HIGH
+         * either way, waiting for an item is the same semaphore
+         */
+        enum class Backend {
+            MUTEX,
+            LOCK_FREE,
+            WORK_STEALING,
+            PRIORITY,
+        };
+
+        /**
+         * only the PRIORITY backend orders by these (and deadlines), the others take them as plain items
+         */
+        enum class Priority {
+            HIGH,
+            NORMAL,
+            LOW,
+        };
+
+        static constexpr std::chrono::steady_clock::time_point noDeadline = std::chrono::steady_clock::time_point::max();
+
         WorkQueue();
+
+        /**
+         * capacity is the ring's size, rounded up to a power of two, MUTEX doesnt have one
+         */
+        explicit WorkQueue(Backend backend, std::size_t capacity = 4096);
         
         Event enqueue(boost::function<void()> function, std::vector<Event> waitEvents = {});
+
+        Event enqueue(boost::function<void()> function, std::vector<Event> waitEvents, Priority priority,
+                      std::chrono::steady_clock::time_point deadline = noDeadline);
+
+        /**
+         * enqueues all of them at once, one lock or ring claim, and one semaphore signal, for the lot
+         * waitEvents apply to every one of them
+         * the returned event is triggered once all of them have been processed
+         */
+        Event enqueueBulk(std::vector<boost::function<void()>> functions, std::vector<Event> waitEvents = {},
+                          Priority priority = Priority::NORMAL);
         
         class Dequeue {
             class IMPL;
@@ -0,0 +1,698 @@
+#include <RogueLib/Threading/Future.hpp>
+#include <RogueLib/Threading/TaskGraph.hpp>
+#include <RogueLib/Threading/WorkQueue.hpp>
+#include <RogueLib/Exceptions/Exceptions.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE Threading
+
+#include <boost/test/unit_test.hpp>
+
+using namespace RogueLib::Threading;
+
+const WorkQueue::Backend allBackends[] = {WorkQueue::Backend::MUTEX, WorkQueue::Backend::LOCK_FREE,
+                                          WorkQueue::Backend::WORK_STEALING, WorkQueue::Backend::PRIORITY};
+
+// processing threads need both, an empty std::function cant be called
+void addWorkers(WorkQueue queue, int count) {
+    for (int i = 0; i < count; ++i) {
+        addQueueProcessingThread(queue, [] {}, [] {});
+    }
+}
+
+// holds up every worker until opened, so whatever gets queued behind it actually waits in the queue
+struct Gate {
+    std::atomic_bool open{false};
+    std::atomic_int blocked{0};
+
+    void block(WorkQueue queue, int workers) {
+        for (int i = 0; i < workers; ++i) {
+            queue.enqueue([this] {
+                blocked++;
+                while (!open) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+        while (blocked != workers) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE(multipleProducersAndConsumers) {
+    for (auto backend : allBackends) {
+        // a small ring so it fills up and overflows under load too
+        for (std::size_t capacity : {8ul, 4096ul}) {
+            WorkQueue queue(backend, capacity);
+            addWorkers(queue, 4);
+            const long perProducer = 20000;
+            std::atomic_long sum{0};
+            std::atomic_long processed{0};
+            std::vector<std::thread> producers;
+            for (int p = 0; p < 4; ++p) {
+                producers.emplace_back([&] {
+                    for (long i = 0; i < perProducer; ++i) {
+                        queue.enqueue([&sum, &processed, i] {
+                            sum += i;
+                            processed++;
+                        });
+                    }
+                });
+            }
+            for (auto& producer : producers) {
+                producer.join();
+            }
+            while (processed != 4 * perProducer) {
+                std::this_thread::yield();
+            }
+            BOOST_CHECK(sum == 4 * (perProducer * (perProducer - 1) / 2));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dependencyChain) {
+    for (auto backend : allBackends) {
+        WorkQueue queue(backend, 64);
+        addWorkers(queue, 4);
+        std::atomic_int order{0};
+        std::atomic_int outOfOrder{0};
+        Event previous = queue.enqueue([&] { order++; });
+        for (int i = 1; i < 1000; ++i) {
+            previous = queue.enqueue([&, i] {
+                if (order != i) {
+                    outOfOrder++;
+                }
+                order++;
+            }, {previous});
+        }
+        previous.wait();
+        BOOST_CHECK(order == 1000);
+        BOOST_CHECK(outOfOrder == 0);
+    }
+}
+
+// every call is one task, a binary tree of them, depth levels below this one
+void fork(WorkQueue queue, int depth, std::atomic_long& completed) {
+    if (depth != 0) {
+        queue.enqueue([queue, depth, &completed] { fork(queue, depth - 1, completed); });
+        queue.enqueue([queue, depth, &completed] { fork(queue, depth - 1, completed); });
+    }
+    completed++;
+}
+
+BOOST_AUTO_TEST_CASE(enqueueFromWorkers) {
+    // on WORK_STEALING these go on the workers own deques, and only get spread out by stealing
+    for (auto backend : allBackends) {
+        WorkQueue queue(backend, 64);
+        addWorkers(queue, 4);
+        std::atomic_long completed{0};
+        const int depth = 14;
+        const long tasks = (2l << depth) - 1;
+        queue.enqueue([queue, &completed] { fork(queue, depth, completed); });
+        // a lost task fails the check instead of hanging the test
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (completed != tasks && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        BOOST_CHECK(completed == tasks);
+        // and nothing ran twice
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        BOOST_CHECK(completed == tasks);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ringOverflow) {
+    for (auto backend : {WorkQueue::Backend::LOCK_FREE, WorkQueue::Backend::WORK_STEALING}) {
+        WorkQueue queue(backend, 8);
+        addWorkers(queue, 2);
+        Gate gate;
+        gate.block(queue, 2);
+        // the ring holds 8, the rest have to go to the locked list
+        std::atomic_int processed{0};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 4; ++p) {
+            producers.emplace_back([&] {
+                for (int i = 0; i < 250; ++i) {
+                    queue.enqueue([&processed] { processed++; });
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        BOOST_CHECK(processed == 0);
+        gate.open = true;
+        // and once the ring drains, new items go back to it, while the older ones are still in the list
+        Event last;
+        for (int i = 0; i < 100; ++i) {
+            last = queue.enqueue([&processed] { processed++; });
+        }
+        last.wait();
+        while (processed != 1100) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(idleWorkersSteal) {
+    WorkQueue queue(WorkQueue::Backend::WORK_STEALING, 64);
+    addWorkers(queue, 4);
+    // all of these go on one workers deque, the others only get them by stealing
+    std::mutex threadsMutex;
+    std::set<std::thread::id> threads;
+    std::atomic_int finished{0};
+    queue.enqueue([&, queue]() mutable {
+        for (int i = 0; i < 64; ++i) {
+            queue.enqueue([&] {
+                auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+                while (std::chrono::steady_clock::now() < end) {
+                }
+                {
+                    std::unique_lock<std::mutex> lk(threadsMutex);
+                    threads.insert(std::this_thread::get_id());
+                }
+                finished++;
+            });
+        }
+    });
+    while (finished != 64) {
+        std::this_thread::yield();
+    }
+    BOOST_CHECK(threads.size() > 1);
+}
+
+BOOST_AUTO_TEST_CASE(pooledItemsAndEvents) {
+    WorkQueue queue(WorkQueue::Backend::LOCK_FREE, 64);
+    addWorkers(queue, 2);
+    Event first = queue.enqueue([] {});
+    first.wait();
+    // plenty of items and events go back through the pool, a held event must not be one of them
+    for (int i = 0; i < 10000; ++i) {
+        queue.enqueue([] {}).wait();
+    }
+    bool called = false;
+    first.registerCallback([&] { called = true; });
+    BOOST_CHECK(called);
+    first.wait();
+
+    // an item thats waiting on something isnt ready until it triggers
+    Event blocker;
+    WorkQueue::Item item([] {}, {blocker});
+    bool ready = false;
+    item.whenReady([&] { ready = true; });
+    BOOST_CHECK(!item.ready());
+    BOOST_CHECK(!ready);
+    blocker.trigger();
+    BOOST_CHECK(item.ready());
+    BOOST_CHECK(ready);
+    bool processed = false;
+    item.event().registerCallback([&] { processed = true; });
+    item.process();
+    BOOST_CHECK(processed);
+}
+
+BOOST_AUTO_TEST_CASE(eventCallbacksRaceTrigger) {
+    for (int round = 0; round < 1000; ++round) {
+        Event event;
+        std::vector<int> order;
+        for (int i = 0; i < 3; ++i) {
+            event.registerCallback([&order, i] { order.push_back(i); });
+        }
+        // whichever side wins, every one of these runs exactly once
+        std::atomic_int calls{0};
+        std::thread registering([&] {
+            for (int i = 0; i < 50; ++i) {
+                event.registerCallback([&calls] { calls++; });
+            }
+        });
+        event.trigger();
+        registering.join();
+        BOOST_CHECK(calls == 50);
+        BOOST_CHECK(order == (std::vector<int>{0, 1, 2}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(eventWaitAfterTrigger) {
+    Event event;
+    event.trigger();
+    // already triggered, these return straight away
+    event.wait();
+    event.wait();
+    bool called = false;
+    event.registerCallback([&] { called = true; });
+    BOOST_CHECK(called);
+}
+
+BOOST_AUTO_TEST_CASE(eventLateCallbacksKeepOrder) {
+    Event event;
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int i) {
+        std::unique_lock<std::mutex> lk(orderMutex);
+        order.push_back(i);
+    };
+    std::atomic_bool started{false};
+    std::atomic_bool release{false};
+    event.registerCallback([&] {
+        started = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+        record(0);
+    });
+    // one of the callbacks registering another, it goes after the rest
+    event.registerCallback([&, event]() mutable {
+        record(1);
+        event.registerCallback([&] { record(3); });
+    });
+    event.registerCallback([&] { record(2); });
+    std::thread triggering([&] { event.trigger(); });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    // the marker is already in, but the callbacks before this one arent done yet
+    std::thread late([&] { event.registerCallback([&] { record(4); }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    {
+        std::unique_lock<std::mutex> lk(orderMutex);
+        BOOST_CHECK(order.empty());
+    }
+    release = true;
+    triggering.join();
+    late.join();
+    BOOST_CHECK(order == (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(eventWakesEveryWaiter) {
+    for (int round = 0; round < 100; ++round) {
+        Event event;
+        std::atomic_int woken{0};
+        std::vector<std::thread> waiters;
+        for (int i = 0; i < 16; ++i) {
+            waiters.emplace_back([&] {
+                event.wait();
+                woken++;
+            });
+        }
+        BOOST_CHECK(woken == 0);
+        event.trigger();
+        for (auto& waiter : waiters) {
+            waiter.join();
+        }
+        BOOST_CHECK(woken == 16);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(enqueueBulk) {
+    for (auto backend : allBackends) {
+        WorkQueue queue(backend, 16);
+        addWorkers(queue, 4);
+        // more than the ring holds, the event is only triggered once every one of them is done
+        std::atomic_long count{0};
+        for (int round = 0; round < 20; ++round) {
+            std::vector<boost::function<void()>> functions(1000, [&count] { count++; });
+            queue.enqueueBulk(functions).wait();
+            BOOST_CHECK(count == (round + 1) * 1000l);
+        }
+
+        // none of them start before the wait events are triggered
+        Event gate;
+        std::atomic_int started{0};
+        Event done = queue.enqueueBulk(std::vector<boost::function<void()>>(100, [&started] { started++; }), {gate});
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        BOOST_CHECK(started == 0);
+        gate.trigger();
+        done.wait();
+        BOOST_CHECK(started == 100);
+
+        // from inside a worker, waiting on another bulk
+        std::atomic_int inner{0};
+        queue.enqueueBulk({[&] {
+            queue.enqueueBulk(std::vector<boost::function<void()>>(100, [&inner] { inner++; })).wait();
+        }}).wait();
+        BOOST_CHECK(inner == 100);
+
+        // nothing to do is done straight away, or once its waits are
+        queue.enqueueBulk({}).wait();
+        Event emptyGate;
+        Event emptyDone = queue.enqueueBulk({}, {emptyGate});
+        bool emptyFinished = false;
+        emptyDone.registerCallback([&] { emptyFinished = true; });
+        BOOST_CHECK(!emptyFinished);
+        emptyGate.trigger();
+        BOOST_CHECK(emptyFinished);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(priorityLanes) {
+    typedef WorkQueue::Priority Priority;
+    WorkQueue queue(WorkQueue::Backend::PRIORITY);
+    // one worker, so the order things are run in is the order theyre dequeued
+    addWorkers(queue, 1);
+    std::mutex orderMutex;
+    std::string order;
+    auto record = [&](char c) -> boost::function<void()> {
+        return [&, c] {
+            std::unique_lock<std::mutex> lk(orderMutex);
+            order += c;
+        };
+    };
+
+    // highest lane first, earliest deadline first within it, no deadline is due when its enqueued
+    auto gate = std::make_unique<Gate>();
+    gate->block(queue, 1);
+    auto now = std::chrono::steady_clock::now();
+    queue.enqueue(record('l'), {}, Priority::LOW);
+    queue.enqueue(record('n'), {});
+    queue.enqueue(record('h'), {}, Priority::HIGH);
+    queue.enqueue(record('B'), {}, Priority::HIGH, now + std::chrono::seconds(2));
+    queue.enqueue(record('A'), {}, Priority::HIGH, now - std::chrono::seconds(1));
+    queue.enqueue(record('m'), {}, Priority::NORMAL);
+    Event last = queue.enqueue(record('x'), {}, Priority::LOW);
+    gate->open = true;
+    last.wait();
+    BOOST_CHECK(order == "AhBnmlx");
+
+    // a lane passed over 16 times in a row goes next, even with HIGH still waiting
+    order.clear();
+    gate = std::make_unique<Gate>();
+    gate->block(queue, 1);
+    queue.enqueue(record('L'), {}, Priority::LOW);
+    for (int i = 0; i < 39; ++i) {
+        queue.enqueue(record('H'), {}, Priority::HIGH);
+    }
+    last = queue.enqueue(record('H'), {}, Priority::HIGH);
+    gate->open = true;
+    last.wait();
+    BOOST_CHECK(order == std::string(16, 'H') + "L" + std::string(24, 'H'));
+
+    // bulk items land in the lane they were given
+    order.clear();
+    gate = std::make_unique<Gate>();
+    gate->block(queue, 1);
+    Event lowBulk = queue.enqueueBulk({record('l'), record('l')}, {}, Priority::LOW);
+    Event highBulk = queue.enqueueBulk({record('h'), record('h')}, {}, Priority::HIGH);
+    gate->open = true;
+    lowBulk.wait();
+    highBulk.wait();
+    BOOST_CHECK(order == "hhll");
+}
+
+// layers of width nodes, each one after every node of the layer before
+struct LayeredGraph {
+    TaskGraph graph;
+    std::vector<TaskGraph::Node> nodes;
+    std::vector<std::atomic_int> stamps;
+    std::atomic_int clock{0};
+    int layers;
+    int width;
+
+    LayeredGraph(int layers, int width, TaskGraph::Node slowNode = ~TaskGraph::Node(0))
+            : stamps(layers * width), layers(layers), width(width) {
+        for (int i = 0; i < layers * width; ++i) {
+            nodes.emplace_back(graph.addNode([this, i, slowNode] {
+                if (TaskGraph::Node(i) == slowNode) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+                stamps[i] = clock++;
+            }));
+        }
+        for (int layer = 1; layer < layers; ++layer) {
+            for (int a = 0; a < width; ++a) {
+                for (int b = 0; b < width; ++b) {
+                    graph.addEdge(nodes[(layer - 1) * width + a], nodes[layer * width + b]);
+                }
+            }
+        }
+    }
+
+    bool ordered() {
+        for (int layer = 1; layer < layers; ++layer) {
+            for (int a = 0; a < width; ++a) {
+                for (int b = 0; b < width; ++b) {
+                    if (stamps[(layer - 1) * width + a] >= stamps[layer * width + b]) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(taskGraphExecute) {
+    WorkQueue queue(WorkQueue::Backend::WORK_STEALING);
+    addWorkers(queue, 4);
+    LayeredGraph layered(10, 8);
+    // the same graph, run over and over
+    for (int run = 0; run < 50; ++run) {
+        layered.clock = 0;
+        layered.graph.execute(queue).wait();
+        BOOST_CHECK(layered.clock == 80);
+        BOOST_CHECK(layered.ordered());
+    }
+    // adding to it afterwards is picked up by the next run
+    std::atomic_bool added{false};
+    auto extra = layered.graph.addNode([&] { added = true; });
+    layered.graph.addEdge(layered.nodes.back(), extra);
+    layered.graph.execute(queue).wait();
+    BOOST_CHECK(added);
+
+    TaskGraph empty;
+    empty.execute(queue).wait();
+}
+
+BOOST_AUTO_TEST_CASE(taskGraphOverlappingRuns) {
+    WorkQueue queue(WorkQueue::Backend::LOCK_FREE);
+    addWorkers(queue, 4);
+    std::atomic_int count{0};
+    std::vector<Event> runs;
+    {
+        TaskGraph graph;
+        auto first = graph.addNode([&] { count++; });
+        for (int i = 0; i < 20; ++i) {
+            graph.addEdge(first, graph.addNode([&] { count++; }));
+        }
+        for (int i = 0; i < 10; ++i) {
+            runs.emplace_back(graph.execute(queue));
+        }
+        // the runs keep it alive without this
+    }
+    for (auto& run : runs) {
+        run.wait();
+    }
+    BOOST_CHECK(count == 10 * 21);
+}
+
+BOOST_AUTO_TEST_CASE(taskGraphRejectsCycles) {
+    WorkQueue queue;
+    addWorkers(queue, 1);
+    TaskGraph graph;
+    auto a = graph.addNode([] {});
+    auto b = graph.addNode([] {});
+    auto c = graph.addNode([] {});
+    graph.addEdge(a, b);
+    graph.addEdge(b, c);
+    graph.addEdge(c, b);
+    BOOST_CHECK_THROW(graph.execute(queue), RogueLib::Exceptions::InvalidArgument);
+    BOOST_CHECK_THROW(graph.addEdge(a, 3), RogueLib::Exceptions::InvalidArgument);
+
+    TaskGraph selfLoop;
+    auto only = selfLoop.addNode([] {});
+    selfLoop.addEdge(only, only);
+    BOOST_CHECK_THROW(selfLoop.execute(queue), RogueLib::Exceptions::InvalidArgument);
+}
+
+BOOST_AUTO_TEST_CASE(taskGraphNodeThrows) {
+    WorkQueue queue(WorkQueue::Backend::MUTEX);
+    addWorkers(queue, 2);
+    TaskGraph graph;
+    std::atomic_int after{0};
+    auto throwing = graph.addNode([] {
+        throw std::runtime_error("node failed");
+    });
+    // whatever was after it still runs, and the run still finishes
+    for (int i = 0; i < 4; ++i) {
+        graph.addEdge(throwing, graph.addNode([&] { after++; }));
+    }
+    for (int run = 0; run < 10; ++run) {
+        graph.execute(queue).wait();
+    }
+    BOOST_CHECK(after == 40);
+}
+
+BOOST_AUTO_TEST_CASE(taskGraphStatistics) {
+    WorkQueue queue(WorkQueue::Backend::WORK_STEALING);
+    addWorkers(queue, 4);
+    // node 13 is in the middle of the graph, and by far the slowest
+    LayeredGraph layered(5, 4, 13);
+    auto statistics = std::make_shared<TaskGraph::Statistics>();
+    layered.graph.execute(queue, statistics).wait();
+    auto& path = statistics->criticalPathNodes;
+    BOOST_CHECK(path.size() == 5);
+    BOOST_CHECK(std::count(path.begin(), path.end(), 13) == 1);
+    // one node from every layer, in order
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        BOOST_CHECK(path[i] / 4 == i);
+    }
+    BOOST_CHECK(statistics->criticalPath >= std::chrono::milliseconds(20));
+    BOOST_CHECK(statistics->totalWork >= statistics->criticalPath);
+    BOOST_CHECK(statistics->wallTime >= statistics->criticalPath);
+
+    // runs that dont ask for them leave them alone
+    auto before = statistics->criticalPath;
+    layered.graph.execute(queue).wait();
+    BOOST_CHECK(statistics->criticalPath == before);
+}
+
+BOOST_AUTO_TEST_CASE(futureThenInline) {
+    Promise<int> promise;
+    std::thread::id ranOn;
+    auto future = promise.future().then([&](int value) {
+        ranOn = std::this_thread::get_id();
+        return value * 2;
+    }).then([](int value) {
+        return std::to_string(value);
+    });
+    BOOST_CHECK(!future.ready());
+    // runs on whatever sets it
+    std::thread setter([&] { promise.setValue(21); });
+    auto setterID = setter.get_id();
+    setter.join();
+    BOOST_CHECK(future.ready());
+    BOOST_CHECK(future.get() == "42");
+    BOOST_CHECK(ranOn == setterID);
+
+    // or right here, if its already set
+    bool ran = false;
+    makeReadyFuture().then([&] { ran = true; });
+    BOOST_CHECK(ran);
+}
+
+BOOST_AUTO_TEST_CASE(futureThenQueued) {
+    WorkQueue queue(WorkQueue::Backend::LOCK_FREE);
+    addWorkers(queue, 2);
+    std::atomic_int side{0};
+    auto future = makeReadyFuture(5).then(queue, [&](int value) {
+        side = value;
+    }).then(queue, [&] {
+        return side + 1;
+    });
+    BOOST_CHECK(future.get() == 6);
+
+    // a Future as a WorkQueue dependency
+    Promise<int> gate;
+    std::atomic_bool ran{false};
+    Event event = queue.enqueue([&] { ran = true; }, {gate.future().event()});
+    BOOST_CHECK(!ran);
+    gate.setValue(1);
+    event.wait();
+    BOOST_CHECK(ran);
+}
+
+BOOST_AUTO_TEST_CASE(futureReleasesSourceAfterRunning) {
+    auto value = std::make_shared<int>(1);
+    std::weak_ptr<int> watched = value;
+    Promise<std::shared_ptr<int>> promise;
+    auto future = promise.future().then([](const std::shared_ptr<int>& shared) { return *shared + 1; });
+    promise.setValue(std::move(value));
+    promise = Promise<std::shared_ptr<int>>();
+    // the continuation is all thats left that could hold it
+    BOOST_CHECK(future.get() == 2);
+    BOOST_CHECK(watched.expired());
+}
+
+BOOST_AUTO_TEST_CASE(futureExceptions) {
+    WorkQueue queue(WorkQueue::Backend::LOCK_FREE);
+    addWorkers(queue, 2);
+    // an exception skips every function after it
+    Promise<int> promise;
+    bool skipped = true;
+    auto future = promise.future().then([&](int) {
+        skipped = false;
+        return 1;
+    }).then(queue, [](int value) { return value; });
+    promise.setException(std::make_exception_ptr(std::runtime_error("failed")));
+    BOOST_CHECK_THROW(future.get(), std::runtime_error);
+    BOOST_CHECK(skipped);
+
+    // and one thrown by a function is passed on too
+    auto thrown = makeReadyFuture().then([]() -> int { throw std::logic_error("thrown"); });
+    BOOST_CHECK_THROW(thrown.get(), std::logic_error);
+
+    // a Promise can only be set once
+    Promise<void> twice;
+    twice.setValue();
+    BOOST_CHECK_THROW(twice.setValue(), RogueLib::Exceptions::InvalidAsyncState);
+}
+
+BOOST_AUTO_TEST_CASE(futureAbandonedPromise) {
+    Future<int> future;
+    bool continued = false;
+    Future<int> continuation;
+    {
+        Promise<int> dropped;
+        future = dropped.future();
+        continuation = future.then([&](int value) {
+            continued = true;
+            return value;
+        });
+    }
+    BOOST_CHECK(future.ready());
+    BOOST_CHECK_THROW(future.get(), RogueLib::Exceptions::InvalidAsyncState);
+    BOOST_CHECK_THROW(continuation.get(), RogueLib::Exceptions::InvalidAsyncState);
+    BOOST_CHECK(!continued);
+}
+
+BOOST_AUTO_TEST_CASE(futureWhenAllWhenAny) {
+    std::vector<Promise<int>> promises(10);
+    std::vector<Future<int>> futures;
+    for (auto& promise : promises) {
+        futures.emplace_back(promise.future());
+    }
+    auto all = whenAll(futures);
+    auto any = whenAny(futures);
+    promises[7].setValue(7);
+    BOOST_CHECK(any.get() == 7);
+    BOOST_CHECK(!all.ready());
+    // setting them from a few threads at once, whenAll only finishes after the last
+    std::vector<std::thread> setters;
+    for (int t = 0; t < 3; ++t) {
+        setters.emplace_back([&, t] {
+            for (int i = t; i < 10; i += 3) {
+                if (i != 7) {
+                    promises[i].setValue(i);
+                }
+            }
+        });
+    }
+    for (auto& setter : setters) {
+        setter.join();
+    }
+    auto values = all.get();
+    BOOST_CHECK(values.size() == 10);
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK(values[i] == i);
+    }
+
+    // the first exception in the vector, not the first to be set
+    Promise<void> first;
+    Promise<void> second;
+    auto failed = whenAll(std::vector<Future<void>>{first.future(), second.future()});
+    second.setException(std::make_exception_ptr(std::logic_error("second")));
+    first.setException(std::make_exception_ptr(std::runtime_error("first")));
+    BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+
+    BOOST_CHECK(whenAll(std::vector<Future<void>>{}).ready());
+    BOOST_CHECK_THROW(whenAny(std::vector<Future<void>>{}), RogueLib::Exceptions::InvalidArgument);
+}